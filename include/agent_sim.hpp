@@ -0,0 +1,118 @@
+#pragma once
+
+#include "order_book.hpp"
+#include "parallel.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+struct AgentSimConfig {
+    std::string symbol = "SIM";
+    size_t noise_agents = 10000;
+    size_t market_makers = 100;
+    size_t momentum_agents = 1000;
+    Price initial_price = 1000000;   // $100.00
+    Price tick_size = 100;           // $0.01
+    // Probability that an agent acts in a step
+    double noise_activity = 0.01;
+    double maker_activity = 0.2;
+    double momentum_activity = 0.05;
+    Timestamp step_ns = 1000000;     // 1 ms of simulated time per step
+    size_t order_lifetime = 20;      // Steps a limit order rests; 0 = until the agent acts
+    Timestamp start_time = 1700000000000000000ULL;
+    uint64_t seed = 42;
+    size_t threads = 1;              // Decision-phase workers, 0 = all cores (results do not depend on it)
+};
+
+// Agent-based background market for one symbol: noise traders, inventory-
+// skewed market makers and momentum followers trading through a real
+// OrderBook. Each agent keeps at most one working order (acting again
+// cancels it) and limit orders expire after order_lifetime steps, so the
+// book holds about activity x lifetime orders per agent. Expiries are
+// cancelled oldest first, i.e. from the front of their FIFO level.
+//
+// A step has three phases:
+//   1. decide  - every agent draws from its own 32-bit xorshift stream
+//                and writes an order intent. Agent state is structure-of-
+//                arrays of 32-bit columns, one contiguous run per agent
+//                type, so the per-type loops auto-vectorize (SSE2 at the
+//                baseline ISA); blocks of agents run on the worker pool.
+//   2. submit  - expiries and cancels, then one batched OrderBook::add_orders() call in
+//                agent order (serial, so books are identical whatever the
+//                thread count).
+//   3. observe - mid and the momentum signal every agent sees next step.
+// Trades update agent inventory and cash and can be captured as ticks to
+// feed TickEngine with endogenous order flow.
+class AgentSimulator {
+public:
+    enum AgentType : uint8_t { NOISE = 0, MARKET_MAKER = 1, MOMENTUM = 2 };
+
+    explicit AgentSimulator(const AgentSimConfig& config);
+
+    void step(std::vector<Tick>* ticks = nullptr);
+    void run(size_t steps, std::vector<Tick>* ticks = nullptr);
+
+    OrderBook& book() { return book_; }
+    const OrderBook& book() const { return book_; }
+    Timestamp now() const { return now_; }
+    size_t agents() const { return type_.size(); }
+    AgentType type(size_t agent) const { return static_cast<AgentType>(type_[agent]); }
+    int64_t inventory(size_t agent) const { return inventory_[agent]; }
+    int64_t cash(size_t agent) const { return cash_[agent]; }
+
+    struct Stats {
+        uint64_t steps = 0;
+        uint64_t orders = 0;
+        uint64_t cancels = 0;
+        uint64_t trades = 0;
+        uint64_t volume = 0;
+    };
+    const Stats& stats() const { return stats_; }
+
+private:
+    static constexpr size_t BLOCK = 4096;  // Agents per decision task
+
+    void decide(size_t begin, size_t end);
+    void submit();
+    void observe();
+    void on_trade(const Trade& trade);
+
+    AgentSimConfig config_;
+    OrderBook book_;
+    std::unique_ptr<WorkerPool> pool_;
+    Timestamp now_;
+    Stats stats_;
+    std::vector<Tick>* capture_ = nullptr;
+
+    // Shared market view, read-only during decide()
+    int64_t mid_ticks_;
+    double momentum_ = 0.0;   // EWMA of mid changes, in ticks
+    Price last_trade_ = 0;    // Tick-rule side of captured trades
+
+    // Agent columns
+    std::vector<uint8_t> type_;
+    std::vector<uint32_t> rng_;
+    std::vector<uint32_t> activity_;  // P(act) scaled to 2^32
+    std::vector<uint32_t> threshold_; // Momentum trigger, 16.16 fixed-point ticks
+    std::vector<int64_t> inventory_;
+    std::vector<int64_t> cash_;
+    // Maker quoting inputs, refreshed on every fill: sign of inventory and
+    // price skew in ticks
+    std::vector<int32_t> lean_;
+    std::vector<int32_t> skew_;
+    // Intent written by decide(): side 0 = none, 1 = buy, 2 = sell; price
+    // as a tick offset from the mid
+    std::vector<uint32_t> intent_side_;
+    std::vector<uint32_t> intent_market_;
+    std::vector<int32_t> intent_offset_;
+    std::vector<uint32_t> intent_quantity_;
+
+    std::vector<Order> orders_;       // One working order per agent; id = agent
+    std::vector<Order*> batch_;
+    // Agents by the step their order expires in, ring of order_lifetime
+    std::vector<std::vector<uint32_t>> expiry_;
+};
+
+} // namespace trading
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace trading {
+
+enum class BarType : uint8_t {
+    TIME = 0,    // Fixed clock buckets aligned to the epoch; size in ns
+    VOLUME = 1,  // Closes once traded quantity reaches size
+    DOLLAR = 2,  // Closes once traded notional reaches size dollars
+    TICK = 3     // Closes after size ticks
+};
+
+struct BarSpec {
+    BarType type = BarType::TIME;
+    double size = 0.0;
+
+    static BarSpec time(Timestamp ns) { return {BarType::TIME, static_cast<double>(ns)}; }
+    static BarSpec volume(Quantity quantity) { return {BarType::VOLUME, static_cast<double>(quantity)}; }
+    static BarSpec dollar(double notional) { return {BarType::DOLLAR, notional}; }
+    static BarSpec ticks(uint32_t count) { return {BarType::TICK, static_cast<double>(count)}; }
+
+    bool operator==(const BarSpec& other) const { return type == other.type && size == other.size; }
+};
+
+struct Bar {
+    SymbolId symbol = 0;
+    uint16_t resolution = 0;  // BarAggregator resolution id
+    // Time bars: the bucket [open_time, close_time). Others: first and last tick.
+    Timestamp open_time = 0;
+    Timestamp close_time = 0;
+    Price open = 0;
+    Price high = 0;
+    Price low = 0;
+    Price close = 0;
+    Quantity volume = 0;
+    double notional = 0.0;  // Dollars
+    uint32_t ticks = 0;     // 0 = no open bar
+
+    double vwap() const { return volume > 0 ? notional / static_cast<double>(volume) : 0.0; }
+};
+
+// OHLCV bars for every symbol at several resolutions, built in one pass
+// over the ticks. Accumulators are dense: one Bar per (symbol,
+// resolution), stored symbol-major, so a tick touches one contiguous run
+// of its symbol's bars. A tick never splits across bars; volume, dollar
+// and tick bars close on the tick that reaches the size, time bars on the
+// first tick past the bucket (empty buckets produce no bar).
+class BarAggregator {
+public:
+    // Returns the resolution id; an existing id for a spec already added
+    size_t add_resolution(const BarSpec& spec);
+    size_t resolutions() const { return specs_.size(); }
+    const BarSpec& resolution(size_t id) const { return specs_[id]; }
+
+    // Folds a tick into each resolution of `symbol`, calling emit(const Bar&)
+    // for every bar it completes
+    template<typename Emit>
+    void add(SymbolId symbol, const Tick& tick, Emit&& emit);
+
+    // The bar being built, or nullptr if the symbol has none at that resolution
+    const Bar* open_bar(SymbolId symbol, size_t resolution) const;
+
+    // Emits and clears every open bar, e.g. partial bars at the end of data
+    template<typename Emit>
+    void flush(Emit&& emit);
+
+private:
+    void grow(SymbolId symbol);
+    Bar* row(SymbolId symbol) { return &bars_[static_cast<size_t>(symbol) * specs_.size()]; }
+
+    std::vector<BarSpec> specs_;
+    std::vector<Bar> bars_;  // symbols_ x specs_.size()
+    size_t symbols_ = 0;
+};
+
+template<typename Emit>
+void BarAggregator::add(SymbolId symbol, const Tick& tick, Emit&& emit) {
+    if (symbol >= symbols_) grow(symbol);
+    const size_t n = specs_.size();
+    Bar* bars = row(symbol);
+    double notional = static_cast<double>(tick.price) / 10000.0 * static_cast<double>(tick.volume);
+
+    for (size_t r = 0; r < n; ++r) {
+        const BarSpec& spec = specs_[r];
+        Bar& bar = bars[r];
+        if (spec.type == BarType::TIME && bar.ticks > 0 && tick.timestamp >= bar.close_time) {
+            emit(bar);
+            bar.ticks = 0;
+        }
+        if (bar.ticks == 0) {
+            bar.open_time = tick.timestamp;
+            bar.close_time = tick.timestamp;
+            if (spec.type == BarType::TIME) {
+                Timestamp size = std::max<Timestamp>(static_cast<Timestamp>(spec.size), 1);
+                bar.open_time = tick.timestamp / size * size;
+                bar.close_time = bar.open_time + size;
+            }
+            bar.open = bar.high = bar.low = tick.price;
+            bar.volume = 0;
+            bar.notional = 0.0;
+        }
+        bar.high = std::max(bar.high, tick.price);
+        bar.low = std::min(bar.low, tick.price);
+        bar.close = tick.price;
+        bar.volume += tick.volume;
+        bar.notional += notional;
+        ++bar.ticks;
+
+        bool full = false;
+        switch (spec.type) {
+            case BarType::TIME: break;
+            case BarType::VOLUME: full = static_cast<double>(bar.volume) >= spec.size; break;
+            case BarType::DOLLAR: full = bar.notional >= spec.size; break;
+            case BarType::TICK: full = static_cast<double>(bar.ticks) >= spec.size; break;
+        }
+        if (full) {
+            bar.close_time = tick.timestamp;
+            emit(bar);
+            bar.ticks = 0;
+        }
+    }
+}
+
+template<typename Emit>
+void BarAggregator::flush(Emit&& emit) {
+    for (Bar& bar : bars_) {
+        if (bar.ticks == 0) continue;
+        emit(bar);
+        bar.ticks = 0;
+    }
+}
+
+} // namespace trading
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "types.hpp"
+#include "memory_pool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Differential replay: drive a reference book and a candidate book with the
+// same operation stream in lockstep and compare trades and top-of-book after
+// every step. Failing sequences are shrunk to a minimal reproducer.
+
+enum class BookOpType : uint8_t {
+    ADD = 0,
+    MARKET = 1,
+    CANCEL = 2,
+    MODIFY = 3
+};
+
+// Orders are named by `ref`, the ordinal of the ADD/MARKET that created them,
+// so CANCEL/MODIFY stay meaningful when ops are removed during shrinking
+// (targets of removed orders simply become no-ops).
+struct BookOp {
+    BookOpType type;
+    Side side;
+    uint32_t user_id;
+    uint64_t ref;
+    Price price;
+    Quantity quantity;
+};
+
+// Deterministic random operation stream clustered around a mid price.
+// At most `target_window` orders are tracked as live; once full, the stream
+// cancels before adding, which keeps book depth bounded on endless runs.
+class BookOpGenerator {
+public:
+    struct Config {
+        uint64_t seed = 42;
+        Price mid_price = 1000000;
+        Price tick_size = 100;
+        int price_levels = 50;        // Limit prices within mid +/- levels ticks
+        Quantity max_quantity = 100;
+        uint32_t users = 8;
+        int add_pct = 55;
+        int market_pct = 5;
+        int cancel_pct = 30;          // Remainder is MODIFY
+        size_t target_window = 4096;
+    };
+
+    explicit BookOpGenerator(const Config& config)
+        : config_(config), rng_(config.seed) {}
+
+    BookOp next() {
+        int roll = static_cast<int>(rng_() % 100);
+        BookOp op{};
+        op.side = (rng_() & 1) ? Side::BUY : Side::SELL;
+        op.user_id = 1 + static_cast<uint32_t>(rng_() % config_.users);
+        op.price = random_price(op.side);
+        op.quantity = 1 + static_cast<Quantity>(rng_() % config_.max_quantity);
+
+        if (live_.empty() || (roll < config_.add_pct && live_.size() < config_.target_window)) {
+            op.type = BookOpType::ADD;
+        } else if (roll < config_.add_pct + config_.market_pct) {
+            op.type = BookOpType::MARKET;
+            op.price = 0;
+        } else if (roll < config_.add_pct + config_.market_pct + config_.cancel_pct ||
+                   live_.size() >= config_.target_window) {
+            op.type = BookOpType::CANCEL;
+            size_t pick = rng_() % live_.size();
+            op.ref = live_[pick];
+            live_[pick] = live_.back();
+            live_.pop_back();
+            return op;
+        } else {
+            op.type = BookOpType::MODIFY;
+            op.ref = live_[rng_() % live_.size()];
+            return op;
+        }
+
+        op.ref = next_ref_++;
+        if (op.type == BookOpType::ADD) {
+            live_.push_back(op.ref);
+        }
+        return op;
+    }
+
+private:
+    Price random_price(Side side) {
+        // Slightly aggressive skew so a fraction of limits cross
+        int offset = static_cast<int>(rng_() % (2 * config_.price_levels + 1)) - config_.price_levels;
+        Price skew = (side == Side::BUY ? -1 : 1) * config_.tick_size * (config_.price_levels / 5);
+        return config_.mid_price + offset * config_.tick_size + skew;
+    }
+
+    Config config_;
+    std::mt19937_64 rng_;
+    std::vector<uint64_t> live_;
+    uint64_t next_ref_ = 0;
+};
+
+struct BookDivergence {
+    uint64_t step;
+    std::string what;
+};
+
+template<typename ReferenceBook, typename CandidateBook>
+class DifferentialHarness {
+public:
+    // ref -> handle table for streamed runs; older refs are forgotten
+    static constexpr size_t STREAM_REF_TABLE_SIZE = 1 << 20;
+
+    // Stream `count` generated ops; stops at the first divergence
+    std::optional<BookDivergence> run(BookOpGenerator& generator, uint64_t count) {
+        Session session(*this, STREAM_REF_TABLE_SIZE);
+        for (uint64_t step = 0; step < count; ++step) {
+            if (auto div = session.apply(generator.next(), step)) return div;
+        }
+        return std::nullopt;
+    }
+
+    // Sized past the largest ref, so no two orders share a table entry:
+    // shrunk reproducers keep their original (sparse) refs
+    std::optional<BookDivergence> run(const std::vector<BookOp>& ops) {
+        uint64_t max_ref = 0;
+        for (const BookOp& op : ops) max_ref = std::max(max_ref, op.ref);
+        Session session(*this, std::bit_ceil(static_cast<size_t>(max_ref) + 1));
+        for (uint64_t step = 0; step < ops.size(); ++step) {
+            if (auto div = session.apply(ops[step], step)) return div;
+        }
+        return std::nullopt;
+    }
+
+    // Regenerate the first `steps` ops of a generator stream (for shrinking)
+    static std::vector<BookOp> record(const BookOpGenerator::Config& config, uint64_t steps) {
+        BookOpGenerator generator(config);
+        std::vector<BookOp> ops;
+        ops.reserve(steps);
+        for (uint64_t i = 0; i < steps; ++i) ops.push_back(generator.next());
+        return ops;
+    }
+
+    // Delta-debugging (ddmin): remove chunks while the sequence still
+    // diverges, halving the chunk size until single ops are tried.
+    // `max_runs` bounds the work on very long prefixes.
+    std::vector<BookOp> shrink(std::vector<BookOp> ops, size_t max_runs = 100000) {
+        if (!run(ops)) return ops;
+
+        // A divergence at step k never depends on later ops
+        ops.resize(run(ops)->step + 1);
+
+        size_t runs = 0;
+        size_t chunk = ops.size() / 2;
+        while (chunk >= 1 && runs < max_runs) {
+            bool removed = false;
+            for (size_t start = 0; start < ops.size() && runs < max_runs; ) {
+                std::vector<BookOp> trial;
+                trial.reserve(ops.size());
+                trial.insert(trial.end(), ops.begin(), ops.begin() + start);
+                trial.insert(trial.end(), ops.begin() + std::min(ops.size(), start + chunk), ops.end());
+
+                ++runs;
+                if (auto div = run(trial)) {
+                    trial.resize(div->step + 1);
+                    ops = std::move(trial);
+                    removed = true;
+                } else {
+                    start += chunk;
+                }
+            }
+            if (!removed) chunk /= 2;
+            else chunk = std::min(chunk, ops.size() / 2);
+        }
+        return ops;
+    }
+
+    uint64_t steps_compared() const { return steps_compared_; }
+
+private:
+    struct RefEntry {
+        uint64_t ref = ~0ULL;
+        OrderHandle handle = INVALID_ORDER_HANDLE;
+    };
+
+    struct Session {
+        Session(DifferentialHarness& harness, size_t table_size)
+            : h(harness), ref_table(table_size), ref_mask(table_size - 1) {
+            ref_book.set_trade_callback([this](const Trade& t) { ref_trades.push_back(t); });
+            cand_book.set_trade_callback([this](const Trade& t) { cand_trades.push_back(t); });
+        }
+
+        std::optional<BookDivergence> apply(const BookOp& op, uint64_t step) {
+            ref_trades.clear();
+            cand_trades.clear();
+            Order* ref_order = nullptr;
+            Order* cand_order = nullptr;
+            OrderHandle handle = INVALID_ORDER_HANDLE;
+
+            switch (op.type) {
+                case BookOpType::ADD:
+                case BookOpType::MARKET: {
+                    size_t slot = ref_pool.allocate_slot();
+                    cand_pool.allocate_slot();  // Pools move in lockstep
+                    handle = make_order_handle(static_cast<uint32_t>(slot), ref_pool.generation(slot));
+                    Order order(handle, op.price, op.quantity, step, op.side,
+                                op.type == BookOpType::MARKET ? OrderType::MARKET : OrderType::LIMIT,
+                                op.user_id);
+                    ref_order = ref_pool.at(slot);
+                    cand_order = cand_pool.at(slot);
+                    *ref_order = order;
+                    *cand_order = order;
+                    ref_table[op.ref & ref_mask] = RefEntry{op.ref, handle};
+                    ref_book.add_order(ref_order);
+                    cand_book.add_order(cand_order);
+                    break;
+                }
+                case BookOpType::CANCEL:
+                case BookOpType::MODIFY: {
+                    handle = lookup(op.ref);
+                    if (handle == INVALID_ORDER_HANDLE) return std::nullopt;  // Removed or too old
+                    ref_order = ref_pool.at(handle_slot(handle));
+                    cand_order = cand_pool.at(handle_slot(handle));
+                    bool ref_ok, cand_ok;
+                    if (op.type == BookOpType::CANCEL) {
+                        ref_ok = ref_book.cancel_order(ref_order);
+                        cand_ok = cand_book.cancel_order(cand_order);
+                    } else {
+                        Quantity qty = ref_order->filled + op.quantity;
+                        ref_ok = ref_book.modify_order(ref_order, op.price, qty);
+                        cand_ok = cand_book.modify_order(cand_order, op.price, qty);
+                    }
+                    if (ref_ok != cand_ok) return diverge(step, "cancel/modify acceptance differs");
+                    break;
+                }
+            }
+
+            ++h.steps_compared_;
+            if (auto div = compare(step, ref_order, cand_order)) return div;
+
+            // Recycle orders that are terminal in both books
+            for (const Trade& t : ref_trades) {
+                retire(t.buy_order_id);
+                retire(t.sell_order_id);
+            }
+            retire(handle);
+            return std::nullopt;
+        }
+
+        std::optional<BookDivergence> compare(uint64_t step, const Order* ref_order, const Order* cand_order) {
+            if (ref_trades.size() != cand_trades.size()) {
+                return diverge(step, "trade count " + std::to_string(ref_trades.size()) +
+                                     " vs " + std::to_string(cand_trades.size()));
+            }
+            for (size_t i = 0; i < ref_trades.size(); ++i) {
+                const Trade& a = ref_trades[i];
+                const Trade& b = cand_trades[i];
+                if (a.buy_order_id != b.buy_order_id || a.sell_order_id != b.sell_order_id ||
+                    a.price != b.price || a.quantity != b.quantity) {
+                    return diverge(step, "trade " + std::to_string(i) + " differs");
+                }
+            }
+            if (ref_order && (ref_order->status != cand_order->status ||
+                              ref_order->filled != cand_order->filled)) {
+                return diverge(step, "order state differs");
+            }
+            if (ref_book.best_bid() != cand_book.best_bid()) return diverge(step, "best bid differs");
+            if (ref_book.best_ask() != cand_book.best_ask()) return diverge(step, "best ask differs");
+            if (ref_book.bid_volume() != cand_book.bid_volume()) return diverge(step, "bid volume differs");
+            if (ref_book.ask_volume() != cand_book.ask_volume()) return diverge(step, "ask volume differs");
+
+            Price ref_px, cand_px;
+            Quantity ref_qty = 0, cand_qty = 0;
+            for (Side side : {Side::BUY, Side::SELL}) {
+                size_t rn = ref_book.depth(side, 1, &ref_px, &ref_qty);
+                size_t cn = cand_book.depth(side, 1, &cand_px, &cand_qty);
+                if (rn != cn || (rn && ref_qty != cand_qty)) {
+                    return diverge(step, "top level quantity differs");
+                }
+            }
+            return std::nullopt;
+        }
+
+        OrderHandle lookup(uint64_t ref) const {
+            const RefEntry& e = ref_table[ref & ref_mask];
+            if (e.ref != ref || e.handle == INVALID_ORDER_HANDLE) return INVALID_ORDER_HANDLE;
+            uint32_t slot = handle_slot(e.handle);
+            return ref_pool.generation(slot) == handle_generation(e.handle) ? e.handle : INVALID_ORDER_HANDLE;
+        }
+
+        void retire(OrderHandle handle) {
+            if (handle == INVALID_ORDER_HANDLE) return;
+            uint32_t slot = handle_slot(handle);
+            if (slot >= ref_pool.capacity() || ref_pool.generation(slot) != handle_generation(handle)) return;
+            if (is_terminal(*ref_pool.at(slot)) && is_terminal(*cand_pool.at(slot))) {
+                ref_pool.release(slot);
+                cand_pool.release(slot);
+            }
+        }
+
+        static bool is_terminal(const Order& order) {
+            return order.status == OrderStatus::FILLED || order.status == OrderStatus::CANCELLED;
+        }
+
+        static std::optional<BookDivergence> diverge(uint64_t step, std::string what) {
+            return BookDivergence{step, std::move(what)};
+        }
+
+        DifferentialHarness& h;
+        std::vector<RefEntry> ref_table;
+        size_t ref_mask;
+        MemoryPool<Order> ref_pool;
+        MemoryPool<Order> cand_pool;
+        ReferenceBook ref_book{"REF"};
+        CandidateBook cand_book{"CAND"};
+        std::vector<Trade> ref_trades;
+        std::vector<Trade> cand_trades;
+    };
+
+    uint64_t steps_compared_ = 0;
+};
+
+// Ops file: one "type,side,user,ref,price,quantity" line per op
+inline bool save_book_ops(const std::string& path, const std::vector<BookOp>& ops) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "type,side,user,ref,price,quantity\n");
+    for (const BookOp& op : ops) {
+        std::fprintf(f, "%d,%d,%u,%llu,%lld,%lld\n", static_cast<int>(op.type), static_cast<int>(op.side),
+                     op.user_id, static_cast<unsigned long long>(op.ref),
+                     static_cast<long long>(op.price), static_cast<long long>(op.quantity));
+    }
+    std::fclose(f);
+    return true;
+}
+
+inline std::vector<BookOp> load_book_ops(const std::string& path) {
+    std::vector<BookOp> ops;
+    std::FILE* f = std::fopen(path.c_str(), "r");
+    if (!f) return ops;
+
+    char header[128];
+    if (!std::fgets(header, sizeof(header), f)) {
+        std::fclose(f);
+        return ops;
+    }
+    int type, side;
+    unsigned user;
+    unsigned long long ref;
+    long long price, quantity;
+    while (std::fscanf(f, "%d,%d,%u,%llu,%lld,%lld", &type, &side, &user, &ref, &price, &quantity) == 6) {
+        ops.push_back(BookOp{static_cast<BookOpType>(type), static_cast<Side>(side), user, ref,
+                             static_cast<Price>(price), static_cast<Quantity>(quantity)});
+    }
+    std::fclose(f);
+    return ops;
+}
+
+} // namespace trading
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "types.hpp"
+#include <iterator>
+
+namespace trading {
+
+// Microstructure features kept current by an OrderBook (enable_features()).
+// Every field is refreshed in O(1) after each book operation; strategies
+// read the struct instead of walking the levels.
+struct BookFeatures {
+    Price bid = 0;
+    Price ask = 0;
+    Quantity bid_quantity = 0;
+    Quantity ask_quantity = 0;
+    double mid = 0.0;
+    // Size-weighted mid: (bid * ask_qty + ask * bid_qty) / (bid_qty + ask_qty)
+    double microprice = 0.0;
+    // (bid_qty - ask_qty) / (bid_qty + ask_qty) at the touch, in [-1, 1]
+    double imbalance = 0.0;
+    // Quantity over the best `depth_levels` levels of each side
+    Quantity bid_depth = 0;
+    Quantity ask_depth = 0;
+    double depth_imbalance = 0.0;
+    // EWMA rate (quantity per second) at which the touch is consumed by
+    // fills, cancels and size-downs, as of the last removal
+    double bid_depletion = 0.0;
+    double ask_depletion = 0.0;
+    Timestamp timestamp = 0;  // Book time of the last refresh
+    uint64_t updates = 0;
+};
+
+// Running quantity of the best n levels of one book side. `boundary_` is
+// the worst level inside the window; level inserts and erases move it by
+// at most one step, so every hook is O(1) (amortized map iterator steps).
+template<typename Levels>
+class TopLevelsDepth {
+public:
+    using Iterator = typename Levels::iterator;
+
+    // O(n) rebuild, e.g. after a batch operation such as an auction uncross
+    void reset(Levels& levels, size_t n) {
+        n_ = n ? n : 1;
+        count_ = 0;
+        quantity_ = 0;
+        boundary_ = levels.end();
+        for (auto it = levels.begin(); it != levels.end() && count_ < n_; ++it) {
+            quantity_ += it->second.total_quantity;
+            boundary_ = it;
+            ++count_;
+        }
+    }
+
+    // After a new level was created at `it` (its quantity already added)
+    void inserted(Levels& levels, Iterator it) {
+        if (count_ < n_) {
+            quantity_ += it->second.total_quantity;
+            ++count_;
+            if (boundary_ == levels.end() || levels.key_comp()(boundary_->first, it->first)) {
+                boundary_ = it;
+            }
+        } else if (levels.key_comp()(it->first, boundary_->first)) {
+            // Pushes the old boundary out of the window
+            quantity_ += it->second.total_quantity - boundary_->second.total_quantity;
+            boundary_ = std::prev(boundary_);
+        }
+    }
+
+    void changed(const Levels& levels, Iterator it, Quantity delta) {
+        if (contains(levels, it)) quantity_ += delta;
+    }
+
+    // Before the level at `it` is erased; the next level slides in
+    void erasing(Levels& levels, Iterator it) {
+        if (!contains(levels, it)) return;
+        quantity_ -= it->second.total_quantity;
+        auto next = std::next(boundary_);
+        if (next != levels.end()) {
+            quantity_ += next->second.total_quantity;
+            boundary_ = next;
+        } else {
+            --count_;
+            if (it == boundary_) {
+                boundary_ = it == levels.begin() ? levels.end() : std::prev(it);
+            }
+        }
+    }
+
+    Quantity quantity() const { return quantity_; }
+
+private:
+    bool contains(const Levels& levels, Iterator it) const {
+        return count_ > 0 && !levels.key_comp()(boundary_->first, it->first);
+    }
+
+    size_t n_ = 1;
+    size_t count_ = 0;
+    Quantity quantity_ = 0;
+    Iterator boundary_{};
+};
+
+} // namespace trading
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "types.hpp"
+#include "order_book.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+
+namespace trading {
+
+// Background file writer for column-major chunks. The sampling thread only
+// swaps buffers under a mutex; all I/O happens on the writer thread. Short
+// writes (e.g. a full disk) are recorded in failed() rather than dropped.
+class AsyncColumnWriter {
+public:
+    struct Chunk {
+        std::vector<int64_t> data;  // column c, row r at data[c * capacity + r]
+        size_t capacity = 0;
+        size_t rows = 0;
+    };
+
+    AsyncColumnWriter(const std::string& path, const void* header, size_t header_size);
+    ~AsyncColumnWriter();  // close() unless already closed
+
+    // Drains pending chunks, joins and closes the file; false if any write
+    // (or the close itself) came up short. No submits afterwards.
+    bool close();
+
+    Chunk acquire(size_t columns, size_t capacity);  // Recycled buffer when available
+    void submit(Chunk chunk);
+    size_t queue_depth() const;
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void write_chunk(const Chunk& chunk);
+
+    std::FILE* file_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Chunk> pending_;
+    std::vector<Chunk> free_;
+    bool stop_ = false;
+    std::atomic<bool> failed_{false};
+};
+
+struct SamplerConfig {
+    std::string path;
+    Timestamp interval_ns = 0;    // Sample on each crossed interval boundary (0 = off)
+    uint64_t every_n_events = 0;  // Sample every N ticks (0 = off)
+    size_t depth_levels = 5;
+    size_t rows_per_chunk = 4096;  // 0 is treated as 1
+};
+
+// Periodic book-state sampler. Reads books between events through const
+// accessors only, so matching is never disturbed.
+//
+// File layout (little-endian int64 throughout):
+//   header: "BTSAMPL1", depth_levels, column_count
+//   chunks: row_count, then each column's row_count values contiguously
+// Columns: timestamp, symbol_id, best_bid, best_ask, spread, imbalance_bps,
+//          bid_px[N], bid_qty[N], ask_px[N], ask_qty[N]
+class BookSampler {
+public:
+    static constexpr size_t FIXED_COLUMNS = 6;
+
+    explicit BookSampler(const SamplerConfig& config);
+    ~BookSampler();  // Flushes the partial chunk; call close() to see write errors
+
+    void add_book(SymbolId symbol, const OrderBook* book);
+    void on_event(Timestamp now);
+    // Both throw std::runtime_error once a write to the file has failed
+    void flush();
+    void close();  // Flushes and waits for the file to be complete; stops sampling
+    bool failed() const { return writer_.failed(); }
+
+    size_t column_count() const { return FIXED_COLUMNS + 4 * config_.depth_levels; }
+    uint64_t rows_written() const { return rows_written_; }
+    size_t queue_depth() const { return writer_.queue_depth(); }
+
+private:
+    static std::vector<int64_t> make_header(const SamplerConfig& config);
+    void sample_all(Timestamp now);
+    void sample_book(Timestamp now, SymbolId symbol, const OrderBook& book);
+    void submit_chunk();
+
+    SamplerConfig config_;
+    std::vector<int64_t> header_;
+    AsyncColumnWriter writer_;
+    std::vector<std::pair<SymbolId, const OrderBook*>> books_;
+    AsyncColumnWriter::Chunk chunk_;
+    std::vector<Price> prices_;
+    std::vector<Quantity> quantities_;
+    Timestamp next_sample_time_ = 0;
+    uint64_t events_ = 0;
+    uint64_t rows_written_ = 0;
+};
+
+} // namespace trading
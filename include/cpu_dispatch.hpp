@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trading {
+
+// Instruction-set tiers that kernels are compiled for. Every tier is built
+// into the same binary; the best one the host supports is picked once at
+// startup, so binaries are portable across the fleet.
+enum class CpuLevel : uint8_t {
+    SCALAR = 0,
+    SSE42 = 1,
+    AVX2 = 2,
+    AVX512 = 3
+};
+
+// Column pointers for a batch of European options on one underlying.
+// sign is +1 for calls and -1 for puts; time in years and vol must be > 0.
+struct OptionBatch {
+    const double* strike;
+    const double* time;
+    const double* vol;
+    const double* sign;
+    double* value;
+    double* delta;
+    double* gamma;
+    double* vega;   // Per 1.0 of volatility
+};
+
+struct KernelTable {
+    CpuLevel level;
+    const char* name;
+
+    // Indicators: wrapping sum of n values
+    int64_t (*sum_i64)(const int64_t* values, size_t n);
+    // Parsing: index of the first `byte` in data[0..n), or n if absent
+    size_t (*find_byte)(const char* data, size_t n, char byte);
+    // Book scans: out[i] = in[0] + ... + in[i]; in and out may alias
+    void (*prefix_sum_i64)(const int64_t* in, int64_t* out, size_t n);
+    // Covariance: row[i] += (a * x[i] + b * y[i]), rank-2 update of one row.
+    // No FMA contraction (cpu_dispatch.cpp builds with -ffp-contract=off),
+    // so every tier rounds identically.
+    void (*rank2_update_f64)(double* row, double a, const double* x,
+                             double b, const double* y, size_t n);
+    // Options: Black-Scholes value, delta, gamma and vega of n options at
+    // `spot` with continuously compounded `rate`. exp/log/normal CDF are
+    // polynomial and rational approximations (~1e-14 relative), evaluated
+    // 4 lanes wide in AVX2 and 8 wide with FMA in AVX-512 (which therefore
+    // rounds slightly differently); SSE4.2 runs the scalar code.
+    void (*black_scholes_f64)(double spot, double rate, const OptionBatch& batch, size_t n);
+};
+
+// Highest tier supported by this CPU (cpuid-based)
+CpuLevel detect_cpu_level();
+
+// True if kernels for `level` exist in this build and can run on this CPU
+bool cpu_level_supported(CpuLevel level);
+
+// Kernel table for a specific tier; falls back to SCALAR when unsupported
+const KernelTable& kernel_table(CpuLevel level);
+
+// Kernel table selected once at first use. BT_KERNELS=scalar|sse42|avx2|avx512
+// caps the tier (e.g. to reproduce results from an older host).
+const KernelTable& kernels();
+
+const char* cpu_level_name(CpuLevel level);
+
+} // namespace trading
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace trading {
+
+// Set of SymbolIds as a bitset: marking is one OR, and draining visits the
+// marked ids in ascending order while skipping clear words 64 symbols at
+// a time. Every id that may be marked must be reserve()d first, which
+// keeps mark() branch-free.
+class DirtySymbols {
+public:
+    void reserve(SymbolId symbol) {
+        size_t words = (static_cast<size_t>(symbol) >> 6) + 1;
+        if (words > words_.size()) words_.resize(words, 0);
+    }
+
+    void mark(SymbolId symbol) {
+        words_[symbol >> 6] |= uint64_t{1} << (symbol & 63);
+        touched_ = std::max(touched_, (static_cast<size_t>(symbol) >> 6) + 1);  // cmov, not a branch
+    }
+
+    bool any() const { return touched_ > 0; }
+
+    // Clears the set, then calls f(SymbolId) for each id that was marked.
+    // Ids marked from inside f land in the (now empty) set for next time.
+    template<typename F>
+    void drain(F&& f) {
+        size_t words = touched_;
+        touched_ = 0;
+        pending_.assign(words_.begin(), words_.begin() + words);
+        std::fill(words_.begin(), words_.begin() + words, 0);
+        for (size_t w = 0; w < words; ++w) {
+            uint64_t bits = pending_[w];
+            while (bits) {
+                f(static_cast<SymbolId>(w * 64 + std::countr_zero(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+private:
+    std::vector<uint64_t> words_;
+    std::vector<uint64_t> pending_;  // Words being drained
+    size_t touched_ = 0;  // Words past this are all clear
+};
+
+} // namespace trading
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "tick_engine.hpp"
+#include <limits>
+#include <vector>
+
+namespace trading {
+
+enum class ExecutionAlgo : uint8_t {
+    TWAP = 0,  // Linear schedule over [start, end)
+    VWAP = 1,  // Follows the volume profile over [start, end)
+    POV = 2    // Fixed share of market volume traded since start
+};
+
+struct ParentOrder {
+    SymbolId symbol = 0;
+    Side side = Side::BUY;
+    Quantity quantity = 0;
+    Timestamp start = 0;
+    Timestamp end = 0;
+    ExecutionAlgo algo = ExecutionAlgo::TWAP;
+    Timestamp slice_interval = 1000000000;  // 1 s between child decisions
+    double participation = 0.1;             // POV only
+    Price limit_price = 0;                  // 0 = no limit
+};
+
+using ParentId = uint32_t;
+
+// Implementation shortfall against the arrival price (touch mid when the
+// parent starts, else last trade/tick, else the one-sided touch). Executed
+// cost plus opportunity cost of the unfilled rest at the latest price;
+// positive = worse than arrival.
+struct ExecutionReport {
+    Quantity quantity = 0;
+    Quantity filled = 0;
+    Price arrival_price = 0;
+    double average_price = 0.0;
+    uint32_t children = 0;
+    double shortfall = 0.0;      // Price units x quantity
+    double shortfall_bps = 0.0;  // Of arrival notional
+    bool done = false;
+};
+
+// Built-in parent-order execution as a Strategy: every slice_interval a
+// parent recomputes its cumulative target for the end of the next slice,
+// cancels its working child and sends one new marketable child for the
+// shortfall at the far touch (capped by limit_price). Fills are attributed
+// through the child's OrderHandle slot, so ownership costs one array read
+// per trade side. Parent state is kept column-wise so tens of thousands of
+// parents stay compact; each parent costs one timer per slice.
+class ExecutionAlgos : public Strategy {
+public:
+    // engine must outlive this object; children carry user_id
+    explicit ExecutionAlgos(TickEngine& engine, uint32_t user_id = 4);
+
+    // Relative volume per equal-length bucket of a VWAP parent's horizon
+    // (e.g. a U-shaped intraday curve); normalized. Flat (= TWAP) by default.
+    void set_volume_profile(const std::vector<double>& profile);
+
+    ParentId submit(const ParentOrder& parent);
+    void cancel(ParentId id);  // Pulls the working child; reports as done
+
+    ExecutionReport report(ParentId id) const;
+    size_t parents() const { return quantity_.size(); }
+    size_t active_parents() const { return active_; }
+
+    void on_tick(const Tick& tick, TickEngine* engine) override;
+    void on_trade(const Trade& trade) override;
+    void on_timer(uint64_t tag, TickEngine* engine) override;
+    const char* name() const override { return "ExecutionAlgos"; }
+
+private:
+    static constexpr ParentId NO_PARENT = std::numeric_limits<ParentId>::max();
+
+    // Cumulative quantity that should be done by `at`
+    Quantity target_quantity(ParentId id, Timestamp at) const;
+    double profile_fraction(double elapsed) const;
+    void pull_child(ParentId id);
+    void send_child(ParentId id, Quantity quantity);
+    void finish(ParentId id);
+    void attribute(OrderHandle handle, const Trade& trade);
+    Price last_price(SymbolId symbol) const;
+
+    TickEngine& engine_;
+    uint32_t user_id_;
+    std::vector<double> profile_cumulative_;  // Fraction done by each bucket end
+    size_t active_ = 0;
+    ParentId sending_ = NO_PARENT;  // Parent whose child is being submitted
+    OrderHandle sending_handle_ = INVALID_ORDER_HANDLE;  // ... and the handle it will get
+
+    // Parent columns
+    std::vector<SymbolId> symbol_;
+    std::vector<Side> side_;
+    std::vector<ExecutionAlgo> algo_;
+    std::vector<uint8_t> done_;
+    std::vector<Quantity> quantity_;
+    std::vector<Quantity> filled_;
+    std::vector<Timestamp> start_;
+    std::vector<Timestamp> end_;
+    std::vector<Timestamp> interval_;
+    std::vector<double> participation_;
+    std::vector<Price> limit_;
+    std::vector<Price> arrival_;
+    std::vector<double> notional_;
+    std::vector<uint64_t> volume_at_start_;
+    std::vector<OrderHandle> child_;
+    std::vector<uint32_t> children_;
+
+    std::vector<uint32_t> owner_;           // Order pool slot -> parent + 1
+    std::vector<uint64_t> market_volume_;   // SymbolId -> tick volume seen
+    std::vector<Price> last_tick_price_;    // SymbolId -> last tick price
+    std::vector<OrderHandle> retired_;      // Filled children, released later
+};
+
+} // namespace trading
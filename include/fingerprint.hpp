@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.hpp"
+#include <vector>
+
+namespace trading {
+
+// splitmix64 finalizer: cheap, full-avalanche 64-bit mixing
+constexpr uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Rolling hash of the ordered event stream per symbol, combined across
+// symbols by wrapping addition. Per-symbol order matters; the interleaving
+// of symbols does not, so shards owning disjoint symbols can be merged by
+// adding their values and compared with a serial run.
+class RunFingerprint {
+public:
+    enum EventKind : uint64_t {
+        ORDER_ACK = 1,
+        TRADE = 2,
+        CANCEL = 3
+    };
+
+    // Fold one event into the symbol's rolling hash (a few multiplies)
+    void record(SymbolId symbol, EventKind kind, uint64_t a, uint64_t b, uint64_t c, uint64_t d) {
+        if (symbol >= per_symbol_.size()) {
+            per_symbol_.resize(symbol + 1, 0);
+        }
+        uint64_t event = kind ^ (a * 0x9E3779B97F4A7C15ULL) ^ (b * 0xC2B2AE3D27D4EB4FULL) ^
+                         (c * 0x165667B19E3779F9ULL) ^ (d * 0xD6E8FEB86659FD93ULL);
+        uint64_t& h = per_symbol_[symbol];
+        combined_ -= finalize(symbol, h);
+        h = mix64(h ^ event) | 1;  // Zero is reserved for "no events yet"
+        combined_ += finalize(symbol, h);
+    }
+
+    uint64_t value() const { return combined_; }
+    uint64_t symbol_value(SymbolId symbol) const {
+        return symbol < per_symbol_.size() ? finalize(symbol, per_symbol_[symbol]) : 0;
+    }
+
+    // Order-independent combination of fingerprints over disjoint symbols
+    static uint64_t combine(uint64_t a, uint64_t b) { return a + b; }
+
+    // Moves one symbol's rolling state between fingerprints (a book changing
+    // shards): take() leaves the symbol empty here, put() installs it
+    uint64_t take(SymbolId symbol) {
+        if (symbol >= per_symbol_.size()) return 0;
+        uint64_t h = per_symbol_[symbol];
+        combined_ -= finalize(symbol, h);
+        per_symbol_[symbol] = 0;
+        return h;
+    }
+    void put(SymbolId symbol, uint64_t state) {
+        if (symbol >= per_symbol_.size()) {
+            per_symbol_.resize(symbol + 1, 0);
+        }
+        combined_ += finalize(symbol, state) - finalize(symbol, per_symbol_[symbol]);
+        per_symbol_[symbol] = state;
+    }
+
+private:
+    // Symbols with no events contribute nothing
+    static uint64_t finalize(SymbolId symbol, uint64_t h) {
+        return h == 0 ? 0 : mix64(h ^ (0x9E3779B97F4A7C15ULL * (symbol + 1)));
+    }
+
+    std::vector<uint64_t> per_symbol_;
+    uint64_t combined_ = 0;
+};
+
+} // namespace trading
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "order_book.hpp"
+#include <functional>
+
+namespace trading {
+
+// Best implied bid/ask; a side is present only when its quantity is > 0
+// (spread prices can legitimately be zero or negative)
+struct ImpliedQuote {
+    Price bid = 0;
+    Quantity bid_quantity = 0;
+    Price ask = 0;
+    Quantity ask_quantity = 0;
+};
+
+// Two-leg spread linking three books: buying one spread buys `front` and
+// sells `back`, so spread price = front - back (e.g. a calendar spread).
+//
+// Implied-in: spread quotes derived from the legs' tops.
+// Implied-out: leg quotes derived from the spread top and the other leg.
+// Both are recomputed in O(1) from top listeners, only when one of the
+// three books changes its best price or size.
+//
+// Spread orders go through add_order(): at each step they take whichever
+// of the direct spread book and implied-in liquidity is better (direct on
+// ties). An implied fill is first capped to what both leg tops execute
+// for the order's user (net of its own resting orders when self-trade
+// prevention is on), so both legs fill in full and no naked leg is left;
+// both leg orders are sent before returning, so no other order can
+// interleave.
+//
+// Outright orders on a leg go through add_outright() the same way against
+// the leg book and the implied-out quotes of every spread on that leg: an
+// implied-out fill trades the spread book and the other leg with the same
+// cap, e.g. buying front buys the spread and buys back.
+class ImpliedSpread {
+public:
+    // Implied fills with the book they print on: the spread book for spread
+    // orders, the leg book for outright orders
+    using TradeCallback = std::function<void(const Trade&, const OrderBook&)>;
+
+    ImpliedSpread(OrderBook& front, OrderBook& back, OrderBook& spread);
+    ~ImpliedSpread();
+    ImpliedSpread(const ImpliedSpread&) = delete;
+    ImpliedSpread& operator=(const ImpliedSpread&) = delete;
+
+    void add_order(Order* order);
+    // `leg` is the front or back book of each spread in [first, last)
+    static void add_outright(Order* order, OrderBook& leg, ImpliedSpread* const* first,
+                             ImpliedSpread* const* last);
+
+    const ImpliedQuote& implied_in() const { return implied_in_; }
+    const ImpliedQuote& implied_out_front() const { return implied_out_front_; }
+    const ImpliedQuote& implied_out_back() const { return implied_out_back_; }
+    const ImpliedQuote& implied_out(const OrderBook& leg) const {
+        return &leg == &front_ ? implied_out_front_ : implied_out_back_;
+    }
+
+    // Fills against implied liquidity (sell_order_id / buy_order_id of the
+    // implied side is 0; the other books' trades go to their own callbacks)
+    void set_trade_callback(TradeCallback cb) { trade_callback_ = std::move(cb); }
+
+    OrderBook& spread_book() { return spread_; }
+    size_t implied_fills() const { return implied_fills_; }
+    uint64_t recomputes() const { return recomputes_; }
+
+private:
+    void recompute();
+    Quantity execute_implied(Order* order, Price price, Quantity quantity);
+    Quantity execute_implied_out(Order* order, OrderBook& leg, Price price, Quantity quantity);
+    Quantity send_legs(Order* order, OrderBook& first, Side first_side, OrderBook& second,
+                       Side second_side, Quantity quantity);
+    void record_fill(Order* order, Price price, Quantity filled, const OrderBook& book);
+
+    OrderBook& front_;
+    OrderBook& back_;
+    OrderBook& spread_;
+    uint32_t listener_ids_[3];
+    ImpliedQuote implied_in_;
+    ImpliedQuote implied_out_front_;
+    ImpliedQuote implied_out_back_;
+    TradeCallback trade_callback_;
+    size_t implied_fills_ = 0;
+    uint64_t recomputes_ = 0;
+};
+
+} // namespace trading
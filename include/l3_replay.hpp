@@ -0,0 +1,146 @@
+#pragma once
+
+#include "order_book.hpp"
+#include "memory_pool.hpp"
+#include "book_diff.hpp"
+#include "fingerprint.hpp"
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Order-by-order (L3) market data, as venues publish it
+enum class L3MessageType : uint8_t {
+    ADD = 0,      // New resting order: side, price, quantity
+    CANCEL = 1,   // Partial cancel of `quantity`
+    DELETE = 2,   // Rest of the order cancelled
+    EXECUTE = 3,  // `quantity` of the resting order traded with an aggressor
+    REPLACE = 4   // Cancel and re-add as new_order_id at price/quantity (same side)
+};
+
+struct L3Message {
+    Timestamp timestamp = 0;
+    uint64_t order_id = 0;      // Venue order reference
+    uint64_t new_order_id = 0;  // REPLACE only
+    L3MessageType type = L3MessageType::ADD;
+    Side side = Side::BUY;
+    Price price = 0;
+    Quantity quantity = 0;
+};
+
+// Replays a historical L3 feed into an OrderBook that strategy orders can
+// trade in. History stays authoritative for historical orders; what the
+// strategy changes is reconciled as messages arrive:
+//   - Historical quantity the strategy trades against leaves the book but
+//     still exists in the feed. That difference is the order's ghost
+//     quantity (historical open quantity minus what rests in the book).
+//   - A later EXECUTE or CANCEL of that order consumes ghost first, so the
+//     historical trade is not replayed twice; a DELETE drops it.
+//   - An EXECUTE is replayed as an aggressor sweeping to the order's price,
+//     so strategy orders queued ahead of it (better price, or earlier at
+//     the same price) fill first. The historical order still shrinks by the
+//     full executed quantity, i.e. those fills add to historical volume.
+//   - A historical ADD that crosses resting strategy orders trades with
+//     them; the filled part becomes ghost.
+// Orders live in a pool addressed by OrderHandle and the book's order
+// index is kept on, so cancels and executes are O(1) per message.
+class L3Replay {
+public:
+    using TradeCallback = std::function<void(const Trade&)>;
+
+    explicit L3Replay(const std::string& symbol, uint32_t historical_user = 0);
+
+    void apply(const L3Message& message);
+    void replay(const L3Message* messages, size_t count);
+
+    // Strategy orders. The returned handle is also the Order/Trade id;
+    // release_order() cancels anything still open and recycles the slot.
+    OrderHandle submit_order(const Order& order);
+    bool cancel_order(OrderHandle handle);
+    const Order* find_order(OrderHandle handle) const;
+    void release_order(OrderHandle handle);
+    bool is_strategy_order(OrderId id) const;
+
+    // Every book trade: replayed executions and strategy fills alike.
+    // Replayed aggressors carry INVALID_ORDER_HANDLE as their order id.
+    void set_trade_callback(TradeCallback cb) { trade_callback_ = std::move(cb); }
+
+    OrderBook& book() { return book_; }
+    const OrderBook& book() const { return book_; }
+    Timestamp now() const { return now_; }
+
+    // Ghost quantity of one live historical order, and of all of them
+    Quantity ghost(uint64_t venue_id) const;
+    Quantity ghost_quantity() const { return ghost_; }
+    size_t historical_orders() const { return ids_.size(); }
+
+    struct Stats {
+        uint64_t messages = 0;
+        uint64_t unknown_orders = 0;     // Messages for ids not in the book
+        uint64_t strategy_orders = 0;
+        Quantity strategy_volume = 0;    // Strategy fills, both sides
+        Quantity ghost_created = 0;      // Historical quantity taken by the strategy
+        Quantity ghost_reconciled = 0;   // ...and later executed or cancelled in history
+    };
+    const Stats& stats() const { return stats_; }
+
+private:
+    static constexpr uint32_t NOT_EXECUTING = std::numeric_limits<uint32_t>::max();
+
+    // Venue order id -> pool handle; open addressing with linear probing
+    // and backward-shift deletion, kept at most half full
+    class VenueIdMap {
+    public:
+        VenueIdMap() : entries_(1024) {}
+        OrderHandle find(uint64_t id) const;
+        void insert(uint64_t id, OrderHandle handle);
+        void erase(uint64_t id);
+        size_t size() const { return size_; }
+
+    private:
+        struct Entry {
+            uint64_t id = 0;
+            OrderHandle handle = INVALID_ORDER_HANDLE;  // Empty when invalid
+        };
+        size_t home(uint64_t id) const { return mix64(id) & (entries_.size() - 1); }
+        void grow();
+
+        std::vector<Entry> entries_;
+        size_t size_ = 0;
+    };
+
+    size_t allocate_slot();
+    Order* live(OrderHandle handle);
+    Quantity book_remaining(const Order& order) const {
+        return order.is_open() ? order.remaining() : 0;
+    }
+
+    void add(uint64_t venue_id, Side side, Price price, Quantity quantity);
+    void reduce(uint64_t venue_id, Quantity quantity, bool executed);
+    void retire(uint64_t venue_id, OrderHandle handle);
+    void on_trade(const Trade& trade);
+    void track_ghost(OrderId id, Quantity quantity);
+
+    OrderBook book_;
+    uint32_t historical_user_;
+    MemoryPool<Order> pool_;
+    // Pool slot columns
+    std::vector<Quantity> remaining_;      // Historical open quantity (feed's view)
+    std::vector<uint8_t> historical_;
+    VenueIdMap ids_;
+    TradeCallback trade_callback_;
+    Timestamp now_ = 0;
+    Quantity ghost_ = 0;
+    uint32_t executing_ = NOT_EXECUTING;  // Slot whose EXECUTE is being replayed
+    Stats stats_;
+};
+
+// Synthetic L3 feed: runs a generated operation stream through a reference
+// OrderBook and records what a venue would publish (ADD for resting
+// quantity, EXECUTE per passive fill, CANCEL for size-downs, DELETE).
+// Venue ids are the generator's order refs.
+std::vector<L3Message> record_l3_feed(const BookOpGenerator::Config& config, size_t ops);
+
+} // namespace trading
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace trading {
+
+// Shared-memory layout for live run monitoring (see bt-top). Each engine
+// thread owns one slot and is its only writer, so updates are relaxed
+// stores; readers in other processes tolerate slightly stale values.
+struct alignas(64) LiveThreadStats {
+    static constexpr size_t LATENCY_BUCKETS = 64;  // bucket b counts latencies in [2^(b-1), 2^b) ns
+
+    enum State : uint64_t { IDLE = 0, RUNNING = 1, FINISHED = 2 };
+
+    std::atomic<uint64_t> state{IDLE};
+    std::atomic<uint64_t> heartbeat_ns{0};  // steady_clock time of last publish
+    std::atomic<uint64_t> ticks_processed{0};
+    std::atomic<uint64_t> orders_submitted{0};
+    std::atomic<uint64_t> trades_executed{0};
+    std::atomic<uint64_t> total_latency_ns{0};
+    std::atomic<uint64_t> pool_allocated{0};
+    std::atomic<uint64_t> pool_bytes{0};
+    std::atomic<uint64_t> queue_depth{0};
+    std::atomic<uint64_t> simulated_time{0};
+    std::atomic<uint64_t> latency_histogram[LATENCY_BUCKETS] = {};
+};
+
+struct LiveStatsSegment {
+    static constexpr uint64_t MAGIC = 0x5354415453544C42ULL;  // "BLTSTATS"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t MAX_THREADS = 64;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t max_threads;
+    uint64_t segment_size;
+    std::atomic<uint64_t> pid;
+    std::atomic<uint64_t> start_ns;
+    std::atomic<uint32_t> threads_in_use;
+    LiveThreadStats threads[MAX_THREADS];
+};
+
+// Creates (publisher) or attaches to (reader) a POSIX shared-memory segment
+// named like "/backtester". Throws std::runtime_error on failure.
+class LiveStatsRegion {
+public:
+    static LiveStatsRegion create(const std::string& name);
+    static LiveStatsRegion attach(const std::string& name);
+
+    LiveStatsRegion(LiveStatsRegion&& other) noexcept;
+    LiveStatsRegion& operator=(LiveStatsRegion&&) = delete;
+    ~LiveStatsRegion();  // Unmaps; the creator also unlinks the name
+
+    LiveStatsSegment* segment() { return segment_; }
+    const LiveStatsSegment* segment() const { return segment_; }
+
+    // Claim the next free thread slot (publisher side)
+    LiveThreadStats* claim_thread_slot();
+
+    static uint64_t now_ns();
+
+private:
+    LiveStatsRegion(LiveStatsSegment* segment, std::string name, bool owner)
+        : segment_(segment), name_(std::move(name)), owner_(owner) {}
+
+    LiveStatsSegment* segment_;
+    std::string name_;
+    bool owner_;
+};
+
+} // namespace trading
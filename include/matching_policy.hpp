@@ -0,0 +1,99 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <iterator>
+#include <list>
+
+namespace trading {
+
+// Level allocation policies for BasicOrderBook. allocate() splits the
+// aggressor's open quantity across the resting queue of one price level:
+//   queue          - resting orders in time priority
+//   level_quantity - sum of remaining quantity in the queue
+//   aggressor      - incoming order; allocation stops once it cannot trade
+//   fill           - fill(resting, qty) trades qty, or applies self-trade
+//                    prevention, and keeps the book's totals in step
+// Resting orders that are no longer open afterwards (filled, or cancelled
+// by self-trade prevention) are erased from the queue.
+
+inline bool can_trade(const Order* order) {
+    return order->is_open() && order->remaining() > 0;
+}
+
+// Strict price-time priority
+struct FifoAllocation {
+    template<typename Fill>
+    static void allocate(std::list<Order*>& queue, Quantity /*level_quantity*/,
+                         Order* aggressor, Fill&& fill) {
+        while (!queue.empty() && can_trade(aggressor)) {
+            Order* resting = queue.front();
+            fill(resting, std::min(aggressor->remaining(), resting->remaining()));
+            if (!resting->is_open()) {
+                queue.pop_front();
+            }
+        }
+    }
+};
+
+namespace detail {
+
+// Cumulative rounding: the order ending at running size C_i receives
+// ceil(C_i * q / T) - ceil(C_{i-1} * q / T). One pass, allocations sum
+// exactly to q, no order gets more than its size, and odd lots go to the
+// earliest orders.
+template<typename Fill>
+void pro_rata_pass(std::list<Order*>& queue, std::list<Order*>::iterator it,
+                   Quantity pool, Order* aggressor, Fill& fill) {
+    Quantity incoming = aggressor->remaining();
+    __int128 cumulative = 0;
+    Quantity given = 0;
+    while (it != queue.end() && given < incoming && can_trade(aggressor)) {
+        Order* resting = *it;
+        cumulative += resting->remaining();
+        Quantity target = static_cast<Quantity>((cumulative * incoming + pool - 1) / pool);
+        if (target > given) {
+            fill(resting, target - given);
+            given = target;
+        }
+        it = resting->is_open() ? std::next(it) : queue.erase(it);
+    }
+}
+
+} // namespace detail
+
+// Pure pro-rata by resting size; time only breaks rounding
+struct ProRataAllocation {
+    template<typename Fill>
+    static void allocate(std::list<Order*>& queue, Quantity level_quantity,
+                         Order* aggressor, Fill&& fill) {
+        if (aggressor->remaining() >= level_quantity) {
+            FifoAllocation::allocate(queue, level_quantity, aggressor, fill);  // Sweeps the level
+        } else {
+            detail::pro_rata_pass(queue, queue.begin(), level_quantity, aggressor, fill);
+        }
+    }
+};
+
+// Top order (front of the level) fills first, the rest is pro-rata
+struct FifoProRataAllocation {
+    template<typename Fill>
+    static void allocate(std::list<Order*>& queue, Quantity level_quantity,
+                         Order* aggressor, Fill&& fill) {
+        if (aggressor->remaining() >= level_quantity) {
+            FifoAllocation::allocate(queue, level_quantity, aggressor, fill);
+            return;
+        }
+
+        Order* top = queue.front();
+        Quantity top_remaining = top->remaining();
+        fill(top, std::min(aggressor->remaining(), top_remaining));
+        auto rest = top->is_open() ? std::next(queue.begin()) : queue.erase(queue.begin());
+
+        if (can_trade(aggressor)) {
+            detail::pro_rata_pass(queue, rest, level_quantity - top_remaining, aggressor, fill);
+        }
+    }
+};
+
+} // namespace trading
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <new>
 
@@ -29,16 +30,52 @@ public:
 
     // Fast allocation - no construction for POD types
     T* allocate() {
+        return at(allocate_slot());
+    }
+
+    // Slot-addressed allocation: slot = block * BlockSize + index.
+    // Released slots are recycled before the bump pointer advances.
+    size_t allocate_slot() {
+        if (!free_slots_.empty()) {
+            size_t slot = free_slots_.back();
+            free_slots_.pop_back();
+            return slot;
+        }
         if (current_index_ >= BlockSize) {
             allocate_block();
         }
-        return &blocks_[current_block_].ptr[current_index_++];
+        return current_block_ * BlockSize + current_index_++;
+    }
+
+    // The slot the next allocate_slot() returns
+    size_t next_slot() const {
+        return free_slots_.empty() ? current_block_ * BlockSize + current_index_ : free_slots_.back();
+    }
+
+    // Return a slot to the pool; bumping its generation invalidates
+    // every handle that still refers to the previous occupant
+    void release(size_t slot) {
+        ++generations_[slot];
+        free_slots_.push_back(slot);
     }
 
+    T* at(size_t slot) { return &blocks_[slot / BlockSize].ptr[slot % BlockSize]; }
+    const T* at(size_t slot) const { return &blocks_[slot / BlockSize].ptr[slot % BlockSize]; }
+
+    // Generations start at 1 so a zero handle never matches a live slot
+    uint32_t generation(size_t slot) const { return generations_[slot]; }
+
+    // Number of addressable slots across all blocks
+    size_t capacity() const { return blocks_.size() * BlockSize; }
+
     // Reset pool for reuse (doesn't free memory)
     void reset() {
         current_block_ = 0;
         current_index_ = 0;
+        free_slots_.clear();
+        for (auto& gen : generations_) {
+            ++gen;
+        }
     }
     
     // Get total allocated memory in bytes
@@ -57,26 +94,34 @@ private:
     };
     
     void allocate_block() {
-        if (current_block_ >= blocks_.size()) {
-            Block block;
-            
-            // Allocate cache-line aligned memory
-            size_t alloc_size = sizeof(T) * BlockSize;
-            size_t aligned_size = (alloc_size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
-            void* raw_ptr = std::aligned_alloc(CACHE_LINE_SIZE, aligned_size);
-            
-            if (!raw_ptr) {
-                throw std::bad_alloc();
-            }
-            
-            block.ptr = static_cast<T*>(raw_ptr);
-            blocks_.push_back(block);
+        // Reuse blocks retained across reset() before growing
+        if (!blocks_.empty() && current_block_ + 1 < blocks_.size()) {
+            ++current_block_;
+            current_index_ = 0;
+            return;
+        }
+        
+        Block block;
+        
+        // Allocate cache-line aligned memory
+        size_t alloc_size = sizeof(T) * BlockSize;
+        size_t aligned_size = (alloc_size + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+        void* raw_ptr = std::aligned_alloc(CACHE_LINE_SIZE, aligned_size);
+        
+        if (!raw_ptr) {
+            throw std::bad_alloc();
         }
+        
+        block.ptr = static_cast<T*>(raw_ptr);
+        blocks_.push_back(block);
+        generations_.resize(blocks_.size() * BlockSize, 1);
         current_block_ = blocks_.size() - 1;
         current_index_ = 0;
     }
 
     std::vector<Block> blocks_;
+    std::vector<uint32_t> generations_;
+    std::vector<size_t> free_slots_;
     size_t current_block_;
     size_t current_index_;
 };
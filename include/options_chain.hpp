@@ -0,0 +1,81 @@
+#pragma once
+
+#include "types.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace trading {
+
+enum class OptionRight : uint8_t { CALL = 0, PUT = 1 };
+
+// European options on one underlying, repriced together on every
+// underlying tick (TickEngine::add_option_chain). Contracts are kept
+// structure-of-arrays: the inputs (strike, expiry, vol, right) and the
+// outputs (value and greeks) are one column each, so an update is a
+// single pass of the dispatched black_scholes_f64 kernel over the chain.
+//
+// Prices and values are in Price units (fixed-point, x10000) as doubles:
+// Black-Scholes is homogeneous in spot and strike, so no conversion is
+// needed. Delta is per unit of underlying, gamma per Price unit, vega per
+// 1.0 (100 vol points) of volatility. Time to expiry is ACT/365.25 from
+// the tick timestamp; expired contracts are priced at a tiny horizon,
+// i.e. at intrinsic value.
+class OptionChain {
+public:
+    explicit OptionChain(SymbolId underlying, double rate = 0.0);
+
+    // Returns the contract's index in the chain's columns
+    size_t add_option(Price strike, Timestamp expiry, OptionRight right, double volatility);
+    void set_volatility(size_t option, double volatility) { vol_[option] = volatility; }
+    void set_rate(double rate) { rate_ = rate; }
+
+    // Reprices every contract; O(chain) with no allocation
+    void update(Price spot, Timestamp now);
+
+    SymbolId underlying() const { return underlying_; }
+    size_t size() const { return strike_.size(); }
+    double rate() const { return rate_; }
+    Price spot() const { return spot_; }
+    Timestamp updated_at() const { return updated_at_; }
+    uint64_t updates() const { return updates_; }
+
+    Price strike(size_t option) const { return static_cast<Price>(strike_[option]); }
+    Timestamp expiry(size_t option) const { return expiry_[option]; }
+    OptionRight right(size_t option) const {
+        return sign_[option] > 0.0 ? OptionRight::CALL : OptionRight::PUT;
+    }
+    double volatility(size_t option) const { return vol_[option]; }
+    double value(size_t option) const { return value_[option]; }
+    double delta(size_t option) const { return delta_[option]; }
+    double gamma(size_t option) const { return gamma_[option]; }
+    double vega(size_t option) const { return vega_[option]; }
+
+    // Whole output columns, size() long, for chain-level aggregation
+    const double* values() const { return value_.data(); }
+    const double* deltas() const { return delta_.data(); }
+    const double* gammas() const { return gamma_.data(); }
+    const double* vegas() const { return vega_.data(); }
+
+private:
+    SymbolId underlying_;
+    double rate_;
+    Price spot_ = 0;
+    Timestamp updated_at_ = 0;
+    uint64_t updates_ = 0;
+
+    // Contract columns
+    std::vector<double> strike_;
+    std::vector<Timestamp> expiry_;
+    std::vector<double> vol_;
+    std::vector<double> sign_;  // +1 call, -1 put
+    // Kernel inputs derived per update
+    std::vector<double> time_;
+    std::vector<double> vol_input_;
+    // Outputs
+    std::vector<double> value_;
+    std::vector<double> delta_;
+    std::vector<double> gamma_;
+    std::vector<double> vega_;
+};
+
+} // namespace trading
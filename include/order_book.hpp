@@ -2,6 +2,10 @@
 
 #include "types.hpp"
 #include "memory_pool.hpp"
+#include "top_of_book.hpp"
+#include "matching_policy.hpp"
+#include "book_features.hpp"
+#include "dirty_symbols.hpp"
 #include <map>
 #include <list>
 #include <functional>
@@ -9,27 +13,110 @@
 
 namespace trading {
 
-class OrderBook {
+enum class TradingPhase : uint8_t {
+    CONTINUOUS = 0,
+    AUCTION = 1     // Orders accumulate without matching until uncross()
+};
+
+struct AuctionResult {
+    Price price = 0;          // Equilibrium price (0 if nothing executes)
+    Quantity volume = 0;      // Executable volume at that price
+    Quantity imbalance = 0;   // Buy minus sell interest at that price
+};
+
+// Price levels with a compile-time level allocation policy (see
+// matching_policy.hpp). Instantiated in order_book.cpp for the policies below.
+template<typename Allocation>
+class BasicOrderBook {
 public:
     using TradeCallback = std::function<void(const Trade&)>;
+    using AllocationPolicy = Allocation;
     
-    OrderBook(const std::string& symbol);
+    BasicOrderBook(const std::string& symbol, SymbolId symbol_id = 0);
     
-    // Core operations
+    // Core operations. STOP / STOP_LIMIT orders wait in a per-side trigger
+    // index and enter the book when the last trade reaches their stop price;
+    // stops elected by the resulting trades cascade within the same call.
     void add_order(Order* order);
-    void cancel_order(OrderId order_id);
+    // Same matching as add_order() for each order in turn, but top-of-book
+    // (slot, listeners, features) is published once for the whole batch
+    void add_orders(Order* const* orders, size_t count);
+    bool cancel_order(Order* order);  // False if the order is not resting here
+    // Size-down at the same price keeps queue priority; anything else is
+    // cancel-replace. new_quantity is the new total (filled included).
+    bool modify_order(Order* order, Price new_price, Quantity new_quantity);
     void process_market_order(Order* order);
+    // Match against the opposite side no further than `limit`, never resting
+    // the remainder (used by linked books to interleave implied liquidity)
+    void sweep(Order* order, Price limit);
+    
+    // Auctions: market orders rank ahead of every limit on their side.
+    // The equilibrium price maximizes executable volume, then minimizes the
+    // imbalance, then follows market pressure, then the reference (last
+    // trade) price. uncross() executes at that price in price-time priority,
+    // cancels unfilled market orders and resumes continuous trading.
+    void start_auction() { phase_ = TradingPhase::AUCTION; }
+    AuctionResult indicative_uncross() const;
+    AuctionResult uncross();
+    TradingPhase phase() const { return phase_; }
     
     // Getters
-    Price best_bid() const { return bids_.empty() ? 0 : bids_.rbegin()->first; }
+    Price best_bid() const { return bids_.empty() ? 0 : bids_.begin()->first; }
     Price best_ask() const { return asks_.empty() ? 0 : asks_.begin()->first; }
-    Quantity bid_volume() const;
-    Quantity ask_volume() const;
+    Quantity best_bid_quantity() const { return bids_.empty() ? 0 : bids_.begin()->second.total_quantity; }
+    Quantity best_ask_quantity() const { return asks_.empty() ? 0 : asks_.begin()->second.total_quantity; }
+    Quantity bid_volume() const { return bid_total_; }
+    Quantity ask_volume() const { return ask_total_; }
+    Price last_trade_price() const { return last_trade_price_; }
+    size_t pending_stops() const { return pending_stops_; }
+    
+    // Quantity at the best level of `side` that one aggressor from
+    // `user_id` is sure to trade there: the whole level without self-trade
+    // prevention; with it, only other users' orders ahead of the user's
+    // first order in the queue (FIFO), or nothing if the user rests at that
+    // level under a pro-rata policy
+    Quantity executable_top(Side side, uint32_t user_id) const;
+    
+    // Copy up to `levels` price levels from the top of one side;
+    // returns the number of levels written
+    size_t depth(Side side, size_t levels, Price* prices, Quantity* quantities) const;
     
     void set_trade_callback(TradeCallback cb) { trade_callback_ = std::move(cb); }
     
+    // Self-trade prevention keyed on Order::user_id (continuous matching)
+    void set_self_trade_prevention(SelfTradePrevention mode) { stp_ = mode; }
+    SelfTradePrevention self_trade_prevention() const { return stp_; }
+    size_t self_trades_prevented() const { return self_trades_prevented_; }
+    
+    // Optional feature block (off by default). Depth covers the best
+    // `depth_levels` levels per side; depletion rates decay with the given
+    // half-life in book time (timestamps of incoming orders).
+    void enable_features(size_t depth_levels = 5, Timestamp depletion_half_life = 1000000000);
+    bool features_enabled() const { return features_enabled_; }
+    const BookFeatures& features() const { return features_; }
+    
+    // Locate resting orders in O(1) on cancel/modify instead of scanning
+    // their level. Covers orders whose handle_slot(id) is below `capacity`
+    // (pool handles, dense agent ids); any other order is still searched.
+    void enable_order_index(size_t capacity) { order_index_.resize(capacity); }
+    
+    // Publish top-of-book into a seqlocked slot after every book change
+    void set_top_of_book_slot(TopOfBookSlot* slot) { top_slot_ = slot; publish_top(); }
+    
+    // Mark symbol_id() in `set` after every book change (the set must have
+    // the id reserved); consumers coalesce changes by draining the set
+    void set_dirty_set(DirtySymbols* set) { dirty_ = set; }
+    
+    // Called once per operation that changes best price or size on either
+    // side; returns an id for remove_top_listener()
+    using TopListener = std::function<void()>;
+    uint32_t add_top_listener(TopListener listener);
+    void remove_top_listener(uint32_t id);
+    
     // Statistics
     size_t total_trades() const { return total_trades_; }
+    const std::string& symbol() const { return symbol_; }
+    SymbolId symbol_id() const { return symbol_id_; }
     
 private:
     struct PriceLevel {
@@ -38,14 +125,101 @@ private:
         Quantity total_quantity = 0;
     };
     
+    // Where a resting order sits in its level's queue
+    struct IndexEntry {
+        Order* order = nullptr;
+        std::list<Order*>::iterator position;
+    };
+    IndexEntry* indexed(Order* order) {
+        uint32_t slot = handle_slot(order->id);
+        return slot < order_index_.size() && order_index_[slot].order == order ? &order_index_[slot] : nullptr;
+    }
+    void forget(Order* order) {
+        if (IndexEntry* entry = indexed(order)) entry->order = nullptr;
+    }
+    
+    using BidLevels = std::map<Price, PriceLevel, std::greater<Price>>;
+    using AskLevels = std::map<Price, PriceLevel>;
+    
+    template<typename Levels>
+    bool remove_from_level(Levels& levels, Order* order);
+    template<typename Levels>
+    void rest_order(Levels& levels, Quantity& side_total, Order* order);
+    template<typename Levels>
+    void match_side(Levels& levels, Quantity& side_total, Order* order);
+    template<typename Stops>
+    bool remove_stop(Stops& stops, Order* order);
+    void prevent_self_trade(Order* aggressor, Order* resting, Quantity& level_total, Quantity& side_total);
+    
+    void enter_order(Order* order);  // add_order() without publishing
+    void place_order(Order* order);  // Match and rest, no stop triggering
+    void trigger_stops();
+    
+    // Takes `volume` from the front of one side at `price`, appending the
+    // orders touched in priority order with the quantity each one trades
+    template<typename Levels>
+    void collect_auction_side(PriceLevel& market, Levels& levels, Price price, Quantity volume,
+                              Quantity& side_total, std::vector<std::pair<Order*, Quantity>>& out);
+    // Marks executed orders and drops fully traded levels
+    template<typename Levels>
+    void settle_auction_side(PriceLevel& market, Levels& levels);
+    
     void match_order(Order* order);
     void execute_trade(Order* buy_order, Order* sell_order, Price price, Quantity qty);
+    void publish_top();
+    
+    // Feature hooks around every level quantity change (no-ops when disabled)
+    template<typename Levels>
+    void level_inserted(Levels& levels, typename Levels::iterator it);
+    template<typename Levels>
+    void level_changed(Levels& levels, typename Levels::iterator it, Quantity delta);
+    template<typename Levels>
+    void level_erasing(Levels& levels, typename Levels::iterator it);
+    void reset_features();
+    void refresh_features();
     
     std::string symbol_;
-    std::map<Price, PriceLevel, std::greater<Price>> bids_;  // Descending
-    std::map<Price, PriceLevel> asks_;                        // Ascending
+    SymbolId symbol_id_;
+    BidLevels bids_;  // Descending
+    AskLevels asks_;  // Ascending
     TradeCallback trade_callback_;
+    TopOfBookSlot* top_slot_ = nullptr;
+    DirtySymbols* dirty_ = nullptr;
+    std::vector<std::pair<uint32_t, TopListener>> top_listeners_;
+    uint32_t next_listener_id_ = 0;
+    TopOfBookSnapshot notified_top_;   // Top as of the last listener call
+    TradingPhase phase_ = TradingPhase::CONTINUOUS;
+    SelfTradePrevention stp_ = SelfTradePrevention::NONE;
+    size_t self_trades_prevented_ = 0;
+    PriceLevel market_bids_;   // Auction market orders, time priority
+    PriceLevel market_asks_;
+    // Stop trigger indexes, nearest-to-trigger first; time priority per price
+    std::map<Price, std::list<Order*>> buy_stops_;                          // Ascending
+    std::map<Price, std::list<Order*>, std::greater<Price>> sell_stops_;    // Descending
+    size_t pending_stops_ = 0;
+    std::vector<IndexEntry> order_index_;  // By handle_slot(id); empty = disabled
+    Quantity bid_total_ = 0;
+    Quantity ask_total_ = 0;
+    Price last_trade_price_ = 0;
+    Quantity last_trade_quantity_ = 0;
+    Timestamp last_update_ = 0;
     size_t total_trades_ = 0;
+    bool features_enabled_ = false;
+    BookFeatures features_;
+    TopLevelsDepth<BidLevels> bid_depth_;
+    TopLevelsDepth<AskLevels> ask_depth_;
+    size_t feature_levels_ = 5;
+    double depletion_tau_ns_ = 0.0;   // EWMA time constant (half-life / ln 2)
+    Timestamp bid_depleted_at_ = 0;   // Time of the last touch removal per side
+    Timestamp ask_depleted_at_ = 0;
 };
 
+extern template class BasicOrderBook<FifoAllocation>;
+extern template class BasicOrderBook<ProRataAllocation>;
+extern template class BasicOrderBook<FifoProRataAllocation>;
+
+using OrderBook = BasicOrderBook<FifoAllocation>;
+using ProRataOrderBook = BasicOrderBook<ProRataAllocation>;
+using FifoProRataOrderBook = BasicOrderBook<FifoProRataAllocation>;
+
 } // namespace trading
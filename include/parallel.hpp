@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+// Fixed pool of worker threads for fork-join loops. parallel_for() hands
+// out indices dynamically (one atomic increment per task), so uneven tasks
+// balance themselves; the calling thread works too and the call returns
+// once every task has finished. Threads park on a condition variable
+// between calls, so one pool can be reused for every bar of a run.
+class WorkerPool {
+public:
+    // Total participants including the caller; 0 means hardware_concurrency
+    explicit WorkerPool(size_t threads = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs task(i) for every i in [0, count). Not reentrant.
+    void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+    size_t size() const { return workers_.size() + 1; }
+
+private:
+    void worker_loop();
+    void run_tasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_{0};
+    size_t busy_ = 0;          // Workers still inside the current job
+    uint64_t generation_ = 0;  // Bumped per job so workers join each one once
+    bool stop_ = false;
+};
+
+} // namespace trading
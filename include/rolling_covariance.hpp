@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace trading {
+
+class WorkerPool;
+
+// Rolling N x N covariance of per-bar return vectors over a sliding window.
+// Each bar is one Welford-style rank-2 update of the centered co-moment
+// matrix (add the new vector, downdate the evicted one) in a single pass,
+// so a bar costs O(N^2) instead of O(N^2 * window) for a recompute.
+//
+// Only the upper triangle is kept, as TILE x TILE row-major tiles packed
+// tile-row by tile-row: every row segment the update touches is one
+// contiguous run for the dispatched rank2_update_f64 kernel, and a tile
+// stays cache resident while it is updated. With a WorkerPool the tile
+// rows are shared out dynamically (they shrink towards the bottom).
+class RollingCovariance {
+public:
+    static constexpr size_t TILE = 64;
+
+    // pool may be null (serial); it must outlive this object
+    RollingCovariance(size_t symbols, size_t window, WorkerPool* pool = nullptr);
+
+    // One bar: returns[0..symbols)
+    void add(const double* returns);
+
+    size_t symbols() const { return n_; }
+    size_t window() const { return window_; }
+    size_t count() const { return count_; }
+    bool full() const { return count_ == window_; }
+
+    double mean(size_t i) const { return mean_[i]; }
+    // Sample statistics over the current window (0 with fewer than 2 bars)
+    double covariance(size_t i, size_t j) const;
+    double correlation(size_t i, size_t j) const;
+
+    // Dense row-major symbols x symbols copies
+    void covariance_matrix(double* out) const;
+    void correlation_matrix(double* out) const;
+
+    // Rebuild moments exactly from the ring (O(N^2 * window)); clears any
+    // rounding drift accumulated over very long runs
+    void recompute();
+
+private:
+    // Tile (ti, tj), ti <= tj; tile row ti starts after sum(tiles - k, k < ti)
+    size_t tile_index(size_t ti, size_t tj) const {
+        return ti * tiles_ - ti * (ti - 1) / 2 + (tj - ti);
+    }
+    double comoment(size_t i, size_t j) const;
+    // moments += a * u u^T + b * v v^T over the stored triangle
+    void rank2_update(double a, const double* u, double b, const double* v);
+
+    size_t n_;
+    size_t padded_;  // n rounded up to TILE; padding lanes stay zero
+    size_t tiles_;
+    size_t window_;
+    size_t count_ = 0;
+    size_t head_ = 0;  // Ring slot of the next bar (oldest bar when full)
+    WorkerPool* pool_;
+    std::vector<double> ring_;     // window x padded returns
+    std::vector<double> mean_;     // padded
+    std::vector<double> moments_;  // Packed upper-triangle tiles
+    std::vector<double> u_;        // Scratch update vectors (padded)
+    std::vector<double> v_;
+};
+
+} // namespace trading
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace trading {
+
+// Sliding-window OLS of y on x with O(1) add/evict. Means and centered
+// cross-moments are updated Welford-style in both directions, which avoids
+// the cancellation of raw sum-of-squares on price-sized inputs. Rounding
+// drift from long add/remove chains is bounded by an exact recompute from
+// the ring every `window` evictions (amortized O(1)).
+class RollingRegression {
+public:
+    explicit RollingRegression(size_t window)
+        : window_(window ? window : 1), xs_(window_), ys_(window_) {}
+
+    void add(double x, double y) {
+        if (count_ == window_) {
+            evict(xs_[head_], ys_[head_]);
+            if (++evictions_ == window_) {
+                xs_[head_] = x;
+                ys_[head_] = y;
+                head_ = (head_ + 1) % window_;
+                recompute();
+                return;
+            }
+        }
+        xs_[head_] = x;
+        ys_[head_] = y;
+        head_ = (head_ + 1) % window_;
+        insert(x, y);
+    }
+
+    void clear() {
+        count_ = head_ = evictions_ = 0;
+        mean_x_ = mean_y_ = sxx_ = syy_ = sxy_ = 0.0;
+    }
+
+    size_t count() const { return count_; }
+    size_t window() const { return window_; }
+    bool full() const { return count_ == window_; }
+
+    double mean_x() const { return mean_x_; }
+    double mean_y() const { return mean_y_; }
+    double variance_x() const { return count_ > 1 ? sxx_ / (count_ - 1) : 0.0; }
+    double variance_y() const { return count_ > 1 ? syy_ / (count_ - 1) : 0.0; }
+    double covariance() const { return count_ > 1 ? sxy_ / (count_ - 1) : 0.0; }
+
+    // y = intercept + slope * x
+    double slope() const { return sxx_ > 0.0 ? sxy_ / sxx_ : 0.0; }
+    double intercept() const { return mean_y_ - slope() * mean_x_; }
+    double correlation() const {
+        double denom = std::sqrt(sxx_ * syy_);
+        return denom > 0.0 ? sxy_ / denom : 0.0;
+    }
+
+    double residual(double x, double y) const { return y - intercept() - slope() * x; }
+    // Standard error of the regression (n - 2 degrees of freedom)
+    double residual_stddev() const {
+        if (count_ < 3 || sxx_ <= 0.0) return 0.0;
+        double sse = syy_ - sxy_ * sxy_ / sxx_;
+        return sse > 0.0 ? std::sqrt(sse / (count_ - 2)) : 0.0;
+    }
+    double zscore(double x, double y) const {
+        double sd = residual_stddev();
+        return sd > 0.0 ? residual(x, y) / sd : 0.0;
+    }
+
+private:
+    void insert(double x, double y) {
+        ++count_;
+        double dx = x - mean_x_;
+        double dy = y - mean_y_;
+        mean_x_ += dx / count_;
+        mean_y_ += dy / count_;
+        sxx_ += dx * (x - mean_x_);
+        syy_ += dy * (y - mean_y_);
+        sxy_ += dx * (y - mean_y_);
+    }
+
+    // Exact inverse of insert(): moments with the sample, minus its term
+    // against the means without it
+    void evict(double x, double y) {
+        if (count_ == 1) {
+            clear();
+            return;
+        }
+        double n = static_cast<double>(--count_);
+        double mean_x = mean_x_ - (x - mean_x_) / n;
+        double mean_y = mean_y_ - (y - mean_y_) / n;
+        sxx_ -= (x - mean_x) * (x - mean_x_);
+        syy_ -= (y - mean_y) * (y - mean_y_);
+        sxy_ -= (x - mean_x) * (y - mean_y_);
+        mean_x_ = mean_x;
+        mean_y_ = mean_y;
+    }
+
+    void recompute() {
+        mean_x_ = mean_y_ = sxx_ = syy_ = sxy_ = 0.0;
+        count_ = 0;
+        evictions_ = 0;
+        for (size_t i = 0; i < window_; ++i) {
+            size_t slot = (head_ + i) % window_;  // Oldest first
+            insert(xs_[slot], ys_[slot]);
+        }
+    }
+
+    size_t window_;
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    size_t head_ = 0;       // Next slot to write (oldest sample when full)
+    size_t count_ = 0;
+    size_t evictions_ = 0;
+    double mean_x_ = 0.0;
+    double mean_y_ = 0.0;
+    double sxx_ = 0.0;
+    double syy_ = 0.0;
+    double sxy_ = 0.0;
+};
+
+// Ornstein-Uhlenbeck half-life from the slope of the regression of
+// spread changes on the lagged spread; infinite when not mean reverting
+inline double mean_reversion_half_life(double slope) {
+    return slope < 0.0 ? -std::log(2.0) / slope : INFINITY;
+}
+
+} // namespace trading
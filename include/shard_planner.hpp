@@ -0,0 +1,51 @@
+#pragma once
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Per-symbol load of a run, indexed by SymbolId
+struct SymbolActivity {
+    uint64_t ticks = 0;
+    uint64_t orders = 0;
+};
+using ActivityProfile = std::vector<SymbolActivity>;
+
+// Relative cost of a tick (strategy callbacks) and of an order (book work)
+struct ShardCostModel {
+    double per_tick = 1.0;
+    double per_order = 2.0;
+
+    double cost(const SymbolActivity& activity) const {
+        return per_tick * static_cast<double>(activity.ticks) + per_order * static_cast<double>(activity.orders);
+    }
+};
+
+struct ShardPlan {
+    std::vector<uint16_t> shard_of;   // SymbolId -> shard, for ParallelConfig::shard_of
+    std::vector<double> load;         // Predicted cost per shard
+    double balance_factor = 1.0;      // Busiest shard over the mean; 1 is perfect
+};
+
+// Tick counts per symbol from the stream itself (registers its symbols).
+// Order counts come from a calibration run (TickEngine::symbol_activity())
+// or from dataset metadata (load_activity_csv).
+ActivityProfile measure_activity(const std::vector<Tick>& ticks);
+
+// "symbol,ticks,orders" per line; a non-numeric first line is a header
+ActivityProfile load_activity_csv(const std::string& path);
+
+// Longest-processing-time-first bin packing: symbols by descending
+// predicted cost, each onto the currently least-loaded shard (ties to the
+// lower shard, so plans are deterministic). Within 4/3 of the optimal
+// makespan; a single symbol heavier than the mean stays the bound.
+ShardPlan plan_shards(const ActivityProfile& activity, size_t shards, const ShardCostModel& model = {});
+
+// Predicted balance of any mapping (e.g. the id % shards default); throws
+// std::logic_error, like the parallel run, if shard_of names a missing shard
+double balance_factor(const ActivityProfile& activity, const std::vector<uint16_t>& shard_of,
+                      size_t shards, const ShardCostModel& model = {});
+
+} // namespace trading
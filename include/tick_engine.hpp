@@ -3,14 +3,46 @@
 #include "types.hpp"
 #include "order_book.hpp"
 #include "memory_pool.hpp"
+#include "book_sampler.hpp"
+#include "top_of_book.hpp"
+#include "live_stats.hpp"
+#include "fingerprint.hpp"
+#include "timer_wheel.hpp"
+#include "implied_book.hpp"
+#include "options_chain.hpp"
+#include "bar_aggregator.hpp"
+#include "shard_planner.hpp"
+#include <array>
 #include <string>
 #include <memory>
 #include <vector>
+#include <optional>
 #include <unordered_map>
 
 namespace trading {
 
 class Strategy;
+class ParallelRun;
+
+// Conservative parallel run (TickEngine::run_backtest(ticks, config)).
+// Each symbol's book is owned by one shard thread. An order or cancel
+// reaches its book order_latency after the strategy sent it, and the
+// book's trade and cancel reports reach every strategy order_latency after
+// they happened, so shards only have to agree on time once per latency
+// window. Results do not depend on the number of shards or the mapping.
+struct ParallelConfig {
+    size_t shards = 1;
+    Timestamp order_latency = 1000;    // Lookahead; must be non-zero
+    std::vector<uint16_t> shard_of;    // SymbolId -> shard (plan_shards()); id % shards past the end
+    // Runtime rebalancing, checked every rebalance_interval of simulated
+    // time (0 = off) at a window boundary: if the busiest shard did more
+    // than rebalance_threshold x the mean work since the last check, up to
+    // max_migrations of its books that hold no orders (nothing to move but
+    // the book) go to the least busy shard, busiest first, within half the gap
+    Timestamp rebalance_interval = 0;
+    double rebalance_threshold = 1.25;
+    size_t max_migrations = 4;
+};
 
 class TickEngine {
 public:
@@ -18,18 +50,108 @@ public:
     
     // Event-driven simulation
     void process_tick(const Tick& tick);
-    void submit_order(const Order& order);
+    // Routes to the book of the tick being processed; only valid inside
+    // on_tick (timers and trades fire with another book current, and the
+    // parallel run throws std::logic_error there)
+    OrderHandle submit_order(const Order& order);
+    // Routes to an explicit symbol (cross-symbol strategies)
+    OrderHandle submit_order(const Order& order, SymbolId symbol);
+    // Good-till-time: cancelled when simulated time reaches expire_at
+    OrderHandle submit_gtt_order(const Order& order, Timestamp expire_at);
     void run_backtest(const std::vector<Tick>& ticks);
+    // Parallel discrete-event run over config.shards threads (see
+    // ParallelConfig). Strategies live on the shard of their lowest
+    // subscribed symbol (shard 0 if they see every tick) and only read the
+    // books of that shard; order handles and Trade ids are the sending
+    // shard's, and a strategy sees other strategies' order ids as 0.
+    // Ticks must be in timestamp order. Throws std::logic_error for state
+    // the parallel path does not model (spreads, option chains, bars,
+    // sampling, live stats, book updates, self-trade prevention, open
+    // orders or timers).
+    void run_backtest(const std::vector<Tick>& ticks, const ParallelConfig& config);
+    
+    // Order tracking by handle (direct pool indexing, no hash lookup).
+    // Engine-assigned order ids equal the handle, so Trade ids resolve too.
+    const Order* find_order(OrderHandle handle) const;
+    std::optional<OrderStatus> order_status(OrderHandle handle) const;
+    bool cancel_order(OrderHandle handle);
+    void release_order(OrderHandle handle);  // Recycle the slot; handle goes stale
+    // Handle the next serial submit, e.g. to recognise its fills before
+    // submit_order returns
+    OrderHandle next_order_handle() const;
+    
+    // Links a spread symbol (front - back) to its legs; orders routed to the
+    // spread symbol then also match implied-in liquidity from the legs, and
+    // orders routed to a leg implied-out liquidity from the spread and the
+    // other leg
+    ImpliedSpread& link_spread(const std::string& spread, const std::string& front,
+                               const std::string& back);
+    
+    // Option chain on an underlying, repriced on each of its ticks before
+    // strategies see the tick (Strategy::on_chain_update)
+    OptionChain& add_option_chain(const std::string& underlying, double rate = 0.0);
+    OptionChain* option_chain(SymbolId underlying) {
+        return underlying < chain_by_id_.size() ? chain_by_id_[underlying] : nullptr;
+    }
+    
+    // Engine-built bars, aggregated once per tick and shared: the strategy
+    // gets Strategy::on_bar(bar, engine) for each bar completed at `spec`,
+    // before on_tick of the tick that completed it. Returns the resolution id.
+    size_t subscribe_bars(Strategy* strategy, const BarSpec& spec);
+    const BarAggregator& bars() const { return bars_; }
+    // Delivers every open (partial) bar, e.g. at the end of a run
+    void flush_bars();
+    
+    // Applies to every book, including ones created later
+    void set_self_trade_prevention(SelfTradePrevention mode);
+    // Feature block in every book (OrderBook::features()), including later ones
+    void enable_book_features(size_t depth_levels = 5, Timestamp depletion_half_life = 1000000000);
+    
+    // Coalesced book notifications: books mark themselves in a SymbolId
+    // bitset on every change, and when simulated time moves on (and at the
+    // end of run_backtest) each changed book's subscribers get one
+    // Strategy::on_book_update(symbol, engine), in SymbolId order. Changes
+    // made from on_book_update are reported with the next batch.
+    void enable_book_updates();
+    // Delivers pending notifications now, e.g. after driving process_tick directly
+    void flush_book_updates();
+    
+    // Seqlocked top-of-book per SymbolId, safe to read from any thread
+    const TopOfBookTable& top_of_book() const { return top_of_book_; }
     
-    // Strategy management
+    // Research sampling of book state across all symbols
+    void enable_sampling(const SamplerConfig& config);
+    BookSampler* sampler() { return sampler_.get(); }
+    
+    // Live monitoring: claims a thread slot in the shared-memory segment,
+    // which is refreshed every LIVE_STATS_INTERVAL ticks (region must outlive engine)
+    static constexpr uint32_t LIVE_STATS_INTERVAL = 4096;
+    void enable_live_stats(LiveStatsRegion& region);
+    
+    // Simulated-time timers, fired at the start of the first tick at or
+    // after the deadline via Strategy::on_timer(tag, engine)
+    TimerId schedule_timer(Timestamp deadline, Strategy* strategy, uint64_t tag = 0);
+    bool cancel_timer(TimerId id) { return timers_.cancel(id); }
+    size_t pending_timers() const { return timers_.size(); }
+    Timestamp now() const { return current_time_; }
+    
+    // Strategy management. Without symbols a strategy sees every tick; with
+    // symbols only ticks (and chain updates) of those, so per-symbol
+    // strategies cost nothing on other symbols' ticks.
     void add_strategy(std::unique_ptr<Strategy> strategy);
+    void add_strategy(std::unique_ptr<Strategy> strategy, const std::vector<std::string>& symbols);
+    // Adds a symbol to a strategy's subscriptions (a no-op for strategies
+    // that see every tick)
+    void subscribe(Strategy* strategy, const std::string& symbol);
     
     // Statistics
     struct Stats {
         uint64_t ticks_processed = 0;
         uint64_t orders_submitted = 0;
         uint64_t trades_executed = 0;
+        uint64_t book_updates = 0;  // Coalesced on_book_update batches (one per dirty book)
         uint64_t total_latency_ns = 0;
+        uint64_t fingerprint = 0;  // RunFingerprint over acks, trades and cancels
         
         double avg_latency_us() const {
             return ticks_processed > 0 ? 
@@ -38,17 +160,101 @@ public:
     };
     
     const Stats& get_stats() const { return stats_; }
+    
+    // Last parallel run: work per shard (strategy callbacks plus book
+    // operations), busiest shard over the mean (1 = perfectly balanced),
+    // windows and books moved by rebalancing
+    struct ParallelStats {
+        std::vector<uint64_t> shard_work;
+        double balance_factor = 0.0;
+        uint64_t windows = 0;
+        uint64_t migrations = 0;
+    };
+    const ParallelStats& parallel_stats() const { return parallel_stats_; }
+    
+    // Ticks and orders per SymbolId so far, e.g. from a calibration run
+    // to feed plan_shards()
+    const ActivityProfile& symbol_activity() const { return activity_; }
     OrderBook* get_order_book(const std::string& symbol);
+    OrderBook* get_order_book(SymbolId symbol) {
+        return symbol < books_by_id_.size() ? books_by_id_[symbol] : nullptr;
+    }
     
 private:
-    void on_trade(const Trade& trade);
+    void on_trade(const Trade& trade, SymbolId symbol);
+    OrderBook* get_or_create_book(const std::string& symbol);
+    OrderHandle route_order(const Order& order, OrderBook* book);
+    // Pool record stamped with its handle and the current time
+    OrderHandle new_order(const Order& order);
+    void enter_order(Order* order, OrderBook* book);
+    OrderBook* book_of(size_t slot) { return books_by_id_[order_symbols_[slot]]; }
+    void publish_live_stats();
+    void fire_timers(Timestamp now);
+    void deliver_bar(const Bar& bar);
+    void rebuild_dispatch();
+    // Strategies to notify for `symbol`, as a [first, last) range
+    std::pair<Strategy* const*, Strategy* const*> subscribers(SymbolId symbol);
+    
+    // Shard side of a parallel run (parallel_backtest.cpp)
+    friend class ParallelRun;
+    OrderHandle parallel_submit(const Order& order, SymbolId symbol);
+    bool parallel_cancel(OrderHandle handle);
+    void parallel_trade(const Trade& trade, SymbolId symbol);
+    
+    struct EngineTimer {
+        Strategy* strategy = nullptr;  // nullptr: GTT expiry of `data`
+        uint64_t data = 0;             // Strategy tag or OrderHandle
+    };
     
     std::unordered_map<std::string, std::unique_ptr<OrderBook>> order_books_;
+    std::vector<OrderBook*> books_by_id_;      // SymbolId -> book
+    std::vector<SymbolId> order_symbols_;      // Pool slot -> SymbolId
+    OrderBook* current_book_ = nullptr;
+    RunFingerprint fingerprint_;
+    TimerWheel<EngineTimer> timers_;
+    std::vector<std::unique_ptr<ImpliedSpread>> spreads_;
+    std::vector<ImpliedSpread*> spread_by_id_;  // SymbolId -> spread, if linked
+    std::vector<std::vector<ImpliedSpread*>> spreads_by_leg_;  // Leg SymbolId -> its spreads
+    std::vector<std::unique_ptr<OptionChain>> chains_;
+    std::vector<OptionChain*> chain_by_id_;     // Underlying SymbolId -> chain
+    BarAggregator bars_;
+    std::vector<std::vector<Strategy*>> bar_subscribers_;  // Resolution -> strategies
+    SelfTradePrevention stp_ = SelfTradePrevention::NONE;
+    size_t feature_levels_ = 0;             // 0: book features off
+    Timestamp feature_half_life_ = 0;
     std::vector<std::unique_ptr<Strategy>> strategies_;
+    // Tick dispatch: strategies that see every tick, plus (symbol, strategy
+    // index) subscriptions, flattened into one run of subscribers per
+    // SymbolId (dispatch_[dispatch_begin_[s], dispatch_begin_[s + 1])),
+    // each in registration order. Symbols past the table only have the
+    // wildcard subscribers.
+    std::vector<uint8_t> sees_all_;                     // Strategy index -> flag
+    std::vector<std::pair<SymbolId, uint32_t>> subscriptions_;
+    std::vector<Strategy*> wildcard_;
+    std::vector<uint32_t> dispatch_begin_;
+    std::vector<Strategy*> dispatch_;
+    bool dispatch_dirty_ = false;
+    DirtySymbols dirty_books_;
+    bool book_updates_ = false;
+    bool flushing_books_ = false;
     MemoryPool<Order> order_pool_;
-    OrderId next_order_id_ = 1;
+    std::unique_ptr<BookSampler> sampler_;
+    TopOfBookTable top_of_book_;
+    LiveThreadStats* live_stats_ = nullptr;
+    std::array<uint64_t, LiveThreadStats::LATENCY_BUCKETS> latency_histogram_{};
+    uint32_t ticks_until_publish_ = LIVE_STATS_INTERVAL;
     Timestamp current_time_ = 0;
     Stats stats_;
+    ActivityProfile activity_;
+    ParallelStats parallel_stats_;
+    // Parallel runs: the shard engines of the last run (kept for their
+    // books), and on a shard the run, its index, the strategy being called
+    // back and the symbol of the tick being dispatched
+    std::vector<std::unique_ptr<TickEngine>> shards_;
+    ParallelRun* parallel_ = nullptr;
+    uint32_t shard_ = 0;
+    Strategy* active_ = nullptr;
+    SymbolId current_symbol_ = 0;
 };
 
 // Strategy interface
@@ -57,6 +263,13 @@ public:
     virtual ~Strategy() = default;
     virtual void on_tick(const Tick& tick, TickEngine* engine) = 0;
     virtual void on_trade(const Trade& trade) = 0;
+    virtual void on_timer(uint64_t /*tag*/, TickEngine* /*engine*/) {}
+    // After a chain was repriced for a tick of its underlying
+    virtual void on_chain_update(const OptionChain& /*chain*/, TickEngine* /*engine*/) {}
+    // The symbol's book changed during the last timestamp (enable_book_updates)
+    virtual void on_book_update(SymbolId /*symbol*/, TickEngine* /*engine*/) {}
+    // A completed bar at a resolution subscribed with TickEngine::subscribe_bars
+    virtual void on_bar(const Bar& /*bar*/, TickEngine* /*engine*/) {}
     virtual const char* name() const = 0;
 };
 
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "types.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <limits>
+#include <vector>
+
+namespace trading {
+
+// Generational timer id: (generation << 32) | node. Zero is never issued.
+using TimerId = uint64_t;
+constexpr TimerId INVALID_TIMER_ID = 0;
+
+// Hierarchical timing wheel over simulated time. Four levels of 256 buckets
+// cover 2^32 resolution units ahead (about 71 minutes at 1 µs); later
+// deadlines park in an overflow list that is re-examined once per 2^32
+// units. Insert and cancel are O(1) (intrusive lists over a node pool);
+// advance() jumps straight to the next occupied bucket using per-level
+// occupancy bitmaps, so idle stretches of simulated time cost nothing.
+//
+// Deadlines round up to the resolution, so a timer never fires early and at
+// most one unit late. Timers fire in deadline order; timers in the same unit
+// fire in a deterministic (insertion/cascade) order.
+template<typename Payload>
+class TimerWheel {
+public:
+    explicit TimerWheel(Timestamp resolution_ns = 1000, Timestamp start = 0)
+        : resolution_(resolution_ns ? resolution_ns : 1), now_tick_(start / resolution_) {
+        heads_.fill(NIL);
+        tails_.fill(NIL);
+    }
+
+    // Deadlines at or before the current time fire on the next advance()
+    TimerId schedule(Timestamp deadline, const Payload& payload) {
+        uint32_t index;
+        if (free_head_ != NIL) {
+            index = free_head_;
+            free_head_ = nodes_[index].next;
+        } else {
+            index = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        }
+
+        Node& node = nodes_[index];
+        node.tick = deadline / resolution_ + (deadline % resolution_ != 0);
+        node.payload = payload;
+        place(index);
+        ++size_;
+        return (static_cast<uint64_t>(node.generation) << 32) | index;
+    }
+
+    // False if the timer already fired or was cancelled
+    bool cancel(TimerId id) {
+        uint32_t index = static_cast<uint32_t>(id);
+        if (index >= nodes_.size()) return false;
+        Node& node = nodes_[index];
+        if (node.generation != static_cast<uint32_t>(id >> 32) || node.bucket == FREE) return false;
+
+        unlink(index);
+        release(index);
+        --size_;
+        return true;
+    }
+
+    // Fire every timer due at or before `now` as on_expire(id, payload).
+    // Callbacks may schedule and cancel timers; new timers that are already
+    // due fire within the same call.
+    template<typename OnExpire>
+    size_t advance(Timestamp now, OnExpire&& on_expire) {
+        uint64_t target = now / resolution_;
+        size_t fired = fire_bucket(DUE, on_expire);
+
+        while (size_ > 0) {
+            uint64_t next = next_event_tick();
+            if (next > target) break;
+            now_tick_ = next;
+
+            // Cascade from the top so timers can fall through several levels
+            if (overflow_pending() && (next & OVERFLOW_MASK) == 0) {
+                cascade(OVERFLOW);
+            }
+            for (int level = LEVELS - 1; level >= 1; --level) {
+                if ((next & ((1ULL << (BITS * level)) - 1)) == 0) {
+                    cascade(bucket_id(level, (next >> (BITS * level)) & SLOT_MASK));
+                }
+            }
+            fired += fire_bucket(bucket_id(0, next & SLOT_MASK), on_expire);
+            fired += fire_bucket(DUE, on_expire);
+        }
+
+        if (target > now_tick_) now_tick_ = target;
+        return fired;
+    }
+
+    size_t size() const { return size_; }
+    Timestamp resolution() const { return resolution_; }
+
+    // Lower bound on the next deadline: exact unless a higher level or the
+    // overflow list has to cascade first. Due timers report the current
+    // unit; max() when no timer is pending.
+    Timestamp next_deadline() const {
+        if (size_ == 0) return std::numeric_limits<Timestamp>::max();
+        if (heads_[DUE] != NIL) return now_tick_ * resolution_;
+        return next_event_tick() * resolution_;
+    }
+
+private:
+    static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+    static constexpr int LEVELS = 4;
+    static constexpr int BITS = 8;
+    static constexpr uint32_t SLOTS = 1u << BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t OVERFLOW_MASK = (1ULL << (BITS * LEVELS)) - 1;
+
+    // Bucket ids: LEVELS * SLOTS wheel buckets, then the due and overflow lists
+    static constexpr uint16_t DUE = LEVELS * SLOTS;
+    static constexpr uint16_t OVERFLOW = DUE + 1;
+    static constexpr uint16_t FREE = OVERFLOW + 1;
+    static constexpr size_t BUCKETS = OVERFLOW + 1;
+
+    struct Node {
+        uint64_t tick = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t generation = 1;
+        uint16_t bucket = FREE;
+        Payload payload{};
+    };
+
+    static uint16_t bucket_id(int level, uint64_t slot) {
+        return static_cast<uint16_t>(level * SLOTS + slot);
+    }
+
+    // Lowest level whose bucket distance fits in one rotation
+    void place(uint32_t index) {
+        uint64_t tick = nodes_[index].tick;
+        if (tick <= now_tick_) {
+            link(index, DUE);
+            return;
+        }
+        for (int level = 0; level < LEVELS; ++level) {
+            int shift = BITS * level;
+            if ((tick >> shift) - (now_tick_ >> shift) < SLOTS) {
+                link(index, bucket_id(level, (tick >> shift) & SLOT_MASK));
+                return;
+            }
+        }
+        link(index, OVERFLOW);
+    }
+
+    void link(uint32_t index, uint16_t bucket) {
+        Node& node = nodes_[index];
+        node.bucket = bucket;
+        node.next = NIL;
+        node.prev = tails_[bucket];
+        if (node.prev != NIL) {
+            nodes_[node.prev].next = index;
+        } else {
+            heads_[bucket] = index;
+            if (bucket < DUE) occupied_[bucket >> 6] |= 1ULL << (bucket & 63);
+        }
+        tails_[bucket] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        uint16_t bucket = node.bucket;
+        if (node.prev != NIL) nodes_[node.prev].next = node.next; else heads_[bucket] = node.next;
+        if (node.next != NIL) nodes_[node.next].prev = node.prev; else tails_[bucket] = node.prev;
+        if (heads_[bucket] == NIL && bucket < DUE) {
+            occupied_[bucket >> 6] &= ~(1ULL << (bucket & 63));
+        }
+    }
+
+    void release(uint32_t index) {
+        Node& node = nodes_[index];
+        node.bucket = FREE;
+        ++node.generation;
+        if (node.generation == 0) node.generation = 1;  // Keep ids non-zero
+        node.next = free_head_;
+        free_head_ = index;
+    }
+
+    // Detach a whole list for cascading (no callbacks run meanwhile)
+    uint32_t detach(uint16_t bucket) {
+        uint32_t head = heads_[bucket];
+        heads_[bucket] = tails_[bucket] = NIL;
+        if (bucket < DUE) occupied_[bucket >> 6] &= ~(1ULL << (bucket & 63));
+        return head;
+    }
+
+    void cascade(uint16_t bucket) {
+        for (uint32_t index = detach(bucket); index != NIL;) {
+            uint32_t next = nodes_[index].next;
+            place(index);
+            index = next;
+        }
+    }
+
+    // Pops one timer at a time so callbacks may cancel timers still queued
+    // in the same bucket, or schedule new ones (due timers join DUE)
+    template<typename OnExpire>
+    size_t fire_bucket(uint16_t bucket, OnExpire& on_expire) {
+        size_t fired = 0;
+        for (uint32_t index; (index = heads_[bucket]) != NIL; ++fired) {
+            unlink(index);
+            Node& node = nodes_[index];
+            TimerId id = (static_cast<uint64_t>(node.generation) << 32) | index;
+            Payload payload = node.payload;
+            release(index);
+            --size_;
+            on_expire(id, payload);
+        }
+        return fired;
+    }
+
+    bool overflow_pending() const { return heads_[OVERFLOW] != NIL; }
+
+    // Distance in [1, 255] from slot `cur` to the next occupied slot of a
+    // level, wrapping around; 0 if the level is empty
+    unsigned next_occupied(int level, unsigned cur) const {
+        const uint64_t* bits = &occupied_[level * (SLOTS / 64)];
+        unsigned start = (cur + 1) & SLOT_MASK;
+        unsigned word = start >> 6;
+        uint64_t w = bits[word] & (~0ULL << (start & 63));
+        for (unsigned i = 0; i <= SLOTS / 64; ++i) {
+            if (w) {
+                unsigned slot = (word << 6) + std::countr_zero(w);
+                return (slot - cur) & SLOT_MASK;
+            }
+            word = (word + 1) & (SLOTS / 64 - 1);
+            w = bits[word];
+        }
+        return 0;
+    }
+
+    // Earliest tick at which a bucket fires (level 0) or cascades (level > 0)
+    uint64_t next_event_tick() const {
+        uint64_t best = std::numeric_limits<uint64_t>::max();
+        for (int level = 0; level < LEVELS; ++level) {
+            int shift = BITS * level;
+            uint64_t cur = now_tick_ >> shift;
+            unsigned distance = next_occupied(level, static_cast<unsigned>(cur & SLOT_MASK));
+            if (distance) {
+                best = std::min(best, (cur + distance) << shift);
+            }
+        }
+        if (overflow_pending()) {
+            best = std::min(best, ((now_tick_ >> (BITS * LEVELS)) + 1) << (BITS * LEVELS));
+        }
+        return best;
+    }
+
+    Timestamp resolution_;
+    uint64_t now_tick_;
+    std::vector<Node> nodes_;
+    std::array<uint32_t, BUCKETS> heads_;
+    std::array<uint32_t, BUCKETS> tails_;
+    std::array<uint64_t, LEVELS * SLOTS / 64> occupied_{};
+    uint32_t free_head_ = NIL;
+    size_t size_ = 0;
+};
+
+} // namespace trading
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <memory>
+
+namespace trading {
+
+struct TopOfBookSnapshot {
+    Price bid = 0;
+    Price ask = 0;
+    Quantity bid_quantity = 0;
+    Quantity ask_quantity = 0;
+    Price last_price = 0;
+    Quantity last_quantity = 0;
+    Quantity bid_total = 0;
+    Quantity ask_total = 0;
+    Timestamp timestamp = 0;
+};
+
+// Single-writer seqlock slot. The owning book thread publishes; any thread
+// may read without blocking the writer. An odd sequence marks a write in
+// progress; readers retry until they observe the same even sequence on
+// both sides of their copy. Fields are relaxed atomics so the copy is
+// race-free under the C++ memory model and compiles to plain moves.
+class alignas(64) TopOfBookSlot {
+public:
+    void publish(const TopOfBookSnapshot& snap) {
+        uint64_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        store(bid_, snap.bid);
+        store(ask_, snap.ask);
+        store(bid_quantity_, snap.bid_quantity);
+        store(ask_quantity_, snap.ask_quantity);
+        store(last_price_, snap.last_price);
+        store(last_quantity_, snap.last_quantity);
+        store(bid_total_, snap.bid_total);
+        store(ask_total_, snap.ask_total);
+        timestamp_.store(snap.timestamp, std::memory_order_relaxed);
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    TopOfBookSnapshot read() const {
+        TopOfBookSnapshot snap;
+        uint64_t before, after;
+        do {
+            before = seq_.load(std::memory_order_acquire);
+            snap.bid = load(bid_);
+            snap.ask = load(ask_);
+            snap.bid_quantity = load(bid_quantity_);
+            snap.ask_quantity = load(ask_quantity_);
+            snap.last_price = load(last_price_);
+            snap.last_quantity = load(last_quantity_);
+            snap.bid_total = load(bid_total_);
+            snap.ask_total = load(ask_total_);
+            snap.timestamp = timestamp_.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq_.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return snap;
+    }
+
+    // Number of completed publishes
+    uint64_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static void store(std::atomic<int64_t>& field, int64_t value) {
+        field.store(value, std::memory_order_relaxed);
+    }
+    static int64_t load(const std::atomic<int64_t>& field) {
+        return field.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<int64_t> bid_{0};
+    std::atomic<int64_t> ask_{0};
+    std::atomic<int64_t> bid_quantity_{0};
+    std::atomic<int64_t> ask_quantity_{0};
+    std::atomic<int64_t> last_price_{0};
+    std::atomic<int64_t> last_quantity_{0};
+    std::atomic<int64_t> bid_total_{0};
+    std::atomic<int64_t> ask_total_{0};
+    std::atomic<uint64_t> timestamp_{0};
+};
+
+static_assert(sizeof(TopOfBookSlot) % 64 == 0, "Slots must not share cache lines");
+
+// SymbolId-indexed array of slots, fixed at construction so readers can
+// hold slot pointers for the lifetime of the table
+class TopOfBookTable {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    explicit TopOfBookTable(size_t capacity = DEFAULT_CAPACITY)
+        : slots_(new TopOfBookSlot[capacity]), capacity_(capacity) {}
+
+    TopOfBookSlot* slot(SymbolId id) { return id < capacity_ ? &slots_[id] : nullptr; }
+    const TopOfBookSlot* slot(SymbolId id) const { return id < capacity_ ? &slots_[id] : nullptr; }
+    // Ids past the table read as an empty snapshot, as slot() returns null
+    TopOfBookSnapshot read(SymbolId id) const { return id < capacity_ ? slots_[id].read() : TopOfBookSnapshot{}; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    std::unique_ptr<TopOfBookSlot[]> slots_;
+    size_t capacity_;
+};
+
+} // namespace trading
@@ -15,6 +15,17 @@ using OrderId = uint64_t;
 using Timestamp = uint64_t; // Nanoseconds since epoch
 using SymbolId = uint16_t;  // Symbol index for fast lookup
 
+// Generational order handle: low 32 bits = pool slot, high 32 bits = generation.
+// A handle goes stale once its slot is recycled, which is detected in O(1).
+using OrderHandle = uint64_t;
+constexpr OrderHandle INVALID_ORDER_HANDLE = 0;
+
+constexpr OrderHandle make_order_handle(uint32_t slot, uint32_t generation) {
+    return (static_cast<uint64_t>(generation) << 32) | slot;
+}
+constexpr uint32_t handle_slot(OrderHandle handle) { return static_cast<uint32_t>(handle); }
+constexpr uint32_t handle_generation(OrderHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+
 enum class Side : uint8_t {
     BUY = 0,
     SELL = 1
@@ -22,7 +33,9 @@ enum class Side : uint8_t {
 
 enum class OrderType : uint8_t {
     MARKET = 0,
-    LIMIT = 1
+    LIMIT = 1,
+    STOP = 2,       // Becomes MARKET when the last trade reaches stop_price
+    STOP_LIMIT = 3  // Becomes LIMIT at price when the last trade reaches stop_price
 };
 
 enum class OrderStatus : uint8_t {
@@ -32,6 +45,16 @@ enum class OrderStatus : uint8_t {
     CANCELLED = 3
 };
 
+// What to do when an aggressor would trade against a resting order with
+// the same user_id
+enum class SelfTradePrevention : uint8_t {
+    NONE = 0,           // Allow the trade
+    CANCEL_NEWEST = 1,  // Cancel the aggressor's open quantity
+    CANCEL_OLDEST = 2,  // Cancel the resting order and keep matching
+    CANCEL_BOTH = 3,
+    DECREMENT = 4       // Reduce both by the smaller open quantity, no trade
+};
+
 // Cache-aligned structures for performance
 struct alignas(64) Order {
     OrderId id;
@@ -44,6 +67,7 @@ struct alignas(64) Order {
     OrderType type;
     OrderStatus status;
     uint32_t user_id;
+    Price stop_price = 0;  // Trigger for STOP / STOP_LIMIT (fills the cache line)
     
     Order() = default;
     Order(OrderId id_, Price price_, Quantity qty_, Timestamp ts_, 
@@ -54,6 +78,8 @@ struct alignas(64) Order {
     
     // Helper methods
     Quantity remaining() const { return quantity - filled; }
+    bool is_stop() const { return type == OrderType::STOP || type == OrderType::STOP_LIMIT; }
+    bool is_open() const { return status == OrderStatus::PENDING || status == OrderStatus::PARTIAL; }
     double fill_ratio() const { 
         return initial_quantity > 0 ? 
                static_cast<double>(filled) / initial_quantity : 0.0; 
@@ -101,6 +127,8 @@ public:
         return symbols_[id];
     }
     
+    size_t size() const { return symbols_.size(); }
+    
 private:
     std::vector<std::string> symbols_;
     std::unordered_map<std::string, SymbolId> symbol_to_id_;
@@ -0,0 +1,43 @@
+#include "bar_aggregator.hpp"
+
+namespace trading {
+
+size_t BarAggregator::add_resolution(const BarSpec& spec) {
+    for (size_t id = 0; id < specs_.size(); ++id) {
+        if (specs_[id] == spec) return id;
+    }
+
+    // Re-layout the dense rows with one more column
+    const size_t old_n = specs_.size();
+    specs_.push_back(spec);
+    const size_t n = specs_.size();
+    std::vector<Bar> bars(symbols_ * n);
+    for (size_t s = 0; s < symbols_; ++s) {
+        for (size_t r = 0; r < old_n; ++r) bars[s * n + r] = bars_[s * old_n + r];
+        bars[s * n + old_n].symbol = static_cast<SymbolId>(s);
+        bars[s * n + old_n].resolution = static_cast<uint16_t>(old_n);
+    }
+    bars_ = std::move(bars);
+    return old_n;
+}
+
+const Bar* BarAggregator::open_bar(SymbolId symbol, size_t resolution) const {
+    if (symbol >= symbols_ || resolution >= specs_.size()) return nullptr;
+    const Bar& bar = bars_[static_cast<size_t>(symbol) * specs_.size() + resolution];
+    return bar.ticks > 0 ? &bar : nullptr;
+}
+
+void BarAggregator::grow(SymbolId symbol) {
+    const size_t n = specs_.size();
+    const size_t symbols = static_cast<size_t>(symbol) + 1;
+    bars_.resize(symbols * n);
+    for (size_t s = symbols_; s < symbols; ++s) {
+        for (size_t r = 0; r < n; ++r) {
+            bars_[s * n + r].symbol = static_cast<SymbolId>(s);
+            bars_[s * n + r].resolution = static_cast<uint16_t>(r);
+        }
+    }
+    symbols_ = symbols;
+}
+
+} // namespace trading
@@ -1,8 +1,19 @@
 #include "tick_engine.hpp"
 #include "order_book.hpp"
+#include "cpu_dispatch.hpp"
+#include "parallel.hpp"
+#include "rolling_covariance.hpp"
+#include "agent_sim.hpp"
+#include "l3_replay.hpp"
+#include "options_chain.hpp"
+#include "bar_aggregator.hpp"
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
 
 using namespace trading;
@@ -48,6 +59,47 @@ void benchmark_order_book() {
     std::cout << "Trades executed: " << book.total_trades() << "\n\n";
 }
 
+void benchmark_auction_uncross() {
+    std::cout << "=== Closing Auction Benchmark ===\n";
+    
+    OrderBook book("TEST");
+    std::vector<Order> orders;
+    orders.reserve(100000);
+    
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<Price> price_dist(990000, 1010000);
+    std::uniform_int_distribution<Quantity> qty_dist(1, 100);
+    std::bernoulli_distribution side_dist(0.5);
+    
+    for (size_t i = 0; i < 100000; ++i) {
+        bool market = i % 50 == 0;
+        orders.emplace_back(i, market ? 0 : price_dist(rng), qty_dist(rng), i * 1000,
+                            side_dist(rng) ? Side::BUY : Side::SELL,
+                            market ? OrderType::MARKET : OrderType::LIMIT, 1);
+    }
+    
+    book.start_auction();
+    for (auto& order : orders) {
+        book.add_order(&order);
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    AuctionResult indicative = book.indicative_uncross();
+    auto mid = std::chrono::high_resolution_clock::now();
+    AuctionResult result = book.uncross();
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto price_us = std::chrono::duration_cast<std::chrono::microseconds>(mid - start);
+    auto uncross_us = std::chrono::duration_cast<std::chrono::microseconds>(end - mid);
+    
+    std::cout << "Orders in book: 100,000\n";
+    std::cout << "Equilibrium price: " << indicative.price / 10000.0 << " (volume "
+              << result.volume << ", imbalance " << result.imbalance << ")\n";
+    std::cout << "Indicative price: " << price_us.count() << " µs\n";
+    std::cout << "Uncross (price + allocation): " << uncross_us.count() << " µs\n";
+    std::cout << "Trades executed: " << book.total_trades() << "\n\n";
+}
+
 void benchmark_memory_pool() {
     std::cout << "=== Memory Pool Benchmark ===\n";
     
@@ -98,12 +150,456 @@ void benchmark_tick_processing() {
     std::cout << "Avg latency: " << engine.get_stats().avg_latency_us() << " µs/tick\n\n";
 }
 
+void benchmark_kernels() {
+    std::cout << "=== SIMD Kernel Dispatch ===\n";
+    std::cout << "Detected CPU level: " << cpu_level_name(detect_cpu_level()) << "\n";
+    std::cout << "Selected kernels: " << kernels().name << "\n";
+    
+    constexpr size_t n = 1 << 20;
+    constexpr int reps = 200;
+    std::vector<int64_t> values(n, 3);
+    std::vector<int64_t> prefix(n);
+    
+    for (int l = 0; l <= static_cast<int>(CpuLevel::AVX512); ++l) {
+        CpuLevel level = static_cast<CpuLevel>(l);
+        if (!cpu_level_supported(level)) continue;
+        const KernelTable& k = kernel_table(level);
+        
+        int64_t sink = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            values[r] = r;  // Defeat hoisting across repetitions
+            sink += k.sum_i64(values.data(), n);
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            k.prefix_sum_i64(values.data(), prefix.data(), n);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double sum_ns = std::chrono::duration<double, std::nano>(mid - start).count() / (reps * double(n));
+        double scan_ns = std::chrono::duration<double, std::nano>(end - mid).count() / (reps * double(n));
+        std::cout << "  " << k.name << ": sum " << sum_ns << " ns/elem, prefix-sum "
+                  << scan_ns << " ns/elem" << (sink == 42 ? " " : "") << "\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmark_rolling_covariance() {
+    std::cout << "=== Rolling Covariance Benchmark ===\n";
+    
+    constexpr size_t symbols = 3000;
+    constexpr size_t window = 60;
+    constexpr int bars = 100;
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> ret(0.0, 0.01);
+    std::vector<double> returns(symbols * (window + bars));
+    for (auto& r : returns) r = ret(rng);
+    
+    WorkerPool pool;
+    for (WorkerPool* p : {static_cast<WorkerPool*>(nullptr), &pool}) {
+        RollingCovariance cov(symbols, window, p);
+        for (size_t b = 0; b < window; ++b) cov.add(&returns[b * symbols]);
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int b = 0; b < bars; ++b) cov.add(&returns[(window + b) * symbols]);
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double per_bar_ms = std::chrono::duration<double, std::milli>(end - start).count() / bars;
+        std::cout << symbols << " symbols, window " << window << ", "
+                  << (p ? p->size() : 1) << " thread(s): " << per_bar_ms << " ms/bar\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmark_agent_simulation() {
+    std::cout << "=== Agent Simulation Benchmark ===\n";
+    
+    AgentSimConfig config;
+    config.noise_agents = 1000000;
+    config.market_makers = 10000;
+    config.momentum_agents = 100000;
+    config.threads = 0;
+    AgentSimulator sim(config);
+    sim.run(10);  // Warm up the book
+    
+    constexpr int steps = 100;
+    auto start = std::chrono::high_resolution_clock::now();
+    sim.run(steps);
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    double per_step_ms = std::chrono::duration<double, std::milli>(end - start).count() / steps;
+    double agent_steps = static_cast<double>(sim.agents()) * steps;
+    std::cout << sim.agents() << " agents: " << per_step_ms << " ms/step, "
+              << agent_steps / (per_step_ms * steps / 1000.0) / 1e6 << "M agent-steps/sec, "
+              << sim.stats().trades << " trades\n\n";
+}
+
+void benchmark_l3_replay() {
+    std::cout << "=== L3 Replay Benchmark ===\n";
+    
+    BookOpGenerator::Config config;
+    config.target_window = 20000;
+    std::vector<L3Message> feed = record_l3_feed(config, 2000000);
+    
+    for (bool inject : {false, true}) {
+        L3Replay replay("L3");
+        std::vector<OrderHandle> working;
+        uint64_t seed = 1;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < feed.size(); ++i) {
+            replay.apply(feed[i]);
+            if (inject && i % 50 == 0) {
+                // One strategy order per 50 messages, kept for ~10 orders
+                seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+                Side side = (seed >> 63) ? Side::BUY : Side::SELL;
+                Price px = 1000000 + static_cast<Price>((seed >> 40) % 40) * 100 - 2000;
+                working.push_back(replay.submit_order(Order(0, px, 50, 0, side, OrderType::LIMIT, 9)));
+                if (working.size() > 10) {
+                    replay.release_order(working.front());
+                    working.erase(working.begin());
+                }
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << (inject ? "With strategy orders: " : "Pure replay:          ")
+                  << feed.size() / seconds / 1e6 << "M messages/sec";
+        if (inject) std::cout << ", " << replay.stats().ghost_created << " ghost quantity created";
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+void benchmark_option_chain() {
+    std::cout << "=== Option Chain Benchmark ===\n";
+    
+    // 20 monthly expiries x 50 strikes x call/put
+    constexpr Timestamp month = 30ULL * 86400 * 1000000000;
+    OptionChain chain(0, 0.03);
+    for (int e = 1; e <= 20; ++e) {
+        for (int k = 0; k < 50; ++k) {
+            Price strike = 750000 + k * 10000;
+            double vol = 0.15 + 0.002 * std::abs(k - 25);
+            chain.add_option(strike, e * month, OptionRight::CALL, vol);
+            chain.add_option(strike, e * month, OptionRight::PUT, vol);
+        }
+    }
+    
+    constexpr int updates = 20000;
+    double sink = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < updates; ++i) {
+        chain.update(1000000 + (i % 200) * 100, static_cast<Timestamp>(i) * 1000000);
+        sink += chain.values()[i % chain.size()];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    double per_update_us = std::chrono::duration<double, std::micro>(end - start).count() / updates;
+    std::cout << chain.size() << " options (" << kernels().name << "): " << per_update_us
+              << " us/update, " << chain.size() / per_update_us << "M options/sec"
+              << (sink == 0.0 ? " " : "") << "\n\n";
+}
+
+void benchmark_bar_aggregation() {
+    std::cout << "=== Bar Aggregation Benchmark ===\n";
+    
+    // 1000 symbols, four resolutions each, built in one pass
+    BarAggregator bars;
+    bars.add_resolution(BarSpec::time(60000000000ULL));
+    bars.add_resolution(BarSpec::volume(100000));
+    bars.add_resolution(BarSpec::dollar(1000000.0));
+    bars.add_resolution(BarSpec::ticks(500));
+    
+    constexpr size_t tick_count = 10000000;
+    constexpr size_t symbols = 1000;
+    std::mt19937_64 rng(42);
+    std::vector<SymbolId> ids(tick_count);
+    std::vector<Tick> ticks(tick_count);
+    for (size_t i = 0; i < tick_count; ++i) {
+        ids[i] = static_cast<SymbolId>(rng() % symbols);
+        ticks[i].price = 1000000 + static_cast<Price>(rng() % 1000);
+        ticks[i].volume = 100;
+        ticks[i].timestamp = i * 1000;
+    }
+    
+    uint64_t emitted = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < tick_count; ++i) {
+        bars.add(ids[i], ticks[i], [&emitted](const Bar&) { ++emitted; });
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / tick_count;
+    std::cout << symbols << " symbols x " << bars.resolutions() << " resolutions: " << ns
+              << " ns/tick, " << emitted << " bars\n\n";
+}
+
+// Single-symbol strategy that filters ticks itself, as broadcast requires
+class SymbolFilterStrategy : public Strategy {
+public:
+    explicit SymbolFilterStrategy(std::string symbol) : symbol_(std::move(symbol)) {}
+    void on_tick(const Tick& tick, TickEngine*) override {
+        if (tick.symbol == symbol_) last_ = tick.price;
+    }
+    void on_trade(const Trade&) override {}
+    const char* name() const override { return "SymbolFilter"; }
+    
+private:
+    std::string symbol_;
+    Price last_ = 0;
+};
+
+void benchmark_subscriptions() {
+    std::cout << "=== Strategy Subscription Benchmark ===\n";
+    
+    // 100 single-symbol strategies, ticks spread over 5000 symbols
+    constexpr size_t symbols = 5000;
+    constexpr size_t strategies = 100;
+    constexpr size_t tick_count = 2000000;
+    std::vector<Tick> ticks(tick_count);
+    for (size_t i = 0; i < tick_count; ++i) {
+        ticks[i] = Tick{"SYM" + std::to_string(i * 7919 % symbols), 1000000, 100, i * 1000, Side::BUY};
+    }
+    
+    for (bool subscribed : {false, true}) {
+        TickEngine engine;
+        for (size_t s = 0; s < strategies; ++s) {
+            std::string symbol = "SYM" + std::to_string(s * (symbols / strategies));
+            auto strategy = std::make_unique<SymbolFilterStrategy>(symbol);
+            if (subscribed) {
+                engine.add_strategy(std::move(strategy), {symbol});
+            } else {
+                engine.add_strategy(std::move(strategy));
+            }
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        engine.run_backtest(ticks);
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / tick_count;
+        std::cout << (subscribed ? "Subscribed: " : "Broadcast:  ") << ns << " ns/tick\n";
+    }
+    std::cout << "\n";
+}
+
+// Index arbitrage over one index and its components: every tick re-marks
+// the basket, and a basket far enough from the index trades both legs
+class IndexArbStrategy : public Strategy {
+public:
+    IndexArbStrategy(const std::vector<std::string>& members, uint32_t user) : user_(user) {
+        for (const auto& symbol : members) {
+            ids_.push_back(SymbolRegistry::instance().register_symbol(symbol));
+        }
+        marks_.assign(ids_.size(), 0);
+    }
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        size_t member = std::find(ids_.begin(), ids_.end(), engine_symbol(tick)) - ids_.begin();
+        marks_[member] = tick.price;
+        double basket = 0.0;
+        for (size_t i = 1; i < marks_.size(); ++i) {
+            basket += marks_[i] * (1.0 + 0.01 * static_cast<double>(i % 7));
+        }
+        double spread = basket / static_cast<double>(marks_.size() - 1) / 1.03 - static_cast<double>(marks_[0]);
+        if (marks_[0] == 0 || std::abs(spread) < 800.0) return;
+        
+        // Rich basket: sell a component, buy the index (and the reverse),
+        // crossing the quotes by up to 500
+        Side side = spread > 0 ? Side::SELL : Side::BUY;
+        Price cross = side == Side::BUY ? 500 : -500;
+        size_t leg = 1 + (++signals_ % (ids_.size() - 1));
+        for (OrderHandle handle : working_) engine->release_order(handle);
+        working_.clear();
+        working_.push_back(engine->submit_order(Order(0, marks_[leg] + cross, 100, 0, side, OrderType::LIMIT, user_),
+                                                ids_[leg]));
+        working_.push_back(engine->submit_order(Order(0, marks_[0] - cross, 100, 0,
+                                                      side == Side::BUY ? Side::SELL : Side::BUY,
+                                                      OrderType::LIMIT, user_), ids_[0]));
+    }
+    void on_trade(const Trade& trade) override {
+        if (trade.buy_order_id || trade.sell_order_id) ++fills;
+    }
+    const char* name() const override { return "IndexArb"; }
+    
+    size_t fills = 0;
+    
+private:
+    SymbolId engine_symbol(const Tick& tick) {
+        if (tick.symbol == last_name_) return last_id_;
+        last_name_ = tick.symbol;
+        return last_id_ = SymbolRegistry::instance().register_symbol(tick.symbol);
+    }
+    
+    uint32_t user_;
+    std::vector<SymbolId> ids_;  // Index first
+    std::vector<Price> marks_;
+    std::vector<OrderHandle> working_;
+    size_t signals_ = 0;
+    std::string last_name_;
+    SymbolId last_id_ = 0;
+};
+
+// Two-sided quotes 200 either side of each tick of its symbols
+class QuoteStrategy : public Strategy {
+public:
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        if (bid_) engine->release_order(bid_);
+        if (ask_) engine->release_order(ask_);
+        bid_ = engine->submit_order(Order(0, tick.price - 200, 300, 0, Side::BUY, OrderType::LIMIT, 99));
+        ask_ = engine->submit_order(Order(0, tick.price + 200, 300, 0, Side::SELL, OrderType::LIMIT, 99));
+    }
+    void on_trade(const Trade&) override {}
+    const char* name() const override { return "Quote"; }
+    
+private:
+    OrderHandle bid_ = 0;
+    OrderHandle ask_ = 0;
+};
+
+void benchmark_parallel_backtest() {
+    std::cout << "=== Parallel Backtest Benchmark ===\n";
+    
+    // 8 indexes of 15 components, one arb strategy each
+    constexpr size_t indexes = 8;
+    constexpr size_t components = 15;
+    constexpr size_t tick_count = 1000000;
+    std::vector<std::vector<std::string>> groups(indexes);
+    for (size_t g = 0; g < indexes; ++g) {
+        groups[g].push_back("IDX" + std::to_string(g));
+        for (size_t c = 0; c < components; ++c) {
+            groups[g].push_back("CMP" + std::to_string(g) + "_" + std::to_string(c));
+        }
+    }
+    std::mt19937_64 rng(5);
+    std::vector<Tick> ticks(tick_count);
+    for (size_t i = 0; i < tick_count; ++i) {
+        const auto& group = groups[rng() % indexes];
+        ticks[i] = Tick{group[rng() % group.size()], 1000000 + static_cast<Price>(rng() % 2000) - 1000,
+                        100, i * 200, Side::BUY};
+    }
+    
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+    for (size_t shards : {1, 2, 4, 8}) {
+        TickEngine engine;
+        for (size_t g = 0; g < indexes; ++g) {
+            engine.add_strategy(std::make_unique<IndexArbStrategy>(groups[g], static_cast<uint32_t>(g + 1)), groups[g]);
+            for (const auto& symbol : groups[g]) {
+                engine.add_strategy(std::make_unique<QuoteStrategy>(), {symbol});
+            }
+        }
+        // Whole groups per shard, so only trade reports cross shards
+        ParallelConfig config{shards, 5000, {}};
+        for (size_t g = 0; g < indexes; ++g) {
+            for (const auto& symbol : groups[g]) {
+                SymbolId id = SymbolRegistry::instance().register_symbol(symbol);
+                if (id >= config.shard_of.size()) config.shard_of.resize(id + 1, 0);
+                config.shard_of[id] = static_cast<uint16_t>(g % shards);
+            }
+        }
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        engine.run_backtest(ticks, config);
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        const auto& stats = engine.get_stats();
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << shards << " shard(s): " << ms << " ms, " << stats.orders_submitted << " orders, "
+                  << stats.trades_executed << " trades, fingerprint " << std::hex << stats.fingerprint
+                  << std::dec << "\n";
+    }
+    std::cout << "\n";
+}
+
+// Rests a far-from-market bid and cancels it in the same callback: book
+// work on every tick, no fills, and the book is empty between ticks
+class ProbeStrategy : public Strategy {
+public:
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        engine->release_order(engine->submit_order(
+            Order(0, tick.price - 10000, 100, 0, Side::BUY, OrderType::LIMIT, 98)));
+    }
+    void on_trade(const Trade&) override {}
+    const char* name() const override { return "Probe"; }
+};
+
+void benchmark_shard_planning() {
+    std::cout << "=== Shard Planning Benchmark ===\n";
+    
+    // 64 symbols with Zipf-like activity: the top few carry most ticks
+    constexpr size_t symbol_count = 64;
+    constexpr size_t tick_count = 1000000;
+    constexpr size_t shards = 4;
+    std::vector<std::string> symbols;
+    std::vector<double> cumulative;
+    double total = 0.0;
+    for (size_t i = 0; i < symbol_count; ++i) {
+        symbols.push_back("ZIPF" + std::to_string(i));
+        total += 1.0 / static_cast<double>(i + 1);
+        cumulative.push_back(total);
+    }
+    std::mt19937_64 rng(6);
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    std::vector<Tick> ticks(tick_count);
+    for (size_t i = 0; i < tick_count; ++i) {
+        size_t s = std::min<size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), uniform(rng)) -
+                                        cumulative.begin(), symbol_count - 1);
+        ticks[i] = Tick{symbols[s], 1000000 + static_cast<Price>(rng() % 200) * 100, 100, i * 200, Side::BUY};
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    ActivityProfile activity = measure_activity(ticks);
+    ShardPlan plan = plan_shards(activity, shards);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "Pre-pass and LPT plan: " << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms\n";
+    
+    struct Variant {
+        const char* name;
+        std::vector<uint16_t> shard_of;
+        Timestamp rebalance_interval;
+    };
+    std::vector<Variant> variants = {{"id % shards", {}, 0},
+                                     {"LPT plan", plan.shard_of, 0},
+                                     {"id % shards, rebalanced", {}, 2000000}};
+    for (const Variant& variant : variants) {
+        TickEngine engine;
+        for (const auto& symbol : symbols) {
+            engine.add_strategy(std::make_unique<ProbeStrategy>(), {symbol});
+        }
+        ParallelConfig config{shards, 5000, variant.shard_of};
+        config.rebalance_interval = variant.rebalance_interval;
+        config.rebalance_threshold = 1.1;
+        
+        start = std::chrono::high_resolution_clock::now();
+        engine.run_backtest(ticks, config);
+        end = std::chrono::high_resolution_clock::now();
+        
+        const auto& parallel = engine.parallel_stats();
+        std::cout << variant.name << ": " << std::chrono::duration<double, std::milli>(end - start).count()
+                  << " ms, predicted balance " << balance_factor(activity, variant.shard_of, shards)
+                  << ", measured " << parallel.balance_factor << ", " << parallel.migrations
+                  << " migrations, fingerprint " << std::hex << engine.get_stats().fingerprint << std::dec << "\n";
+    }
+    std::cout << "\n";
+}
+
 int main() {
     std::cout << "=== Trading Engine Performance Benchmarks ===\n\n";
     
+    benchmark_kernels();
     benchmark_memory_pool();
     benchmark_order_book();
+    benchmark_auction_uncross();
     benchmark_tick_processing();
+    benchmark_rolling_covariance();
+    benchmark_agent_simulation();
+    benchmark_l3_replay();
+    benchmark_option_chain();
+    benchmark_bar_aggregation();
+    benchmark_subscriptions();
+    benchmark_parallel_backtest();
+    benchmark_shard_planning();
     
     return 0;
 }
@@ -0,0 +1,212 @@
+#include "book_sampler.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace trading {
+
+AsyncColumnWriter::AsyncColumnWriter(const std::string& path, const void* header,
+                                     size_t header_size)
+    : file_(std::fopen(path.c_str(), "wb")) {
+    if (!file_) {
+        throw std::runtime_error("Could not open sample file: " + path);
+    }
+    if (std::fwrite(header, 1, header_size, file_) != header_size) {
+        std::fclose(file_);
+        throw std::runtime_error("Could not write sample file header: " + path);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+AsyncColumnWriter::~AsyncColumnWriter() {
+    if (file_) {
+        close();
+    }
+}
+
+bool AsyncColumnWriter::close() {
+    if (!file_) return !failed();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+    if (std::fclose(file_) != 0) {  // Buffered bytes are only written here
+        failed_.store(true, std::memory_order_relaxed);
+    }
+    file_ = nullptr;
+    return !failed();
+}
+
+AsyncColumnWriter::Chunk AsyncColumnWriter::acquire(size_t columns, size_t capacity) {
+    Chunk chunk;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            chunk = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    chunk.data.resize(columns * capacity);
+    chunk.capacity = capacity;
+    chunk.rows = 0;
+    return chunk;
+}
+
+void AsyncColumnWriter::submit(Chunk chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(chunk));
+    }
+    cv_.notify_one();
+}
+
+size_t AsyncColumnWriter::queue_depth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+void AsyncColumnWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) break;  // stop_ set and fully drained
+
+        Chunk chunk = std::move(pending_.front());
+        pending_.pop_front();
+
+        lock.unlock();
+        write_chunk(chunk);
+        lock.lock();
+
+        free_.push_back(std::move(chunk));
+    }
+}
+
+void AsyncColumnWriter::write_chunk(const Chunk& chunk) {
+    if (failed()) return;  // The file is truncated already
+    int64_t rows = static_cast<int64_t>(chunk.rows);
+    bool ok = std::fwrite(&rows, sizeof(rows), 1, file_) == 1;
+
+    size_t columns = chunk.capacity ? chunk.data.size() / chunk.capacity : 0;
+    for (size_t c = 0; c < columns && ok; ++c) {
+        ok = std::fwrite(&chunk.data[c * chunk.capacity], sizeof(int64_t), chunk.rows, file_) == chunk.rows;
+    }
+    if (!ok) {
+        failed_.store(true, std::memory_order_relaxed);
+    }
+}
+
+BookSampler::BookSampler(const SamplerConfig& config)
+    : config_(config),
+      header_(make_header(config)),
+      writer_(config.path, header_.data(), header_.size() * sizeof(int64_t)),
+      prices_(config.depth_levels),
+      quantities_(config.depth_levels) {
+    config_.rows_per_chunk = std::max<size_t>(config_.rows_per_chunk, 1);  // A row must fit
+    chunk_ = writer_.acquire(column_count(), config_.rows_per_chunk);
+}
+
+BookSampler::~BookSampler() {
+    submit_chunk();
+}
+
+std::vector<int64_t> BookSampler::make_header(const SamplerConfig& config) {
+    int64_t magic;
+    std::memcpy(&magic, "BTSAMPL1", sizeof(magic));
+    return {
+        magic,
+        static_cast<int64_t>(config.depth_levels),
+        static_cast<int64_t>(FIXED_COLUMNS + 4 * config.depth_levels)
+    };
+}
+
+void BookSampler::add_book(SymbolId symbol, const OrderBook* book) {
+    books_.emplace_back(symbol, book);
+}
+
+void BookSampler::on_event(Timestamp now) {
+    if (chunk_.capacity == 0) return;  // Closed
+    bool due = false;
+
+    if (config_.every_n_events && ++events_ >= config_.every_n_events) {
+        events_ = 0;
+        due = true;
+    }
+    if (config_.interval_ns && now >= next_sample_time_) {
+        next_sample_time_ = (now / config_.interval_ns + 1) * config_.interval_ns;
+        due = true;
+    }
+
+    if (due) {
+        sample_all(now);
+    }
+}
+
+void BookSampler::flush() {
+    submit_chunk();
+    if (failed()) {
+        throw std::runtime_error("Short write to sample file: " + config_.path);
+    }
+}
+
+void BookSampler::close() {
+    submit_chunk();
+    chunk_ = {};
+    if (!writer_.close()) {
+        throw std::runtime_error("Short write to sample file: " + config_.path);
+    }
+}
+
+void BookSampler::submit_chunk() {
+    if (chunk_.rows == 0) return;
+    writer_.submit(std::move(chunk_));
+    chunk_ = writer_.acquire(column_count(), config_.rows_per_chunk);
+}
+
+void BookSampler::sample_all(Timestamp now) {
+    for (const auto& [symbol, book] : books_) {
+        sample_book(now, symbol, *book);
+    }
+}
+
+void BookSampler::sample_book(Timestamp now, SymbolId symbol, const OrderBook& book) {
+    const size_t depth = config_.depth_levels;
+    const size_t cap = chunk_.capacity;
+    int64_t* row = chunk_.data.data() + chunk_.rows;
+
+    Price bid = book.best_bid();
+    Price ask = book.best_ask();
+    row[0 * cap] = static_cast<int64_t>(now);
+    row[1 * cap] = symbol;
+    row[2 * cap] = bid;
+    row[3 * cap] = ask;
+    row[4 * cap] = (bid && ask) ? ask - bid : 0;
+
+    // Depth columns; missing levels are written as zero
+    Quantity side_depth[2] = {0, 0};
+    const Side sides[2] = {Side::BUY, Side::SELL};
+    for (size_t s = 0; s < 2; ++s) {
+        size_t levels = book.depth(sides[s], depth, prices_.data(), quantities_.data());
+        int64_t* px_col = row + (FIXED_COLUMNS + (2 * s) * depth) * cap;
+        int64_t* qty_col = row + (FIXED_COLUMNS + (2 * s + 1) * depth) * cap;
+        for (size_t i = 0; i < depth; ++i) {
+            Price px = i < levels ? prices_[i] : 0;
+            Quantity qty = i < levels ? quantities_[i] : 0;
+            px_col[i * cap] = px;
+            qty_col[i * cap] = qty;
+            side_depth[s] += qty;
+        }
+    }
+
+    Quantity total = side_depth[0] + side_depth[1];
+    row[5 * cap] = total > 0 ? (side_depth[0] - side_depth[1]) * 10000 / total : 0;
+
+    ++rows_written_;
+    if (++chunk_.rows == cap) {
+        flush();
+    }
+}
+
+} // namespace trading
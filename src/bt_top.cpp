@@ -0,0 +1,150 @@
+#include "live_stats.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+using namespace trading;
+
+// Snapshot of one thread slot, copied out of shared memory
+struct ThreadView {
+    uint64_t state;
+    uint64_t heartbeat_ns;
+    uint64_t ticks;
+    uint64_t orders;
+    uint64_t trades;
+    uint64_t latency_ns;
+    uint64_t pool_allocated;
+    uint64_t pool_bytes;
+    uint64_t queue_depth;
+    uint64_t simulated_time;
+    uint64_t histogram[LiveThreadStats::LATENCY_BUCKETS];
+};
+
+ThreadView read_thread(const LiveThreadStats& t) {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    ThreadView v;
+    v.state = t.state.load(relaxed);
+    v.heartbeat_ns = t.heartbeat_ns.load(relaxed);
+    v.ticks = t.ticks_processed.load(relaxed);
+    v.orders = t.orders_submitted.load(relaxed);
+    v.trades = t.trades_executed.load(relaxed);
+    v.latency_ns = t.total_latency_ns.load(relaxed);
+    v.pool_allocated = t.pool_allocated.load(relaxed);
+    v.pool_bytes = t.pool_bytes.load(relaxed);
+    v.queue_depth = t.queue_depth.load(relaxed);
+    v.simulated_time = t.simulated_time.load(relaxed);
+    for (size_t b = 0; b < LiveThreadStats::LATENCY_BUCKETS; ++b) {
+        v.histogram[b] = t.latency_histogram[b].load(relaxed);
+    }
+    return v;
+}
+
+// Upper bound (ns) of the log2 bucket containing the requested percentile
+uint64_t percentile_ns(const uint64_t* histogram, double pct) {
+    uint64_t total = 0;
+    for (size_t b = 0; b < LiveThreadStats::LATENCY_BUCKETS; ++b) total += histogram[b];
+    if (total == 0) return 0;
+
+    uint64_t target = static_cast<uint64_t>(total * pct);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < LiveThreadStats::LATENCY_BUCKETS; ++b) {
+        seen += histogram[b];
+        if (seen > target) return b == 0 ? 0 : (1ULL << b) - 1;
+    }
+    return ~0ULL;
+}
+
+const char* state_name(uint64_t state, double heartbeat_age_s) {
+    switch (state) {
+        case LiveThreadStats::RUNNING: return heartbeat_age_s > 2.0 ? "STALLED" : "RUNNING";
+        case LiveThreadStats::FINISHED: return "DONE";
+        default: return "IDLE";
+    }
+}
+
+void render(const LiveStatsSegment& seg, std::vector<ThreadView>& prev, double dt_s, bool clear) {
+    uint64_t now = LiveStatsRegion::now_ns();
+    uint32_t threads = std::min(seg.threads_in_use.load(std::memory_order_relaxed),
+                                LiveStatsSegment::MAX_THREADS);
+    prev.resize(threads);
+
+    if (clear) std::cout << "\033[H\033[2J";
+    std::cout << "bt-top  pid " << seg.pid.load() << "  uptime "
+              << (now - seg.start_ns.load()) / 1000000000ULL << "s  threads " << threads << "\n\n";
+
+    std::cout << std::left << std::setw(4) << "TID" << std::setw(9) << "STATE"
+              << std::right << std::setw(14) << "TICKS" << std::setw(12) << "TICKS/S"
+              << std::setw(12) << "ORDERS" << std::setw(12) << "TRADES"
+              << std::setw(10) << "POOL(MB)" << std::setw(7) << "QUEUE"
+              << std::setw(9) << "AVG(ns)" << std::setw(9) << "P50" << std::setw(9) << "P99"
+              << std::setw(10) << "P99.9" << "\n";
+
+    uint64_t total_ticks = 0, total_orders = 0, total_trades = 0;
+    double total_rate = 0;
+    uint64_t merged[LiveThreadStats::LATENCY_BUCKETS] = {};
+
+    for (uint32_t i = 0; i < threads; ++i) {
+        ThreadView v = read_thread(seg.threads[i]);
+        double rate = dt_s > 0 ? (v.ticks - prev[i].ticks) / dt_s : 0.0;
+        // Heartbeats written after `now` was sampled count as fresh, not as
+        // a wrapped unsigned age
+        double age_s = v.heartbeat_ns > now ? 0.0 : (now - v.heartbeat_ns) / 1e9;
+        prev[i] = v;
+
+        total_ticks += v.ticks;
+        total_orders += v.orders;
+        total_trades += v.trades;
+        total_rate += rate;
+        for (size_t b = 0; b < LiveThreadStats::LATENCY_BUCKETS; ++b) merged[b] += v.histogram[b];
+
+        std::cout << std::left << std::setw(4) << i << std::setw(9) << state_name(v.state, age_s)
+                  << std::right << std::setw(14) << v.ticks << std::setw(12) << static_cast<uint64_t>(rate)
+                  << std::setw(12) << v.orders << std::setw(12) << v.trades
+                  << std::setw(10) << std::fixed << std::setprecision(1) << v.pool_bytes / 1048576.0
+                  << std::setw(7) << v.queue_depth
+                  << std::setw(9) << (v.ticks ? v.latency_ns / v.ticks : 0)
+                  << std::setw(9) << percentile_ns(v.histogram, 0.50)
+                  << std::setw(9) << percentile_ns(v.histogram, 0.99)
+                  << std::setw(10) << percentile_ns(v.histogram, 0.999) << "\n";
+    }
+
+    std::cout << "\nTotal: " << total_ticks << " ticks  " << static_cast<uint64_t>(total_rate)
+              << " ticks/s  " << total_orders << " orders  " << total_trades << " trades  p99 "
+              << percentile_ns(merged, 0.99) << " ns\n" << std::flush;
+}
+
+int main(int argc, char** argv) {
+    std::string name = "/backtester";
+    bool once = false;
+    int interval_ms = 1000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--once") {
+            once = true;
+        } else if (arg == "--interval" && i + 1 < argc) {
+            interval_ms = std::stoi(argv[++i]);
+        } else {
+            name = arg;
+        }
+    }
+
+    try {
+        LiveStatsRegion region = LiveStatsRegion::attach(name);
+        std::vector<ThreadView> prev;
+
+        render(*region.segment(), prev, 0.0, !once);
+        while (!once) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+            render(*region.segment(), prev, interval_ms / 1000.0, true);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "bt-top: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
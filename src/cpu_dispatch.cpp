@@ -0,0 +1,614 @@
+#include "cpu_dispatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BT_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace trading {
+
+namespace {
+
+int64_t wrapping_add(int64_t a, int64_t b) {
+    return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+// ---- Scalar (portable baseline; the compiler may still auto-vectorize) ----
+
+int64_t sum_i64_scalar(const int64_t* values, size_t n) {
+    uint64_t sum = 0;  // Unsigned so overflow wraps like the SIMD variants
+    for (size_t i = 0; i < n; ++i) {
+        sum += static_cast<uint64_t>(values[i]);
+    }
+    return static_cast<int64_t>(sum);
+}
+
+size_t find_byte_scalar(const char* data, size_t n, char byte) {
+    const void* hit = std::memchr(data, byte, n);
+    return hit ? static_cast<size_t>(static_cast<const char*>(hit) - data) : n;
+}
+
+void prefix_sum_i64_scalar(const int64_t* in, int64_t* out, size_t n) {
+    uint64_t running = 0;
+    for (size_t i = 0; i < n; ++i) {
+        running += static_cast<uint64_t>(in[i]);
+        out[i] = static_cast<int64_t>(running);
+    }
+}
+
+void rank2_update_f64_scalar(double* row, double a, const double* x,
+                             double b, const double* y, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        row[i] += a * x[i] + b * y[i];
+    }
+}
+
+// ---- Option pricing math ----
+// Every tier evaluates the same polynomials in the same order, so tiers
+// agree to rounding (exactly, unless the compiler contracts to FMA).
+
+constexpr double LOG2E = 1.4426950408889634;
+constexpr double LN2_HI = 0.693147180369123816490;  // Cody-Waite split of ln 2
+constexpr double LN2_LO = 1.90821492927058770002e-10;
+constexpr double SQRT2 = 1.4142135623730951;
+constexpr double INV_SQRT_2PI = 0.3989422804014327;
+constexpr double EXP_MIN = -708.0;
+constexpr double EXP_MAX = 709.0;
+
+// exp(r) on |r| <= ln2/2: Taylor to r^13, highest power first
+constexpr double EXP_POLY[] = {
+    1.6059043836821613e-10, 2.08767569878681e-09, 2.505210838544172e-08, 2.755731922398589e-07,
+    2.7557319223985893e-06, 2.48015873015873e-05, 0.0001984126984126984, 0.001388888888888889,
+    0.008333333333333333, 0.041666666666666664, 0.16666666666666666, 0.5, 1.0, 1.0};
+// log(m) = 2 atanh(s) = 2s * sum s^2k / (2k + 1), |s| <= 0.172
+constexpr double LOG_POLY[] = {
+    0.05263157894736842, 0.058823529411764705, 0.06666666666666667, 0.07692307692307693,
+    0.09090909090909091, 0.1111111111111111, 0.14285714285714285, 0.2, 0.3333333333333333, 1.0};
+// Hart (1968) double-precision normal tail, as arranged by West (2005):
+// N(-|x|) = exp(-x^2/2) * P(|x|) / Q(|x|) below 7.07, continued fraction above
+constexpr double CDF_NUM[] = {
+    3.52624965998911e-02, 0.700383064443688, 6.37396220353165, 33.912866078383,
+    112.079291497871, 221.213596169931, 220.206867912376};
+constexpr double CDF_DEN[] = {
+    8.83883476483184e-02, 1.75566716318264, 16.064177579207, 86.7807322029461,
+    296.564248779674, 637.333633378831, 793.826512519948, 440.413735824752};
+constexpr double CDF_SPLIT = 7.07106781186547;
+constexpr double CDF_ZERO = 37.0;  // Tail underflows beyond this
+constexpr double SQRT_2PI = 2.506628274631;
+
+template<size_t N>
+double horner(const double (&c)[N], double x) {
+    double p = c[0];
+    for (size_t k = 1; k < N; ++k) p = p * x + c[k];
+    return p;
+}
+
+double exp_poly(double x) {
+    x = std::min(std::max(x, EXP_MIN), EXP_MAX);
+    double n = std::nearbyint(x * LOG2E);
+    double r = (x - n * LN2_HI) - n * LN2_LO;
+    uint64_t bits = static_cast<uint64_t>(static_cast<int64_t>(n) + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return horner(EXP_POLY, r) * scale;
+}
+
+double log_poly(double x) {
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    double e = static_cast<double>(bits >> 52) - 1023.0;
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if (m > SQRT2) {
+        m = m * 0.5;
+        e = e + 1.0;
+    }
+    double s = (m - 1.0) / (m + 1.0);
+    double p = horner(LOG_POLY, s * s);
+    return e * LN2_HI + (e * LN2_LO + (2.0 * s) * p);
+}
+
+// Also returns exp(-x^2/2), which the greeks reuse for the density
+double normal_cdf(double x, double& gauss) {
+    double a = std::fabs(x);
+    gauss = exp_poly((-0.5 * a) * a);
+    double tail;
+    if (a < CDF_SPLIT) {
+        tail = (gauss * horner(CDF_NUM, a)) / horner(CDF_DEN, a);
+    } else {
+        double b = a + 0.65;
+        b = a + 4.0 / b;
+        b = a + 3.0 / b;
+        b = a + 2.0 / b;
+        b = a + 1.0 / b;
+        tail = (gauss / b) / SQRT_2PI;
+    }
+    if (a > CDF_ZERO) tail = 0.0;
+    return x > 0.0 ? 1.0 - tail : tail;
+}
+
+OptionBatch offset(const OptionBatch& b, size_t i) {
+    return OptionBatch{b.strike + i, b.time + i, b.vol + i, b.sign + i,
+                       b.value + i, b.delta + i, b.gamma + i, b.vega + i};
+}
+
+void black_scholes_f64_scalar(double spot, double rate, const OptionBatch& b, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        double t = b.time[i];
+        double v = b.vol[i];
+        double w = b.sign[i];
+        double sqrt_t = std::sqrt(t);
+        double vs = v * sqrt_t;
+        double d1 = (log_poly(spot / b.strike[i]) + (rate + (0.5 * v) * v) * t) / vs;
+        double d2 = d1 - vs;
+        double discounted = b.strike[i] * exp_poly(-rate * t);
+        double gauss, unused;
+        double n1 = normal_cdf(w * d1, gauss);
+        double n2 = normal_cdf(w * d2, unused);
+        double pdf = gauss * INV_SQRT_2PI;
+        b.value[i] = w * (spot * n1 - discounted * n2);
+        b.delta[i] = w * n1;
+        b.gamma[i] = pdf / (spot * vs);
+        b.vega[i] = (spot * pdf) * sqrt_t;
+    }
+}
+
+#ifdef BT_X86_KERNELS
+
+// ---- SSE4.2 ----
+
+__attribute__((target("sse4.2")))
+int64_t sum_i64_sse42(const int64_t* values, size_t n) {
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_epi64(acc0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+        acc1 = _mm_add_epi64(acc1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i + 2)));
+    }
+    __m128i acc = _mm_add_epi64(acc0, acc1);
+    uint64_t sum = static_cast<uint64_t>(_mm_cvtsi128_si64(acc)) +
+                   static_cast<uint64_t>(_mm_extract_epi64(acc, 1));
+    return wrapping_add(static_cast<int64_t>(sum), sum_i64_scalar(values + i, n - i));
+}
+
+__attribute__((target("sse4.2")))
+size_t find_byte_sse42(const char* data, size_t n, char byte) {
+    const __m128i needle = _mm_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + find_byte_scalar(data + i, n - i, byte);
+}
+
+__attribute__((target("sse4.2")))
+void prefix_sum_i64_sse42(const int64_t* in, int64_t* out, size_t n) {
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        v = _mm_add_epi64(v, _mm_slli_si128(v, 8));  // [a, a+b]
+        v = _mm_add_epi64(v, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+        carry = _mm_unpackhi_epi64(v, v);
+    }
+    int64_t running = _mm_cvtsi128_si64(carry);
+    for (; i < n; ++i) {
+        running = wrapping_add(running, in[i]);
+        out[i] = running;
+    }
+}
+
+__attribute__((target("sse4.2")))
+void rank2_update_f64_sse42(double* row, double a, const double* x,
+                            double b, const double* y, size_t n) {
+    const __m128d va = _mm_set1_pd(a);
+    const __m128d vb = _mm_set1_pd(b);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d t = _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(x + i)), _mm_mul_pd(vb, _mm_loadu_pd(y + i)));
+        _mm_storeu_pd(row + i, _mm_add_pd(_mm_loadu_pd(row + i), t));
+    }
+    rank2_update_f64_scalar(row + i, a, x + i, b, y + i, n - i);
+}
+
+// ---- AVX2 ----
+
+__attribute__((target("avx2")))
+int64_t sum_i64_avx2(const int64_t* values, size_t n) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 4)));
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    uint64_t sum = static_cast<uint64_t>(_mm_cvtsi128_si64(half)) +
+                   static_cast<uint64_t>(_mm_extract_epi64(half, 1));
+    return wrapping_add(static_cast<int64_t>(sum), sum_i64_scalar(values + i, n - i));
+}
+
+__attribute__((target("avx2")))
+size_t find_byte_avx2(const char* data, size_t n, char byte) {
+    const __m256i needle = _mm256_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask) return i + __builtin_ctz(mask);
+    }
+    return i + find_byte_sse42(data + i, n - i, byte);
+}
+
+__attribute__((target("avx2")))
+void prefix_sum_i64_avx2(const int64_t* in, int64_t* out, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i carry = zero;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        // Shift up one lane: [0, a, b, c]
+        __m256i s1 = _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+        v = _mm256_add_epi64(v, s1);
+        // Shift up two lanes: [0, 0, a, a+b]
+        __m256i s2 = _mm256_blend_epi32(_mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F);
+        v = _mm256_add_epi64(_mm256_add_epi64(v, s2), carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+        carry = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    int64_t running = _mm256_extract_epi64(carry, 0);
+    for (; i < n; ++i) {
+        running = wrapping_add(running, in[i]);
+        out[i] = running;
+    }
+}
+
+__attribute__((target("avx2")))
+void rank2_update_f64_avx2(double* row, double a, const double* x,
+                           double b, const double* y, size_t n) {
+    const __m256d va = _mm256_set1_pd(a);
+    const __m256d vb = _mm256_set1_pd(b);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d t = _mm256_add_pd(_mm256_mul_pd(va, _mm256_loadu_pd(x + i)),
+                                  _mm256_mul_pd(vb, _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(row + i, _mm256_add_pd(_mm256_loadu_pd(row + i), t));
+    }
+    rank2_update_f64_scalar(row + i, a, x + i, b, y + i, n - i);
+}
+
+template<size_t N>
+__attribute__((target("avx2"), always_inline)) inline
+__m256d horner_avx2(const double (&c)[N], __m256d x) {
+    __m256d p = _mm256_set1_pd(c[0]);
+    for (size_t k = 1; k < N; ++k) p = _mm256_add_pd(_mm256_mul_pd(p, x), _mm256_set1_pd(c[k]));
+    return p;
+}
+
+__attribute__((target("avx2"), always_inline)) inline
+__m256d exp_avx2(__m256d x) {
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN)), _mm256_set1_pd(EXP_MAX));
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_sub_pd(_mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(LN2_HI))),
+                              _mm256_mul_pd(n, _mm256_set1_pd(LN2_LO)));
+    // 2^n built directly in the exponent field
+    __m256i e = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)), _mm256_set1_epi64x(1023));
+    __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(e, 52));
+    return _mm256_mul_pd(horner_avx2(EXP_POLY, r), scale);
+}
+
+__attribute__((target("avx2"), always_inline)) inline
+__m256d log_avx2(__m256d x) {
+    __m256i bits = _mm256_castpd_si256(x);
+    // Biased exponent to double without AVX-512DQ: splice it under 2^52
+    const __m256d magic = _mm256_set1_pd(0x1.0p52);
+    __m256i biased = _mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(magic));
+    __m256d e = _mm256_sub_pd(_mm256_sub_pd(_mm256_castsi256_pd(biased), magic), _mm256_set1_pd(1023.0));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+        _mm256_set1_epi64x(0x3FF0000000000000LL)));
+    __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(SQRT2), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    e = _mm256_add_pd(e, _mm256_and_pd(big, _mm256_set1_pd(1.0)));
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d p = horner_avx2(LOG_POLY, _mm256_mul_pd(s, s));
+    __m256d low = _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(LN2_LO)),
+                                _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(2.0), s), p));
+    return _mm256_add_pd(_mm256_mul_pd(e, _mm256_set1_pd(LN2_HI)), low);
+}
+
+// The far tail is only evaluated when some lane needs it
+__attribute__((target("avx2"), always_inline)) inline
+__m256d normal_cdf_avx2(__m256d x, __m256d& gauss) {
+    __m256d a = _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+    gauss = exp_avx2(_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(-0.5), a), a));
+    __m256d near = _mm256_div_pd(_mm256_mul_pd(gauss, horner_avx2(CDF_NUM, a)), horner_avx2(CDF_DEN, a));
+    __m256d is_near = _mm256_cmp_pd(a, _mm256_set1_pd(CDF_SPLIT), _CMP_LT_OQ);
+    __m256d tail = near;
+    if (_mm256_movemask_pd(is_near) != 0xF) {
+        __m256d b = _mm256_add_pd(a, _mm256_set1_pd(0.65));
+        b = _mm256_add_pd(a, _mm256_div_pd(_mm256_set1_pd(4.0), b));
+        b = _mm256_add_pd(a, _mm256_div_pd(_mm256_set1_pd(3.0), b));
+        b = _mm256_add_pd(a, _mm256_div_pd(_mm256_set1_pd(2.0), b));
+        b = _mm256_add_pd(a, _mm256_div_pd(_mm256_set1_pd(1.0), b));
+        __m256d far = _mm256_div_pd(_mm256_div_pd(gauss, b), _mm256_set1_pd(SQRT_2PI));
+        tail = _mm256_blendv_pd(far, near, is_near);
+    }
+    tail = _mm256_andnot_pd(_mm256_cmp_pd(a, _mm256_set1_pd(CDF_ZERO), _CMP_GT_OQ), tail);
+    __m256d upper = _mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_GT_OQ);
+    return _mm256_blendv_pd(tail, _mm256_sub_pd(_mm256_set1_pd(1.0), tail), upper);
+}
+
+__attribute__((target("avx2")))
+void black_scholes_f64_avx2(double spot, double rate, const OptionBatch& b, size_t n) {
+    const __m256d s = _mm256_set1_pd(spot);
+    const __m256d r = _mm256_set1_pd(rate);
+    const __m256d neg_r = _mm256_set1_pd(-rate);
+    const __m256d half = _mm256_set1_pd(0.5);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d k = _mm256_loadu_pd(b.strike + i);
+        __m256d t = _mm256_loadu_pd(b.time + i);
+        __m256d v = _mm256_loadu_pd(b.vol + i);
+        __m256d w = _mm256_loadu_pd(b.sign + i);
+        __m256d sqrt_t = _mm256_sqrt_pd(t);
+        __m256d vs = _mm256_mul_pd(v, sqrt_t);
+        __m256d drift = _mm256_mul_pd(_mm256_add_pd(r, _mm256_mul_pd(_mm256_mul_pd(half, v), v)), t);
+        __m256d d1 = _mm256_div_pd(_mm256_add_pd(log_avx2(_mm256_div_pd(s, k)), drift), vs);
+        __m256d d2 = _mm256_sub_pd(d1, vs);
+        __m256d discounted = _mm256_mul_pd(k, exp_avx2(_mm256_mul_pd(neg_r, t)));
+        __m256d gauss, unused;
+        __m256d n1 = normal_cdf_avx2(_mm256_mul_pd(w, d1), gauss);
+        __m256d n2 = normal_cdf_avx2(_mm256_mul_pd(w, d2), unused);
+        __m256d pdf = _mm256_mul_pd(gauss, _mm256_set1_pd(INV_SQRT_2PI));
+        _mm256_storeu_pd(b.value + i, _mm256_mul_pd(w, _mm256_sub_pd(_mm256_mul_pd(s, n1),
+                                                                     _mm256_mul_pd(discounted, n2))));
+        _mm256_storeu_pd(b.delta + i, _mm256_mul_pd(w, n1));
+        _mm256_storeu_pd(b.gamma + i, _mm256_div_pd(pdf, _mm256_mul_pd(s, vs)));
+        _mm256_storeu_pd(b.vega + i, _mm256_mul_pd(_mm256_mul_pd(s, pdf), sqrt_t));
+    }
+    black_scholes_f64_scalar(spot, rate, offset(b, i), n - i);
+}
+
+// ---- AVX-512 (F + BW) ----
+
+__attribute__((target("avx512f,avx512bw")))
+int64_t sum_i64_avx512(const int64_t* values, size_t n) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_loadu_si512(values + i));
+        acc1 = _mm512_add_epi64(acc1, _mm512_loadu_si512(values + i + 8));
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm512_add_epi64(acc0, _mm512_loadu_si512(values + i));
+        i += 8;
+    }
+    int64_t sum = _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1));
+    return wrapping_add(sum, sum_i64_scalar(values + i, n - i));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t find_byte_avx512(const char* data, size_t n, char byte) {
+    const __m512i needle = _mm512_set1_epi8(byte);
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __mmask64 mask = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(data + i), needle);
+        if (mask) return i + __builtin_ctzll(mask);
+    }
+    if (i < n) {
+        // Masked load never touches bytes past the end
+        __mmask64 valid = (1ULL << (n - i)) - 1;
+        __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(valid, _mm512_maskz_loadu_epi8(valid, data + i), needle);
+        if (mask) return i + __builtin_ctzll(mask);
+    }
+    return n;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void prefix_sum_i64_avx512(const int64_t* in, int64_t* out, size_t n) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i carry = zero;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_loadu_si512(in + i);
+        v = _mm512_add_epi64(v, _mm512_alignr_epi64(v, zero, 7));  // shift up 1 lane
+        v = _mm512_add_epi64(v, _mm512_alignr_epi64(v, zero, 6));  // shift up 2 lanes
+        v = _mm512_add_epi64(v, _mm512_alignr_epi64(v, zero, 4));  // shift up 4 lanes
+        v = _mm512_add_epi64(v, carry);
+        _mm512_storeu_si512(out + i, v);
+        carry = _mm512_permutexvar_epi64(_mm512_set1_epi64(7), v);
+    }
+    int64_t running = _mm_cvtsi128_si64(_mm512_castsi512_si128(carry));
+    for (; i < n; ++i) {
+        running = wrapping_add(running, in[i]);
+        out[i] = running;
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void rank2_update_f64_avx512(double* row, double a, const double* x,
+                             double b, const double* y, size_t n) {
+    const __m512d va = _mm512_set1_pd(a);
+    const __m512d vb = _mm512_set1_pd(b);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d t = _mm512_add_pd(_mm512_mul_pd(va, _mm512_loadu_pd(x + i)),
+                                  _mm512_mul_pd(vb, _mm512_loadu_pd(y + i)));
+        _mm512_storeu_pd(row + i, _mm512_add_pd(_mm512_loadu_pd(row + i), t));
+    }
+    rank2_update_f64_scalar(row + i, a, x + i, b, y + i, n - i);
+}
+
+// Option math uses FMA (part of AVX-512F), so results differ from the
+// other tiers by rounding only
+template<size_t N>
+__attribute__((target("avx512f,avx512bw"), always_inline)) inline
+__m512d horner_avx512(const double (&c)[N], __m512d x) {
+    __m512d p = _mm512_set1_pd(c[0]);
+    for (size_t k = 1; k < N; ++k) p = _mm512_fmadd_pd(p, x, _mm512_set1_pd(c[k]));
+    return p;
+}
+
+__attribute__((target("avx512f,avx512bw"), always_inline)) inline
+__m512d exp_avx512(__m512d x) {
+    x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(EXP_MIN)), _mm512_set1_pd(EXP_MAX));
+    __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2E)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_LO), _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_HI), x));
+    return _mm512_scalef_pd(horner_avx512(EXP_POLY, r), n);
+}
+
+__attribute__((target("avx512f,avx512bw"), always_inline)) inline
+__m512d log_avx512(__m512d x) {
+    __m512d e = _mm512_getexp_pd(x);
+    __m512d m = _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_src);
+    __mmask8 big = _mm512_cmp_pd_mask(m, _mm512_set1_pd(SQRT2), _CMP_GT_OQ);
+    m = _mm512_mask_mul_pd(m, big, m, _mm512_set1_pd(0.5));
+    e = _mm512_mask_add_pd(e, big, e, _mm512_set1_pd(1.0));
+    const __m512d one = _mm512_set1_pd(1.0);
+    __m512d s = _mm512_div_pd(_mm512_sub_pd(m, one), _mm512_add_pd(m, one));
+    __m512d p = horner_avx512(LOG_POLY, _mm512_mul_pd(s, s));
+    __m512d low = _mm512_fmadd_pd(e, _mm512_set1_pd(LN2_LO), _mm512_mul_pd(_mm512_add_pd(s, s), p));
+    return _mm512_fmadd_pd(e, _mm512_set1_pd(LN2_HI), low);
+}
+
+__attribute__((target("avx512f,avx512bw"), always_inline)) inline
+__m512d normal_cdf_avx512(__m512d x, __m512d& gauss) {
+    __m512d a = _mm512_abs_pd(x);
+    gauss = exp_avx512(_mm512_mul_pd(_mm512_mul_pd(_mm512_set1_pd(-0.5), a), a));
+    __m512d tail = _mm512_div_pd(_mm512_mul_pd(gauss, horner_avx512(CDF_NUM, a)), horner_avx512(CDF_DEN, a));
+    __mmask8 far = _mm512_cmp_pd_mask(a, _mm512_set1_pd(CDF_SPLIT), _CMP_NLT_UQ);
+    if (far) {
+        __m512d b = _mm512_add_pd(a, _mm512_set1_pd(0.65));
+        b = _mm512_add_pd(a, _mm512_div_pd(_mm512_set1_pd(4.0), b));
+        b = _mm512_add_pd(a, _mm512_div_pd(_mm512_set1_pd(3.0), b));
+        b = _mm512_add_pd(a, _mm512_div_pd(_mm512_set1_pd(2.0), b));
+        b = _mm512_add_pd(a, _mm512_div_pd(_mm512_set1_pd(1.0), b));
+        tail = _mm512_mask_div_pd(tail, far, _mm512_div_pd(gauss, b), _mm512_set1_pd(SQRT_2PI));
+    }
+    tail = _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, _mm512_set1_pd(CDF_ZERO), _CMP_LE_OQ), tail);
+    __mmask8 upper = _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_GT_OQ);
+    return _mm512_mask_sub_pd(tail, upper, _mm512_set1_pd(1.0), tail);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void black_scholes_f64_avx512(double spot, double rate, const OptionBatch& b, size_t n) {
+    const __m512d s = _mm512_set1_pd(spot);
+    const __m512d r = _mm512_set1_pd(rate);
+    const __m512d neg_r = _mm512_set1_pd(-rate);
+    const __m512d half = _mm512_set1_pd(0.5);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512d k = _mm512_loadu_pd(b.strike + i);
+        __m512d t = _mm512_loadu_pd(b.time + i);
+        __m512d v = _mm512_loadu_pd(b.vol + i);
+        __m512d w = _mm512_loadu_pd(b.sign + i);
+        __m512d sqrt_t = _mm512_sqrt_pd(t);
+        __m512d vs = _mm512_mul_pd(v, sqrt_t);
+        __m512d drift = _mm512_mul_pd(_mm512_fmadd_pd(_mm512_mul_pd(half, v), v, r), t);
+        __m512d d1 = _mm512_div_pd(_mm512_add_pd(log_avx512(_mm512_div_pd(s, k)), drift), vs);
+        __m512d d2 = _mm512_sub_pd(d1, vs);
+        __m512d discounted = _mm512_mul_pd(k, exp_avx512(_mm512_mul_pd(neg_r, t)));
+        __m512d gauss, unused;
+        __m512d n1 = normal_cdf_avx512(_mm512_mul_pd(w, d1), gauss);
+        __m512d n2 = normal_cdf_avx512(_mm512_mul_pd(w, d2), unused);
+        __m512d pdf = _mm512_mul_pd(gauss, _mm512_set1_pd(INV_SQRT_2PI));
+        _mm512_storeu_pd(b.value + i, _mm512_mul_pd(w, _mm512_fmsub_pd(s, n1, _mm512_mul_pd(discounted, n2))));
+        _mm512_storeu_pd(b.delta + i, _mm512_mul_pd(w, n1));
+        _mm512_storeu_pd(b.gamma + i, _mm512_div_pd(pdf, _mm512_mul_pd(s, vs)));
+        _mm512_storeu_pd(b.vega + i, _mm512_mul_pd(_mm512_mul_pd(s, pdf), sqrt_t));
+    }
+    black_scholes_f64_avx2(spot, rate, offset(b, i), n - i);
+}
+
+#endif // BT_X86_KERNELS
+
+const KernelTable SCALAR_TABLE{
+    CpuLevel::SCALAR, "scalar", sum_i64_scalar, find_byte_scalar, prefix_sum_i64_scalar,
+    rank2_update_f64_scalar, black_scholes_f64_scalar};
+
+#ifdef BT_X86_KERNELS
+const KernelTable SSE42_TABLE{
+    CpuLevel::SSE42, "sse4.2", sum_i64_sse42, find_byte_sse42, prefix_sum_i64_sse42,
+    rank2_update_f64_sse42, black_scholes_f64_scalar};
+const KernelTable AVX2_TABLE{
+    CpuLevel::AVX2, "avx2", sum_i64_avx2, find_byte_avx2, prefix_sum_i64_avx2,
+    rank2_update_f64_avx2, black_scholes_f64_avx2};
+const KernelTable AVX512_TABLE{
+    CpuLevel::AVX512, "avx512", sum_i64_avx512, find_byte_avx512, prefix_sum_i64_avx512,
+    rank2_update_f64_avx512, black_scholes_f64_avx512};
+#endif
+
+CpuLevel parse_level(const char* name, CpuLevel fallback) {
+    if (!name) return fallback;
+    if (std::strcmp(name, "scalar") == 0) return CpuLevel::SCALAR;
+    if (std::strcmp(name, "sse42") == 0) return CpuLevel::SSE42;
+    if (std::strcmp(name, "avx2") == 0) return CpuLevel::AVX2;
+    if (std::strcmp(name, "avx512") == 0) return CpuLevel::AVX512;
+    return fallback;
+}
+
+} // namespace
+
+CpuLevel detect_cpu_level() {
+#ifdef BT_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return CpuLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) return CpuLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return CpuLevel::SSE42;
+#endif
+    return CpuLevel::SCALAR;
+}
+
+bool cpu_level_supported(CpuLevel level) {
+    return level <= detect_cpu_level();
+}
+
+const KernelTable& kernel_table(CpuLevel level) {
+    if (!cpu_level_supported(level)) return SCALAR_TABLE;
+#ifdef BT_X86_KERNELS
+    switch (level) {
+        case CpuLevel::AVX512: return AVX512_TABLE;
+        case CpuLevel::AVX2: return AVX2_TABLE;
+        case CpuLevel::SSE42: return SSE42_TABLE;
+        default: break;
+    }
+#endif
+    return SCALAR_TABLE;
+}
+
+const KernelTable& kernels() {
+    static const KernelTable& selected = [] () -> const KernelTable& {
+        CpuLevel detected = detect_cpu_level();
+        CpuLevel cap = parse_level(std::getenv("BT_KERNELS"), detected);
+        return kernel_table(cap < detected ? cap : detected);
+    }();
+    return selected;
+}
+
+const char* cpu_level_name(CpuLevel level) {
+    switch (level) {
+        case CpuLevel::AVX512: return "avx512";
+        case CpuLevel::AVX2: return "avx2";
+        case CpuLevel::SSE42: return "sse4.2";
+        default: return "scalar";
+    }
+}
+
+} // namespace trading
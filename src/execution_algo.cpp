@@ -0,0 +1,240 @@
+#include "execution_algo.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace trading {
+
+namespace {
+
+constexpr uint64_t NOT_STARTED = std::numeric_limits<uint64_t>::max();
+
+} // namespace
+
+ExecutionAlgos::ExecutionAlgos(TickEngine& engine, uint32_t user_id)
+    : engine_(engine), user_id_(user_id) {}
+
+void ExecutionAlgos::set_volume_profile(const std::vector<double>& profile) {
+    profile_cumulative_.clear();
+    double total = 0.0;
+    for (double v : profile) total += std::max(v, 0.0);
+    if (total <= 0.0) return;
+
+    double running = 0.0;
+    for (double v : profile) {
+        running += std::max(v, 0.0);
+        profile_cumulative_.push_back(running / total);
+    }
+    profile_cumulative_.back() = 1.0;
+}
+
+ParentId ExecutionAlgos::submit(const ParentOrder& parent) {
+    ParentId id = static_cast<ParentId>(quantity_.size());
+    symbol_.push_back(parent.symbol);
+    side_.push_back(parent.side);
+    algo_.push_back(parent.algo);
+    done_.push_back(parent.quantity == 0);
+    quantity_.push_back(parent.quantity);
+    filled_.push_back(0);
+    start_.push_back(parent.start);
+    end_.push_back(std::max(parent.end, parent.start));
+    interval_.push_back(parent.slice_interval ? parent.slice_interval : 1);
+    participation_.push_back(parent.participation);
+    limit_.push_back(parent.limit_price);
+    arrival_.push_back(0);
+    notional_.push_back(0.0);
+    volume_at_start_.push_back(NOT_STARTED);
+    child_.push_back(INVALID_ORDER_HANDLE);
+    children_.push_back(0);
+
+    if (!done_[id]) {
+        ++active_;
+        engine_.schedule_timer(std::max(parent.start, engine_.now()), this, id);
+    }
+    return id;
+}
+
+void ExecutionAlgos::cancel(ParentId id) {
+    if (id < done_.size() && !done_[id]) finish(id);
+}
+
+void ExecutionAlgos::on_tick(const Tick& tick, TickEngine* /*engine*/) {
+    for (OrderHandle handle : retired_) engine_.release_order(handle);
+    retired_.clear();
+
+    SymbolId symbol = SymbolRegistry::instance().register_symbol(tick.symbol);
+    if (symbol >= market_volume_.size()) {
+        market_volume_.resize(symbol + 1, 0);
+        last_tick_price_.resize(symbol + 1, 0);
+    }
+    market_volume_[symbol] += tick.volume;
+    last_tick_price_[symbol] = tick.price;
+}
+
+void ExecutionAlgos::on_timer(uint64_t tag, TickEngine* /*engine*/) {
+    for (OrderHandle handle : retired_) engine_.release_order(handle);
+    retired_.clear();
+
+    ParentId id = static_cast<ParentId>(tag);
+    if (id >= done_.size() || done_[id]) return;
+    Timestamp now = engine_.now();
+
+    if (volume_at_start_[id] == NOT_STARTED) {
+        SymbolId symbol = symbol_[id];
+        volume_at_start_[id] = symbol < market_volume_.size() ? market_volume_[symbol] : 0;
+        const OrderBook* book = engine_.get_order_book(symbol);
+        if (book && book->best_bid() && book->best_ask()) {
+            arrival_[id] = (book->best_bid() + book->best_ask()) / 2;
+        } else {
+            arrival_[id] = last_price(symbol);
+            if (arrival_[id] == 0 && book) {
+                arrival_[id] = book->best_bid() ? book->best_bid() : book->best_ask();  // One-sided book
+            }
+        }
+    }
+
+    pull_child(id);
+    if (now >= end_[id]) {
+        finish(id);
+        return;
+    }
+
+    // Aim for where the schedule should be by the next decision
+    Timestamp next = std::min(now + interval_[id], end_[id]);
+    Quantity target = std::min(target_quantity(id, next), quantity_[id]);
+    if (target > filled_[id]) {
+        send_child(id, target - filled_[id]);
+    }
+    if (!done_[id]) {
+        engine_.schedule_timer(next, this, id);
+    }
+}
+
+void ExecutionAlgos::on_trade(const Trade& trade) {
+    attribute(trade.buy_order_id, trade);
+    attribute(trade.sell_order_id, trade);
+}
+
+void ExecutionAlgos::attribute(OrderHandle handle, const Trade& trade) {
+    ParentId id = NO_PARENT;
+    uint32_t slot = handle_slot(handle);
+    if (slot < owner_.size() && owner_[slot] && child_[owner_[slot] - 1] == handle) {
+        id = owner_[slot] - 1;
+    } else if (sending_ != NO_PARENT && handle == sending_handle_) {
+        id = sending_;  // The child being submitted trades before its handle is returned
+    }
+    if (id == NO_PARENT) return;
+
+    filled_[id] += trade.quantity;
+    notional_[id] += static_cast<double>(trade.price) * static_cast<double>(trade.quantity);
+    if (filled_[id] >= quantity_[id] && !done_[id]) {
+        // The book may still be using the child; release it on the next event
+        done_[id] = 1;
+        --active_;
+        if (child_[id] != INVALID_ORDER_HANDLE) {
+            retired_.push_back(child_[id]);
+            owner_[handle_slot(child_[id])] = 0;
+            child_[id] = INVALID_ORDER_HANDLE;
+        }
+    }
+}
+
+Quantity ExecutionAlgos::target_quantity(ParentId id, Timestamp at) const {
+    if (algo_[id] == ExecutionAlgo::POV) {
+        SymbolId symbol = symbol_[id];
+        uint64_t volume = symbol < market_volume_.size() ? market_volume_[symbol] : 0;
+        return static_cast<Quantity>(participation_[id] *
+                                     static_cast<double>(volume - volume_at_start_[id]));
+    }
+
+    Timestamp horizon = end_[id] - start_[id];
+    Timestamp elapsed = std::min(at, end_[id]) - std::min(at, start_[id]);
+    double fraction = horizon > 0 ? static_cast<double>(elapsed) / static_cast<double>(horizon) : 1.0;
+    if (algo_[id] == ExecutionAlgo::VWAP) {
+        fraction = profile_fraction(fraction);
+    }
+    return static_cast<Quantity>(std::llround(fraction * static_cast<double>(quantity_[id])));
+}
+
+// Piecewise-linear cumulative profile: uniform volume within a bucket
+double ExecutionAlgos::profile_fraction(double elapsed) const {
+    if (profile_cumulative_.empty()) return elapsed;
+    double position = elapsed * static_cast<double>(profile_cumulative_.size());
+    size_t bucket = static_cast<size_t>(position);
+    if (bucket >= profile_cumulative_.size()) return 1.0;
+    double before = bucket > 0 ? profile_cumulative_[bucket - 1] : 0.0;
+    return before + (profile_cumulative_[bucket] - before) * (position - static_cast<double>(bucket));
+}
+
+void ExecutionAlgos::pull_child(ParentId id) {
+    OrderHandle child = child_[id];
+    if (child == INVALID_ORDER_HANDLE) return;
+    owner_[handle_slot(child)] = 0;
+    child_[id] = INVALID_ORDER_HANDLE;
+    engine_.release_order(child);  // Cancels the unfilled rest first
+}
+
+void ExecutionAlgos::send_child(ParentId id, Quantity quantity) {
+    SymbolId symbol = symbol_[id];
+    bool buy = side_[id] == Side::BUY;
+
+    // Cross to the far touch, else the latest price
+    const OrderBook* book = engine_.get_order_book(symbol);
+    Price price = book ? (buy ? book->best_ask() : book->best_bid()) : 0;
+    if (price == 0) price = last_price(symbol);
+    if (limit_[id]) price = buy ? std::min(price, limit_[id]) : std::max(price, limit_[id]);
+    if (price <= 0) return;
+
+    sending_ = id;
+    sending_handle_ = engine_.next_order_handle();
+    OrderHandle handle = engine_.submit_order(
+        Order(0, price, quantity, engine_.now(), side_[id], OrderType::LIMIT, user_id_), symbol);
+    sending_ = NO_PARENT;
+    ++children_[id];
+
+    const Order* order = engine_.find_order(handle);
+    if (!order || !order->is_open() || done_[id]) {
+        engine_.release_order(handle);  // Filled (or rejected) on arrival
+        return;
+    }
+    uint32_t slot = handle_slot(handle);
+    if (slot >= owner_.size()) owner_.resize(slot + 1, 0);
+    owner_[slot] = id + 1;
+    child_[id] = handle;
+}
+
+void ExecutionAlgos::finish(ParentId id) {
+    pull_child(id);
+    done_[id] = 1;
+    --active_;
+}
+
+Price ExecutionAlgos::last_price(SymbolId symbol) const {
+    const OrderBook* book = engine_.get_order_book(symbol);
+    if (book && book->last_trade_price()) return book->last_trade_price();
+    return symbol < last_tick_price_.size() ? last_tick_price_[symbol] : 0;
+}
+
+ExecutionReport ExecutionAlgos::report(ParentId id) const {
+    ExecutionReport r;
+    r.quantity = quantity_[id];
+    r.filled = filled_[id];
+    r.arrival_price = arrival_[id];
+    r.children = children_[id];
+    r.done = done_[id];
+    if (r.filled > 0) {
+        r.average_price = notional_[id] / static_cast<double>(r.filled);
+    }
+    if (r.arrival_price > 0) {
+        double sign = side_[id] == Side::BUY ? 1.0 : -1.0;
+        double arrival = static_cast<double>(r.arrival_price);
+        double executed = notional_[id] - arrival * static_cast<double>(r.filled);
+        double unfilled = static_cast<double>(r.quantity - r.filled);
+        double opportunity = (static_cast<double>(last_price(symbol_[id])) - arrival) * unfilled;
+        r.shortfall = sign * (executed + opportunity);
+        r.shortfall_bps = r.shortfall / (arrival * static_cast<double>(r.quantity)) * 10000.0;
+    }
+    return r;
+}
+
+} // namespace trading
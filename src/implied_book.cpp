@@ -0,0 +1,183 @@
+#include "implied_book.hpp"
+#include <algorithm>
+
+namespace trading {
+
+ImpliedSpread::ImpliedSpread(OrderBook& front, OrderBook& back, OrderBook& spread)
+    : front_(front), back_(back), spread_(spread) {
+    listener_ids_[0] = front_.add_top_listener([this] { recompute(); });
+    listener_ids_[1] = back_.add_top_listener([this] { recompute(); });
+    listener_ids_[2] = spread_.add_top_listener([this] { recompute(); });
+    recompute();
+}
+
+ImpliedSpread::~ImpliedSpread() {
+    front_.remove_top_listener(listener_ids_[0]);
+    back_.remove_top_listener(listener_ids_[1]);
+    spread_.remove_top_listener(listener_ids_[2]);
+}
+
+void ImpliedSpread::recompute() {
+    ++recomputes_;
+    Quantity fb = front_.best_bid_quantity(), fa = front_.best_ask_quantity();
+    Quantity bb = back_.best_bid_quantity(), ba = back_.best_ask_quantity();
+    Quantity sb = spread_.best_bid_quantity(), sa = spread_.best_ask_quantity();
+    
+    // Sell spread = sell front into its bid + buy back from its ask
+    implied_in_.bid_quantity = std::min(fb, ba);
+    implied_in_.bid = front_.best_bid() - back_.best_ask();
+    // Buy spread = buy front from its ask + sell back into its bid
+    implied_in_.ask_quantity = std::min(fa, bb);
+    implied_in_.ask = front_.best_ask() - back_.best_bid();
+    
+    // Front = spread + back; back = front - spread
+    implied_out_front_ = ImpliedQuote{spread_.best_bid() + back_.best_bid(), std::min(sb, bb),
+                                      spread_.best_ask() + back_.best_ask(), std::min(sa, ba)};
+    implied_out_back_ = ImpliedQuote{front_.best_bid() - spread_.best_ask(), std::min(fb, sa),
+                                     front_.best_ask() - spread_.best_bid(), std::min(fa, sb)};
+}
+
+void ImpliedSpread::add_order(Order* order) {
+    if (order->is_stop()) {
+        spread_.add_order(order);
+        return;
+    }
+    
+    bool buy = order->side == Side::BUY;
+    bool market = order->type == OrderType::MARKET;
+    auto reachable = [&](Price price) {
+        return market || (buy ? price <= order->price : price >= order->price);
+    };
+    
+    while (can_trade(order)) {
+        Quantity direct_qty = buy ? spread_.best_ask_quantity() : spread_.best_bid_quantity();
+        Price direct = buy ? spread_.best_ask() : spread_.best_bid();
+        Quantity implied_qty = buy ? implied_in_.ask_quantity : implied_in_.bid_quantity;
+        Price implied = buy ? implied_in_.ask : implied_in_.bid;
+        
+        bool direct_ok = direct_qty > 0 && reachable(direct);
+        bool use_implied = implied_qty > 0 && reachable(implied);
+        if (direct_ok && use_implied) {
+            use_implied = buy ? implied < direct : implied > direct;  // Direct wins ties
+        }
+        
+        // Implied liquidity the user cannot take (own orders at a leg top)
+        // falls through to the direct book
+        if (use_implied && execute_implied(order, implied, std::min(order->remaining(), implied_qty)) > 0) {
+            continue;
+        }
+        if (!direct_ok) break;
+        spread_.sweep(order, direct);
+    }
+    
+    if (can_trade(order)) {
+        spread_.add_order(order);  // Rests a limit remainder; cancels a market one
+    }
+}
+
+void ImpliedSpread::add_outright(Order* order, OrderBook& leg, ImpliedSpread* const* first,
+                                 ImpliedSpread* const* last) {
+    if (order->is_stop()) {
+        leg.add_order(order);
+        return;
+    }
+    
+    bool buy = order->side == Side::BUY;
+    bool market = order->type == OrderType::MARKET;
+    auto reachable = [&](Price price) {
+        return market || (buy ? price <= order->price : price >= order->price);
+    };
+    
+    while (can_trade(order)) {
+        Quantity direct_qty = buy ? leg.best_ask_quantity() : leg.best_bid_quantity();
+        Price direct = buy ? leg.best_ask() : leg.best_bid();
+        
+        // Best implied-out quote over the spreads on this leg (first on ties)
+        ImpliedSpread* best = nullptr;
+        Quantity implied_qty = 0;
+        Price implied = 0;
+        for (ImpliedSpread* const* it = first; it != last; ++it) {
+            const ImpliedQuote& quote = (*it)->implied_out(leg);
+            Quantity qty = buy ? quote.ask_quantity : quote.bid_quantity;
+            Price price = buy ? quote.ask : quote.bid;
+            if (qty > 0 && reachable(price) && (!best || (buy ? price < implied : price > implied))) {
+                best = *it;
+                implied_qty = qty;
+                implied = price;
+            }
+        }
+        
+        bool direct_ok = direct_qty > 0 && reachable(direct);
+        bool use_implied = best != nullptr;
+        if (direct_ok && use_implied) {
+            use_implied = buy ? implied < direct : implied > direct;  // Direct wins ties
+        }
+        
+        if (use_implied &&
+            best->execute_implied_out(order, leg, implied, std::min(order->remaining(), implied_qty)) > 0) {
+            continue;
+        }
+        if (!direct_ok) break;
+        leg.sweep(order, direct);
+    }
+    
+    if (can_trade(order)) {
+        leg.add_order(order);  // Rests a limit remainder; cancels a market one
+    }
+}
+
+Quantity ImpliedSpread::execute_implied(Order* order, Price price, Quantity quantity) {
+    bool buy = order->side == Side::BUY;
+    Quantity filled = send_legs(order, front_, buy ? Side::BUY : Side::SELL,
+                                back_, buy ? Side::SELL : Side::BUY, quantity);
+    record_fill(order, price, filled, spread_);
+    return filled;
+}
+
+Quantity ImpliedSpread::execute_implied_out(Order* order, OrderBook& leg, Price price, Quantity quantity) {
+    Side same = order->side;
+    Side opposite = same == Side::BUY ? Side::SELL : Side::BUY;
+    
+    // Front = spread + back: trade both on the order's side.
+    // Back = front - spread: the order's side on front, the other on the spread.
+    Quantity filled = &leg == &front_ ? send_legs(order, spread_, same, back_, same, quantity)
+                                      : send_legs(order, front_, same, spread_, opposite, quantity);
+    record_fill(order, price, filled, leg);
+    return filled;
+}
+
+Quantity ImpliedSpread::send_legs(Order* order, OrderBook& first, Side first_side, OrderBook& second,
+                                  Side second_side, Quantity quantity) {
+    auto taken = [](Side side) { return side == Side::BUY ? Side::SELL : Side::BUY; };
+    
+    // Both legs must fill in full: cap to what each top executes for this
+    // user, so self-trade prevention cannot trim one leg and leave the other
+    quantity = std::min({quantity, first.executable_top(taken(first_side), order->user_id),
+                         second.executable_top(taken(second_side), order->user_id)});
+    if (quantity == 0) return 0;
+    
+    // Leg orders carry the original order's id and user so trades resolve to it.
+    // Market legs fill at the top level: quantity never exceeds either top.
+    Order first_leg(order->id, 0, quantity, order->timestamp, first_side, OrderType::MARKET, order->user_id);
+    first.add_order(&first_leg);
+    if (first_leg.filled == 0) return 0;
+    
+    Order second_leg(order->id, 0, first_leg.filled, order->timestamp, second_side, OrderType::MARKET,
+                     order->user_id);
+    second.add_order(&second_leg);
+    return std::min(first_leg.filled, second_leg.filled);
+}
+
+void ImpliedSpread::record_fill(Order* order, Price price, Quantity filled, const OrderBook& book) {
+    if (filled == 0) return;
+    order->filled += filled;
+    order->status = order->filled >= order->quantity ? OrderStatus::FILLED : OrderStatus::PARTIAL;
+    ++implied_fills_;
+    
+    if (trade_callback_) {
+        bool buy = order->side == Side::BUY;
+        trade_callback_(Trade{buy ? order->id : 0, buy ? 0 : order->id, price, filled, order->timestamp}, book);
+    }
+}
+
+} // namespace trading
@@ -0,0 +1,335 @@
+#include "l3_replay.hpp"
+#include <algorithm>
+#include <deque>
+
+namespace trading {
+
+L3Replay::L3Replay(const std::string& symbol, uint32_t historical_user)
+    : book_(symbol), historical_user_(historical_user) {
+    book_.set_trade_callback([this](const Trade& trade) { on_trade(trade); });
+    remaining_.resize(pool_.capacity(), 0);
+    historical_.resize(pool_.capacity(), 0);
+    book_.enable_order_index(pool_.capacity());
+}
+
+void L3Replay::replay(const L3Message* messages, size_t count) {
+    for (size_t i = 0; i < count; ++i) apply(messages[i]);
+}
+
+void L3Replay::apply(const L3Message& message) {
+    now_ = message.timestamp;
+    ++stats_.messages;
+
+    switch (message.type) {
+        case L3MessageType::ADD:
+            add(message.order_id, message.side, message.price, message.quantity);
+            break;
+        case L3MessageType::CANCEL:
+            reduce(message.order_id, message.quantity, false);
+            break;
+        case L3MessageType::DELETE:
+            reduce(message.order_id, std::numeric_limits<Quantity>::max(), false);
+            break;
+        case L3MessageType::EXECUTE:
+            reduce(message.order_id, message.quantity, true);
+            break;
+        case L3MessageType::REPLACE: {
+            OrderHandle handle = ids_.find(message.order_id);
+            if (handle == INVALID_ORDER_HANDLE) {
+                ++stats_.unknown_orders;
+                break;
+            }
+            Side side = pool_.at(handle_slot(handle))->side;
+            reduce(message.order_id, std::numeric_limits<Quantity>::max(), false);
+            add(message.new_order_id, side, message.price, message.quantity);
+            break;
+        }
+    }
+}
+
+void L3Replay::add(uint64_t venue_id, Side side, Price price, Quantity quantity) {
+    if (ids_.find(venue_id) != INVALID_ORDER_HANDLE) {
+        reduce(venue_id, std::numeric_limits<Quantity>::max(), false);  // Reused id
+    }
+
+    size_t slot = allocate_slot();
+    OrderHandle handle = make_order_handle(static_cast<uint32_t>(slot), pool_.generation(slot));
+    Order* order = pool_.at(slot);
+    *order = Order(handle, price, quantity, now_, side, OrderType::LIMIT, historical_user_);
+    remaining_[slot] = quantity;
+    historical_[slot] = 1;
+    ids_.insert(venue_id, handle);
+
+    // Can only cross strategy orders (the feed's own book never crosses);
+    // on_trade() books what it takes as ghost
+    book_.add_order(order);
+}
+
+void L3Replay::reduce(uint64_t venue_id, Quantity quantity, bool executed) {
+    OrderHandle handle = ids_.find(venue_id);
+    if (handle == INVALID_ORDER_HANDLE) {
+        ++stats_.unknown_orders;
+        return;
+    }
+    uint32_t slot = handle_slot(handle);
+    Order* order = pool_.at(slot);
+    Quantity ghost_before = remaining_[slot] - book_remaining(*order);
+    quantity = std::min(quantity, remaining_[slot]);
+    remaining_[slot] -= quantity;
+
+    if (executed) {
+        // Ghost absorbs the execution first: the strategy already took it
+        Quantity rest = quantity - std::min(quantity, ghost_before);
+        if (rest > 0 && order->is_open()) {
+            Side side = order->side == Side::BUY ? Side::SELL : Side::BUY;
+            Order aggressor(INVALID_ORDER_HANDLE, order->price, rest, now_, side,
+                            OrderType::LIMIT, historical_user_);
+            executing_ = slot;
+            book_.sweep(&aggressor, order->price);
+            executing_ = NOT_EXECUTING;
+        }
+    }
+
+    // Never leave more in the book than the feed has open
+    Quantity target = remaining_[slot];
+    if (book_remaining(*order) > target) {
+        if (target == 0) {
+            book_.cancel_order(order);
+        } else {
+            book_.modify_order(order, order->price, order->filled + target);  // Keeps priority
+        }
+    }
+
+    Quantity ghost_after = remaining_[slot] - book_remaining(*order);
+    ghost_ -= ghost_before - ghost_after;
+    stats_.ghost_reconciled += ghost_before - ghost_after;
+
+    if (remaining_[slot] == 0) retire(venue_id, handle);
+}
+
+void L3Replay::retire(uint64_t venue_id, OrderHandle handle) {
+    uint32_t slot = handle_slot(handle);
+    book_.cancel_order(pool_.at(slot));  // No-op unless still resting
+    ids_.erase(venue_id);
+    historical_[slot] = 0;
+    pool_.release(slot);
+}
+
+void L3Replay::on_trade(const Trade& trade) {
+    track_ghost(trade.buy_order_id, trade.quantity);
+    track_ghost(trade.sell_order_id, trade.quantity);
+    if (trade_callback_) trade_callback_(trade);
+}
+
+void L3Replay::track_ghost(OrderId id, Quantity quantity) {
+    uint32_t slot = handle_slot(id);
+    if (id == INVALID_ORDER_HANDLE || slot >= pool_.capacity() ||
+        pool_.generation(slot) != handle_generation(id)) {
+        return;  // Replayed aggressor
+    }
+    if (!historical_[slot]) {
+        stats_.strategy_volume += quantity;
+    } else if (slot != executing_) {
+        // Historical quantity that traded without the feed saying so
+        ghost_ += quantity;
+        stats_.ghost_created += quantity;
+    }
+}
+
+size_t L3Replay::allocate_slot() {
+    size_t slot = pool_.allocate_slot();
+    if (remaining_.size() < pool_.capacity()) {
+        remaining_.resize(pool_.capacity(), 0);
+        historical_.resize(pool_.capacity(), 0);
+        book_.enable_order_index(pool_.capacity());
+    }
+    return slot;
+}
+
+Order* L3Replay::live(OrderHandle handle) {
+    uint32_t slot = handle_slot(handle);
+    if (slot >= pool_.capacity() || pool_.generation(slot) != handle_generation(handle)) {
+        return nullptr;
+    }
+    return pool_.at(slot);
+}
+
+OrderHandle L3Replay::submit_order(const Order& order_template) {
+    size_t slot = allocate_slot();
+    OrderHandle handle = make_order_handle(static_cast<uint32_t>(slot), pool_.generation(slot));
+    Order* order = pool_.at(slot);
+    *order = order_template;
+    order->id = handle;
+    order->timestamp = now_;
+    remaining_[slot] = 0;
+    historical_[slot] = 0;
+    ++stats_.strategy_orders;
+    book_.add_order(order);
+    return handle;
+}
+
+bool L3Replay::cancel_order(OrderHandle handle) {
+    Order* order = live(handle);
+    if (!order || historical_[handle_slot(handle)]) return false;
+    return book_.cancel_order(order);
+}
+
+const Order* L3Replay::find_order(OrderHandle handle) const {
+    uint32_t slot = handle_slot(handle);
+    if (slot >= pool_.capacity() || pool_.generation(slot) != handle_generation(handle)) {
+        return nullptr;
+    }
+    return pool_.at(slot);
+}
+
+void L3Replay::release_order(OrderHandle handle) {
+    if (!is_strategy_order(handle)) return;
+    cancel_order(handle);  // Never recycle a slot the book still points at
+    pool_.release(handle_slot(handle));
+}
+
+bool L3Replay::is_strategy_order(OrderId id) const {
+    uint32_t slot = handle_slot(id);
+    return id != INVALID_ORDER_HANDLE && slot < pool_.capacity() &&
+           pool_.generation(slot) == handle_generation(id) && !historical_[slot];
+}
+
+Quantity L3Replay::ghost(uint64_t venue_id) const {
+    OrderHandle handle = ids_.find(venue_id);
+    if (handle == INVALID_ORDER_HANDLE) return 0;
+    uint32_t slot = handle_slot(handle);
+    return remaining_[slot] - book_remaining(*pool_.at(slot));
+}
+
+OrderHandle L3Replay::VenueIdMap::find(uint64_t id) const {
+    size_t mask = entries_.size() - 1;
+    for (size_t i = home(id);; i = (i + 1) & mask) {
+        const Entry& e = entries_[i];
+        if (e.handle == INVALID_ORDER_HANDLE) return INVALID_ORDER_HANDLE;
+        if (e.id == id) return e.handle;
+    }
+}
+
+void L3Replay::VenueIdMap::insert(uint64_t id, OrderHandle handle) {
+    if ((size_ + 1) * 2 > entries_.size()) grow();
+    size_t mask = entries_.size() - 1;
+    size_t i = home(id);
+    while (entries_[i].handle != INVALID_ORDER_HANDLE && entries_[i].id != id) {
+        i = (i + 1) & mask;
+    }
+    if (entries_[i].handle == INVALID_ORDER_HANDLE) ++size_;
+    entries_[i] = Entry{id, handle};
+}
+
+void L3Replay::VenueIdMap::erase(uint64_t id) {
+    size_t mask = entries_.size() - 1;
+    size_t i = home(id);
+    while (entries_[i].id != id || entries_[i].handle == INVALID_ORDER_HANDLE) {
+        if (entries_[i].handle == INVALID_ORDER_HANDLE) return;
+        i = (i + 1) & mask;
+    }
+
+    // Backward shift: pull later members of the probe run into the hole
+    // unless their home lies cyclically within (hole, j]
+    for (size_t j = (i + 1) & mask; entries_[j].handle != INVALID_ORDER_HANDLE; j = (j + 1) & mask) {
+        size_t k = home(entries_[j].id);
+        bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays) {
+            entries_[i] = entries_[j];
+            i = j;
+        }
+    }
+    entries_[i] = Entry{};
+    --size_;
+}
+
+void L3Replay::VenueIdMap::grow() {
+    std::vector<Entry> old(entries_.size() * 2);
+    old.swap(entries_);
+    size_ = 0;
+    for (const Entry& e : old) {
+        if (e.handle != INVALID_ORDER_HANDLE) insert(e.id, e.handle);
+    }
+}
+
+std::vector<L3Message> record_l3_feed(const BookOpGenerator::Config& config, size_t ops) {
+    BookOpGenerator generator(config);
+    OrderBook book("L3-REFERENCE");
+    std::deque<Order> orders;          // By generator ref (Order::id = ref)
+    std::vector<uint64_t> venue_ids;   // Ref -> current venue id; REPLACE renumbers
+    uint64_t next_venue_id = ops;      // Refs are below `ops`
+    std::vector<L3Message> feed;
+    Timestamp now = 0;
+    const Order* aggressor = nullptr;
+
+    book.set_trade_callback([&](const Trade& t) {
+        OrderId passive = t.buy_order_id == aggressor->id ? t.sell_order_id : t.buy_order_id;
+        L3Message m;
+        m.timestamp = now;
+        m.order_id = venue_ids[passive];
+        m.type = L3MessageType::EXECUTE;
+        m.side = orders[passive].side;
+        m.price = t.price;
+        m.quantity = t.quantity;
+        feed.push_back(m);
+    });
+
+    for (size_t step = 0; step < ops; ++step) {
+        now = step;
+        BookOp op = generator.next();
+        L3Message m;
+        m.timestamp = now;
+
+        if (op.type == BookOpType::ADD || op.type == BookOpType::MARKET) {
+            bool market = op.type == BookOpType::MARKET;
+            orders.emplace_back(op.ref, op.price, op.quantity, now, op.side,
+                                market ? OrderType::MARKET : OrderType::LIMIT, op.user_id);
+            venue_ids.push_back(op.ref);
+            Order& order = orders.back();
+            aggressor = &order;
+            book.add_order(&order);
+            if (!market && order.is_open()) {
+                m.order_id = op.ref;
+                m.type = L3MessageType::ADD;
+                m.side = order.side;
+                m.price = order.price;
+                m.quantity = order.remaining();
+                feed.push_back(m);
+            }
+            continue;
+        }
+
+        Order& order = orders[op.ref];
+        if (!order.is_open()) continue;
+        m.order_id = venue_ids[op.ref];
+        m.side = order.side;
+
+        if (op.type == BookOpType::CANCEL) {
+            book.cancel_order(&order);
+            m.type = L3MessageType::DELETE;
+            feed.push_back(m);
+        } else if (op.price == order.price && op.quantity < order.remaining()) {
+            m.type = L3MessageType::CANCEL;
+            m.quantity = order.remaining() - op.quantity;
+            book.modify_order(&order, order.price, order.filled + op.quantity);
+            feed.push_back(m);
+        } else {
+            // Loses priority and may trade on re-entry, like a venue replace
+            aggressor = &order;
+            book.modify_order(&order, op.price, order.filled + op.quantity);
+            if (order.is_open()) {
+                m.type = L3MessageType::REPLACE;
+                m.new_order_id = next_venue_id++;
+                m.price = order.price;
+                m.quantity = order.remaining();
+                venue_ids[op.ref] = m.new_order_id;
+            } else {
+                m.type = L3MessageType::DELETE;  // Filled on re-entry
+            }
+            feed.push_back(m);
+        }
+    }
+    return feed;
+}
+
+} // namespace trading
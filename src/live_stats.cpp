@@ -0,0 +1,91 @@
+#include "live_stats.hpp"
+#include <chrono>
+#include <new>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace trading {
+
+LiveStatsRegion LiveStatsRegion::create(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("shm_open failed for " + name);
+    }
+    if (ftruncate(fd, sizeof(LiveStatsSegment)) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("ftruncate failed for " + name);
+    }
+    void* mem = mmap(nullptr, sizeof(LiveStatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("mmap failed for " + name);
+    }
+
+    auto* segment = new (mem) LiveStatsSegment();
+    segment->max_threads = LiveStatsSegment::MAX_THREADS;
+    segment->segment_size = sizeof(LiveStatsSegment);
+    segment->pid.store(static_cast<uint64_t>(getpid()), std::memory_order_relaxed);
+    segment->start_ns.store(now_ns(), std::memory_order_relaxed);
+    segment->threads_in_use.store(0, std::memory_order_relaxed);
+    segment->version = LiveStatsSegment::VERSION;
+    // Magic last, so readers never accept a half-initialized segment
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = LiveStatsSegment::MAGIC;
+
+    return LiveStatsRegion(segment, name, true);
+}
+
+LiveStatsRegion LiveStatsRegion::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("No live stats segment named " + name);
+    }
+    void* mem = mmap(nullptr, sizeof(LiveStatsSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        throw std::runtime_error("mmap failed for " + name);
+    }
+
+    auto* segment = static_cast<LiveStatsSegment*>(mem);
+    if (segment->magic != LiveStatsSegment::MAGIC ||
+        segment->version != LiveStatsSegment::VERSION ||
+        segment->segment_size != sizeof(LiveStatsSegment)) {
+        munmap(mem, sizeof(LiveStatsSegment));
+        throw std::runtime_error("Incompatible live stats segment " + name);
+    }
+    return LiveStatsRegion(segment, name, false);
+}
+
+LiveStatsRegion::LiveStatsRegion(LiveStatsRegion&& other) noexcept
+    : segment_(other.segment_), name_(std::move(other.name_)), owner_(other.owner_) {
+    other.segment_ = nullptr;
+    other.owner_ = false;
+}
+
+LiveStatsRegion::~LiveStatsRegion() {
+    if (!segment_) return;
+    munmap(segment_, sizeof(LiveStatsSegment));
+    if (owner_) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+LiveThreadStats* LiveStatsRegion::claim_thread_slot() {
+    uint32_t index = segment_->threads_in_use.fetch_add(1, std::memory_order_acq_rel);
+    if (index >= LiveStatsSegment::MAX_THREADS) {
+        segment_->threads_in_use.fetch_sub(1, std::memory_order_acq_rel);
+        return nullptr;
+    }
+    return &segment_->threads[index];
+}
+
+uint64_t LiveStatsRegion::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace trading
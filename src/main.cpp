@@ -1,10 +1,16 @@
 #include "tick_engine.hpp"
 #include "../strategies/momentum_strategy.hpp"
+#include "cpu_dispatch.hpp"
+#include "agent_sim.hpp"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
-#include <sstream>
+#include <iterator>
+#include <string_view>
+#include <charconv>
 #include <vector>
 #include <random>
+#include <chrono>
 
 using namespace trading;
 
@@ -39,40 +45,78 @@ std::vector<Tick> generate_synthetic_ticks(size_t count) {
     return ticks;
 }
 
-// Load ticks from CSV
+// Parse a decimal price like "150.25" straight to fixed-point (4 decimals)
+Price parse_price(std::string_view text) {
+    Price whole = 0;
+    Price frac = 0;
+    int frac_digits = 0;
+    bool negative = !text.empty() && text.front() == '-';
+    size_t i = negative ? 1 : 0;
+    
+    for (; i < text.size() && text[i] != '.'; ++i) {
+        whole = whole * 10 + (text[i] - '0');
+    }
+    for (++i; i < text.size() && frac_digits < 4; ++i, ++frac_digits) {
+        frac = frac * 10 + (text[i] - '0');
+    }
+    for (; frac_digits < 4; ++frac_digits) {
+        frac *= 10;
+    }
+    
+    Price value = whole * 10000 + frac;
+    return negative ? -value : value;
+}
+
+template<typename Int>
+Int parse_int(std::string_view text) {
+    Int value = 0;
+    std::from_chars(text.data(), text.data() + text.size(), value);
+    return value;
+}
+
+// Load ticks from CSV. Fields are split with the dispatched find_byte kernel
+// rather than iostreams, which dominate load time on multi-GB files.
 std::vector<Tick> load_ticks_from_csv(const std::string& filename) {
     std::vector<Tick> ticks;
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary);
     
     if (!file.is_open()) {
         std::cerr << "Could not open " << filename << ", using synthetic data\n";
         return generate_synthetic_ticks(1000000);
     }
     
-    std::string line;
-    std::getline(file, line); // Skip header
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const auto& k = kernels();
+    const char* p = data.data();
+    const char* end = p + data.size();
+    
+    // Skip header
+    p += k.find_byte(p, end - p, '\n');
+    if (p < end) ++p;
     
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string symbol, side_str;
-        double price;
-        int64_t volume, timestamp;
+    while (p < end) {
+        const char* eol = p + k.find_byte(p, end - p, '\n');
+        std::string_view fields[5];
+        size_t count = 0;
         
-        if (std::getline(ss, symbol, ',') &&
-            ss >> timestamp && ss.ignore() &&
-            ss >> price && ss.ignore() &&
-            ss >> volume && ss.ignore() &&
-            std::getline(ss, side_str)) {
-            
-            Tick tick{
-                symbol,
-                static_cast<Price>(price * 10000),
-                volume,
-                static_cast<Timestamp>(timestamp),
-                side_str == "BUY" ? Side::BUY : Side::SELL
-            };
-            ticks.push_back(tick);
+        for (const char* f = p; count < 5 && f <= eol; ++count) {
+            const char* comma = f + k.find_byte(f, eol - f, ',');
+            fields[count] = std::string_view(f, comma - f);
+            f = comma + 1;
         }
+        p = eol + 1;
+        
+        if (count < 5) continue;
+        if (!fields[4].empty() && fields[4].back() == '\r') fields[4].remove_suffix(1);
+        
+        Tick tick{
+            std::string(fields[0]),
+            parse_price(fields[2]),
+            parse_int<Quantity>(fields[3]),
+            parse_int<Timestamp>(fields[1]),
+            fields[4] == "BUY" ? Side::BUY : Side::SELL
+        };
+        ticks.push_back(tick);
     }
     
     return ticks;
@@ -80,11 +124,38 @@ std::vector<Tick> load_ticks_from_csv(const std::string& filename) {
 
 int main(int argc, char** argv) {
     std::cout << "=== C++ Quantitative Trading Backtester ===\n\n";
+    std::cout << "SIMD kernels: " << kernels().name << "\n";
+    
+    // Usage: backtester [ticks.csv] [--live-stats /segment-name] [--agents N]
+    std::string csv_path;
+    std::string live_stats_name;
+    size_t agents = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--live-stats" && i + 1 < argc) {
+            live_stats_name = argv[++i];
+        } else if (arg == "--agents" && i + 1 < argc) {
+            agents = std::stoull(argv[++i]);
+        } else {
+            csv_path = arg;
+        }
+    }
     
     // Load or generate tick data
     std::vector<Tick> ticks;
-    if (argc > 1) {
-        ticks = load_ticks_from_csv(argv[1]);
+    if (!csv_path.empty()) {
+        ticks = load_ticks_from_csv(csv_path);
+    } else if (agents > 0) {
+        // Endogenous order flow: 90% noise traders, 9% momentum, 1% makers
+        AgentSimConfig config;
+        config.symbol = "AAPL";
+        config.market_makers = std::max<size_t>(agents / 100, 1);
+        config.momentum_agents = agents * 9 / 100;
+        config.noise_agents = agents - config.market_makers - config.momentum_agents;
+        config.threads = 0;
+        std::cout << "Simulating " << agents << " agents...\n";
+        AgentSimulator sim(config);
+        sim.run(1000, &ticks);
     } else {
         std::cout << "Generating 1M synthetic ticks...\n";
         ticks = generate_synthetic_ticks(1000000);
@@ -97,6 +168,13 @@ int main(int argc, char** argv) {
     engine.add_strategy(std::make_unique<MomentumStrategy>(20));
     engine.add_strategy(std::make_unique<MarketMakerStrategy>(50));
     
+    std::unique_ptr<LiveStatsRegion> live_stats;
+    if (!live_stats_name.empty()) {
+        live_stats = std::make_unique<LiveStatsRegion>(LiveStatsRegion::create(live_stats_name));
+        engine.enable_live_stats(*live_stats);
+        std::cout << "Live stats: run ./build/bt-top " << live_stats_name << "\n";
+    }
+    
     std::cout << "Running backtest...\n";
     auto start = std::chrono::high_resolution_clock::now();
     
@@ -115,6 +193,7 @@ int main(int argc, char** argv) {
     std::cout << "Throughput:         " << (stats.ticks_processed * 1000.0 / duration.count()) 
               << " ticks/sec\n";
     std::cout << "Avg latency:        " << stats.avg_latency_us() << " µs/tick\n";
+    std::cout << "Run fingerprint:    0x" << std::hex << stats.fingerprint << std::dec << "\n";
     
     return 0;
 }
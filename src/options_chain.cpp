@@ -0,0 +1,54 @@
+#include "options_chain.hpp"
+#include "cpu_dispatch.hpp"
+#include <algorithm>
+
+namespace trading {
+
+namespace {
+
+constexpr double YEARS_PER_NS = 1.0 / (365.25 * 86400.0 * 1e9);
+// Floors keep d1 finite at and after expiry and for zero vol
+constexpr double MIN_TIME = 1e-10;
+constexpr double MIN_VOL = 1e-6;
+
+} // namespace
+
+OptionChain::OptionChain(SymbolId underlying, double rate)
+    : underlying_(underlying), rate_(rate) {}
+
+size_t OptionChain::add_option(Price strike, Timestamp expiry, OptionRight right, double volatility) {
+    strike_.push_back(static_cast<double>(strike));
+    expiry_.push_back(expiry);
+    vol_.push_back(volatility);
+    sign_.push_back(right == OptionRight::CALL ? 1.0 : -1.0);
+    time_.push_back(MIN_TIME);
+    vol_input_.push_back(MIN_VOL);
+    value_.push_back(0.0);
+    delta_.push_back(0.0);
+    gamma_.push_back(0.0);
+    vega_.push_back(0.0);
+    return strike_.size() - 1;
+}
+
+void OptionChain::update(Price spot, Timestamp now) {
+    spot_ = spot;
+    updated_at_ = now;
+    ++updates_;
+
+    const size_t n = strike_.size();
+    const Timestamp* expiry = expiry_.data();
+    const double* vol = vol_.data();
+    double* time = time_.data();
+    double* vol_input = vol_input_.data();
+    for (size_t i = 0; i < n; ++i) {
+        double remaining = expiry[i] > now ? static_cast<double>(expiry[i] - now) : 0.0;
+        time[i] = std::max(remaining * YEARS_PER_NS, MIN_TIME);
+        vol_input[i] = std::max(vol[i], MIN_VOL);
+    }
+
+    OptionBatch batch{strike_.data(), time, vol_input, sign_.data(),
+                      value_.data(), delta_.data(), gamma_.data(), vega_.data()};
+    kernels().black_scholes_f64(static_cast<double>(spot), rate_, batch, n);
+}
+
+} // namespace trading
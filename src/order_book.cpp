@@ -1,127 +1,537 @@
 #include "order_book.hpp"
+#include "cpu_dispatch.hpp"
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
 
 namespace trading {
 
-OrderBook::OrderBook(const std::string& symbol) : symbol_(symbol) {}
+template<typename Allocation>
+BasicOrderBook<Allocation>::BasicOrderBook(const std::string& symbol, SymbolId symbol_id)
+    : symbol_(symbol), symbol_id_(symbol_id) {}
 
-void OrderBook::add_order(Order* order) {
-    if (order->type == OrderType::MARKET) {
+template<typename Allocation>
+void BasicOrderBook<Allocation>::add_order(Order* order) {
+    enter_order(order);
+    publish_top();
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::add_orders(Order* const* orders, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        enter_order(orders[i]);
+    }
+    publish_top();
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::enter_order(Order* order) {
+    last_update_ = order->timestamp;
+    
+    if (order->is_stop()) {
+        if (order->side == Side::BUY) {
+            buy_stops_[order->stop_price].push_back(order);
+        } else {
+            sell_stops_[order->stop_price].push_back(order);
+        }
+        ++pending_stops_;
+    } else {
+        place_order(order);
+    }
+    
+    trigger_stops();
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::place_order(Order* order) {
+    if (phase_ == TradingPhase::AUCTION) {
+        if (order->type == OrderType::MARKET) {
+            auto& level = order->side == Side::BUY ? market_bids_ : market_asks_;
+            level.orders.push_back(order);
+            level.total_quantity += order->remaining();
+            return;
+        }
+    } else if (order->type == OrderType::MARKET) {
         process_market_order(order);
         return;
     }
     
-    match_order(order);
+    if (phase_ == TradingPhase::CONTINUOUS) {
+        match_order(order);
+    }
     
     // Add remaining quantity to book
-    if (order->status != OrderStatus::FILLED) {
+    if (order->is_open()) {
         if (order->side == Side::BUY) {
-            auto& level = bids_[order->price];
-            level.price = order->price;
-            level.orders.push_back(order);
-            level.total_quantity += (order->quantity - order->filled);
+            rest_order(bids_, bid_total_, order);
         } else {
-            auto& level = asks_[order->price];
-            level.price = order->price;
-            level.orders.push_back(order);
-            level.total_quantity += (order->quantity - order->filled);
+            rest_order(asks_, ask_total_, order);
+        }
+    }
+}
+
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::rest_order(Levels& levels, Quantity& side_total, Order* order) {
+    auto [it, created] = levels.try_emplace(order->price);
+    auto& level = it->second;
+    level.price = order->price;
+    level.orders.push_back(order);
+    level.total_quantity += order->remaining();
+    side_total += order->remaining();
+    if (!order_index_.empty()) {
+        uint32_t slot = handle_slot(order->id);
+        if (slot < order_index_.size()) order_index_[slot] = {order, std::prev(level.orders.end())};
+    }
+    
+    if (created) {
+        level_inserted(levels, it);
+    } else {
+        level_changed(levels, it, order->remaining());
+    }
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::trigger_stops() {
+    if (pending_stops_ == 0 || phase_ != TradingPhase::CONTINUOUS || last_trade_price_ == 0) return;
+    
+    // Elected stops can trade and move the price through further stops, so
+    // repeat until a pass elects nothing. Each pass pops only the crossed
+    // prefix of each index: buy stops at or below the last trade, sell stops
+    // at or above it.
+    std::vector<Order*> elected;
+    while (true) {
+        elected.clear();
+        auto elect = [&](auto& stops) {
+            while (!stops.empty() && !stops.key_comp()(last_trade_price_, stops.begin()->first)) {
+                auto& queue = stops.begin()->second;
+                elected.insert(elected.end(), queue.begin(), queue.end());
+                pending_stops_ -= queue.size();
+                stops.erase(stops.begin());
+            }
+        };
+        elect(buy_stops_);
+        elect(sell_stops_);
+        if (elected.empty()) break;
+        
+        for (Order* order : elected) {
+            order->type = order->type == OrderType::STOP ? OrderType::MARKET : OrderType::LIMIT;
+            place_order(order);
+        }
+    }
+}
+
+template<typename Allocation>
+bool BasicOrderBook<Allocation>::cancel_order(Order* order) {
+    if (order->status == OrderStatus::FILLED || order->status == OrderStatus::CANCELLED) {
+        return false;
+    }
+    
+    if (order->is_stop()) {
+        if (!(order->side == Side::BUY ? remove_stop(buy_stops_, order)
+                                       : remove_stop(sell_stops_, order))) {
+            return false;
+        }
+        order->status = OrderStatus::CANCELLED;
+        return true;
+    }
+    
+    if (order->type == OrderType::MARKET) {
+        // Only auction market orders ever rest
+        auto& level = order->side == Side::BUY ? market_bids_ : market_asks_;
+        auto pos = std::find(level.orders.begin(), level.orders.end(), order);
+        if (pos == level.orders.end()) return false;
+        level.total_quantity -= order->remaining();
+        level.orders.erase(pos);
+        order->status = OrderStatus::CANCELLED;
+        return true;
+    }
+    
+    bool removed = (order->side == Side::BUY) ? remove_from_level(bids_, order)
+                                              : remove_from_level(asks_, order);
+    if (removed) {
+        (order->side == Side::BUY ? bid_total_ : ask_total_) -= order->remaining();
+        order->status = OrderStatus::CANCELLED;
+        publish_top();
+    }
+    return removed;
+}
+
+template<typename Allocation>
+bool BasicOrderBook<Allocation>::modify_order(Order* order, Price new_price, Quantity new_quantity) {
+    if (order->status == OrderStatus::FILLED || order->status == OrderStatus::CANCELLED) {
+        return false;
+    }
+    if (new_quantity <= order->filled) {
+        return cancel_order(order);
+    }
+    
+    if (!order->is_stop() && new_price == order->price && new_quantity <= order->quantity) {
+        auto shrink = [&](auto& levels, Quantity& side_total) {
+            auto it = levels.find(order->price);
+            if (it == levels.end()) return false;
+            Quantity delta = order->quantity - new_quantity;
+            it->second.total_quantity -= delta;
+            side_total -= delta;
+            order->quantity = new_quantity;
+            level_changed(levels, it, -delta);
+            return true;
+        };
+        if (!(order->side == Side::BUY ? shrink(bids_, bid_total_) : shrink(asks_, ask_total_))) {
+            return false;
         }
+        publish_top();
+        return true;
     }
+    
+    if (!cancel_order(order)) return false;
+    order->price = new_price;
+    order->quantity = new_quantity;
+    order->status = order->filled > 0 ? OrderStatus::PARTIAL : OrderStatus::PENDING;
+    add_order(order);
+    return true;
 }
 
-void OrderBook::cancel_order(OrderId order_id) {
-    // Simplified: In production, maintain order_id -> order* map
+template<typename Allocation>
+template<typename Levels>
+bool BasicOrderBook<Allocation>::remove_from_level(Levels& levels, Order* order) {
+    auto it = levels.find(order->price);
+    if (it == levels.end()) return false;
+    
+    auto& level = it->second;
+    std::list<Order*>::iterator pos;
+    if (IndexEntry* entry = indexed(order)) {
+        pos = entry->position;
+        entry->order = nullptr;
+    } else {
+        pos = std::find(level.orders.begin(), level.orders.end(), order);
+        if (pos == level.orders.end()) return false;
+    }
+    
+    level.total_quantity -= order->remaining();
+    level.orders.erase(pos);
+    level_changed(levels, it, -order->remaining());
+    if (level.orders.empty()) {
+        level_erasing(levels, it);
+        levels.erase(it);
+    }
+    return true;
+}
+
+template<typename Allocation>
+template<typename Stops>
+bool BasicOrderBook<Allocation>::remove_stop(Stops& stops, Order* order) {
+    auto it = stops.find(order->stop_price);
+    if (it == stops.end()) return false;
+    
+    auto pos = std::find(it->second.begin(), it->second.end(), order);
+    if (pos == it->second.end()) return false;
+    
+    it->second.erase(pos);
+    if (it->second.empty()) {
+        stops.erase(it);
+    }
+    --pending_stops_;
+    return true;
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::sweep(Order* order, Price limit) {
+    last_update_ = order->timestamp;
+    
+    Price price = order->price;
+    OrderType type = order->type;
+    order->price = limit;
+    order->type = OrderType::LIMIT;
+    match_order(order);
+    order->price = price;
+    order->type = type;
+    
+    trigger_stops();
+    publish_top();
 }
 
-void OrderBook::process_market_order(Order* order) {
+template<typename Allocation>
+void BasicOrderBook<Allocation>::process_market_order(Order* order) {
     match_order(order);
     if (order->status != OrderStatus::FILLED) {
         order->status = OrderStatus::CANCELLED; // No liquidity
     }
 }
 
-void OrderBook::match_order(Order* order) {
+template<typename Allocation>
+void BasicOrderBook<Allocation>::match_order(Order* order) {
     if (order->side == Side::BUY) {
-        // Match against asks
-        while (order->filled < order->quantity && !asks_.empty()) {
-            auto it = asks_.begin();
-            auto& level = it->second;
+        match_side(asks_, ask_total_, order);
+    } else {
+        match_side(bids_, bid_total_, order);
+    }
+    
+    if (order->status == OrderStatus::CANCELLED) return;  // Self-trade prevention
+    order->status = (order->filled >= order->quantity) ? 
+                    OrderStatus::FILLED : 
+                    (order->filled > 0 ? OrderStatus::PARTIAL : OrderStatus::PENDING);
+}
+
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::match_side(Levels& levels, Quantity& side_total, Order* order) {
+    while (can_trade(order) && !levels.empty()) {
+        auto it = levels.begin();
+        auto& level = it->second;
+        
+        // Check price compatibility
+        if (order->type == OrderType::LIMIT && levels.key_comp()(order->price, level.price)) {
+            break;
+        }
         
-            // Check price compatibility
-            if (order->type == OrderType::LIMIT) {
-                if (order->price < level.price) break;
+        auto fill = [&](Order* contra_order, Quantity trade_qty) {
+            if (stp_ != SelfTradePrevention::NONE && contra_order->user_id == order->user_id) [[unlikely]] {
+                prevent_self_trade(order, contra_order, level.total_quantity, side_total);
+                return;
             }
             
-            while (!level.orders.empty() && order->filled < order->quantity) {
-                Order* contra_order = level.orders.front();
-                Quantity trade_qty = std::min(
-                    order->quantity - order->filled,
-                    contra_order->quantity - contra_order->filled
-                );
-                
+            if (order->side == Side::BUY) {
                 execute_trade(order, contra_order, level.price, trade_qty);
-                
-                order->filled += trade_qty;
-                contra_order->filled += trade_qty;
-                level.total_quantity -= trade_qty;
-                
-                if (contra_order->filled >= contra_order->quantity) {
-                    contra_order->status = OrderStatus::FILLED;
-                    level.orders.pop_front();
-                } else {
-                    contra_order->status = OrderStatus::PARTIAL;
-                }
-            }
-            
-            if (level.orders.empty()) {
-                asks_.erase(it);
+            } else {
+                execute_trade(contra_order, order, level.price, trade_qty);
             }
+            order->filled += trade_qty;
+            contra_order->filled += trade_qty;
+            contra_order->status = contra_order->filled >= contra_order->quantity ?
+                                   OrderStatus::FILLED : OrderStatus::PARTIAL;
+            level.total_quantity -= trade_qty;
+            side_total -= trade_qty;
+            if (!order_index_.empty() && !contra_order->is_open()) forget(contra_order);
+        };
+        
+        Quantity before = level.total_quantity;
+        Allocation::allocate(level.orders, level.total_quantity, order, fill);
+        level_changed(levels, it, level.total_quantity - before);
+        
+        if (level.orders.empty()) {
+            level_erasing(levels, it);
+            levels.erase(it);
+        }
+    }
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::prevent_self_trade(Order* aggressor, Order* resting,
+                                                    Quantity& level_total, Quantity& side_total) {
+    ++self_trades_prevented_;
+    
+    Quantity resting_cut = 0;
+    switch (stp_) {
+        case SelfTradePrevention::CANCEL_NEWEST:
+            aggressor->status = OrderStatus::CANCELLED;
+            break;
+        case SelfTradePrevention::CANCEL_OLDEST:
+            resting_cut = resting->remaining();
+            resting->status = OrderStatus::CANCELLED;
+            break;
+        case SelfTradePrevention::CANCEL_BOTH:
+            resting_cut = resting->remaining();
+            resting->status = OrderStatus::CANCELLED;
+            aggressor->status = OrderStatus::CANCELLED;
+            break;
+        case SelfTradePrevention::DECREMENT: {
+            // The smaller side is cancelled, the larger shrinks in place
+            resting_cut = std::min(aggressor->remaining(), resting->remaining());
+            aggressor->quantity -= resting_cut;
+            resting->quantity -= resting_cut;
+            if (aggressor->remaining() == 0) aggressor->status = OrderStatus::CANCELLED;
+            if (resting->remaining() == 0) resting->status = OrderStatus::CANCELLED;
+            break;
+        }
+        case SelfTradePrevention::NONE:
+            break;
+    }
+    level_total -= resting_cut;
+    side_total -= resting_cut;
+    if (!resting->is_open()) forget(resting);  // The policy drops it from the queue
+}
+
+template<typename Allocation>
+AuctionResult BasicOrderBook<Allocation>::indicative_uncross() const {
+    // Candidate prices are every limit price on either side. One merged
+    // ascending walk gathers per-price ask and bid quantity; supply at p_i is
+    // then a prefix sum over asks, and demand a prefix sum over the bids
+    // reversed into descending order.
+    std::vector<Price> prices;
+    std::vector<int64_t> supply, demand;
+    prices.reserve(bids_.size() + asks_.size());
+    supply.reserve(prices.capacity());
+    demand.reserve(prices.capacity());
+    
+    auto bid_it = bids_.rbegin();
+    auto ask_it = asks_.begin();
+    while (bid_it != bids_.rend() || ask_it != asks_.end()) {
+        Price p = (ask_it == asks_.end() || (bid_it != bids_.rend() && bid_it->first < ask_it->first))
+                      ? bid_it->first : ask_it->first;
+        prices.push_back(p);
+        supply.push_back(0);
+        demand.push_back(0);
+        if (bid_it != bids_.rend() && bid_it->first == p) demand.back() = (bid_it++)->second.total_quantity;
+        if (ask_it != asks_.end() && ask_it->first == p) supply.back() = (ask_it++)->second.total_quantity;
+    }
+    if (prices.empty() && last_trade_price_ > 0) {
+        prices.push_back(last_trade_price_);  // Market orders only: cross at reference
+        supply.push_back(0);
+        demand.push_back(0);
+    }
+    
+    size_t n = prices.size();
+    std::reverse(demand.begin(), demand.end());
+    const KernelTable& k = kernels();
+    k.prefix_sum_i64(supply.data(), supply.data(), n);
+    k.prefix_sum_i64(demand.data(), demand.data(), n);
+    
+    // Single pass with the tie-break rules; ties on volume and imbalance are
+    // contiguous in price, so the tied range is [lo, hi]
+    AuctionResult best;
+    Quantity best_abs = 0;
+    size_t lo = 0, hi = 0;
+    bool buy_pressure = true, sell_pressure = true;
+    for (size_t i = 0; i < n; ++i) {
+        Quantity d = demand[n - 1 - i] + market_bids_.total_quantity;
+        Quantity s = supply[i] + market_asks_.total_quantity;
+        Quantity volume = std::min(d, s);
+        if (volume == 0) continue;
+        Quantity imbalance = d - s;
+        Quantity abs_imbalance = std::llabs(imbalance);
+        
+        if (volume > best.volume || (volume == best.volume && abs_imbalance < best_abs)) {
+            best = AuctionResult{prices[i], volume, imbalance};
+            best_abs = abs_imbalance;
+            lo = hi = i;
+            buy_pressure = imbalance > 0;
+            sell_pressure = imbalance < 0;
+        } else if (volume == best.volume && abs_imbalance == best_abs) {
+            hi = i;
+            buy_pressure = buy_pressure && imbalance > 0;
+            sell_pressure = sell_pressure && imbalance < 0;
         }
+    }
+    if (best.volume == 0 || lo == hi) return best;
+    
+    // Market pressure: surplus on one side pushes the price towards it
+    size_t pick;
+    if (buy_pressure) {
+        pick = hi;
+    } else if (sell_pressure) {
+        pick = lo;
     } else {
-        // Match against bids
-        while (order->filled < order->quantity && !bids_.empty()) {
-            auto it = bids_.begin();
-            auto& level = it->second;
-            
-            // Check price compatibility
-            if (order->type == OrderType::LIMIT) {
-                if (order->price > level.price) break;
-            }
-            
-            while (!level.orders.empty() && order->filled < order->quantity) {
-                Order* contra_order = level.orders.front();
-                Quantity trade_qty = std::min(
-                    order->quantity - order->filled,
-                    contra_order->quantity - contra_order->filled
-                );
-                
-                execute_trade(contra_order, order, level.price, trade_qty);
-                
-                order->filled += trade_qty;
-                contra_order->filled += trade_qty;
-                level.total_quantity -= trade_qty;
-                
-                if (contra_order->filled >= contra_order->quantity) {
-                    contra_order->status = OrderStatus::FILLED;
-                    level.orders.pop_front();
-                } else {
-                    contra_order->status = OrderStatus::PARTIAL;
-                }
-            }
-            
-            if (level.orders.empty()) {
-                bids_.erase(it);
-            }
+        // Closest to the reference price, lower on equal distance
+        Price ref = last_trade_price_ > 0 ? last_trade_price_ : prices[lo] + (prices[hi] - prices[lo]) / 2;
+        if (ref <= prices[lo]) {
+            pick = lo;
+        } else if (ref >= prices[hi]) {
+            pick = hi;
+        } else {
+            pick = std::upper_bound(prices.begin() + lo, prices.begin() + hi + 1, ref) - prices.begin();
+            if (ref - prices[pick - 1] <= prices[pick] - ref) --pick;
         }
     }
+    Quantity d = demand[n - 1 - pick] + market_bids_.total_quantity;
+    Quantity s = supply[pick] + market_asks_.total_quantity;
+    return AuctionResult{prices[pick], best.volume, d - s};
+}
+
+template<typename Allocation>
+AuctionResult BasicOrderBook<Allocation>::uncross() {
+    AuctionResult result = indicative_uncross();
     
-    order->status = (order->filled >= order->quantity) ? 
-                    OrderStatus::FILLED : 
-                    (order->filled > 0 ? OrderStatus::PARTIAL : OrderStatus::PENDING);
+    if (result.volume > 0) {
+        std::vector<std::pair<Order*, Quantity>> buys, sells;
+        collect_auction_side(market_bids_, bids_, result.price, result.volume, bid_total_, buys);
+        collect_auction_side(market_asks_, asks_, result.price, result.volume, ask_total_, sells);
+        
+        // Pair both queues in priority order
+        size_t b = 0, s = 0;
+        while (b < buys.size() && s < sells.size()) {
+            Quantity qty = std::min(buys[b].second, sells[s].second);
+            Order* buy = buys[b].first;
+            Order* sell = sells[s].first;
+            execute_trade(buy, sell, result.price, qty);
+            buy->filled += qty;
+            sell->filled += qty;
+            if ((buys[b].second -= qty) == 0) ++b;
+            if ((sells[s].second -= qty) == 0) ++s;
+        }
+        
+        settle_auction_side(market_bids_, bids_);
+        settle_auction_side(market_asks_, asks_);
+    }
+    
+    // Unfilled market orders do not carry into continuous trading
+    for (auto* level : {&market_bids_, &market_asks_}) {
+        for (Order* order : level->orders) {
+            order->status = OrderStatus::CANCELLED;
+        }
+        level->orders.clear();
+        level->total_quantity = 0;
+    }
+    
+    phase_ = TradingPhase::CONTINUOUS;
+    reset_features();  // Settlement bypasses the per-level hooks
+    trigger_stops();
+    publish_top();
+    return result;
 }
 
-void OrderBook::execute_trade(Order* buy_order, Order* sell_order, 
-                              Price price, Quantity qty) {
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::collect_auction_side(PriceLevel& market, Levels& levels, Price price,
+                                                      Quantity volume, Quantity& side_total,
+                                                      std::vector<std::pair<Order*, Quantity>>& out) {
+    auto take = [&](PriceLevel& level) {
+        for (auto it = level.orders.begin(); it != level.orders.end() && volume > 0; ++it) {
+            Quantity qty = std::min(volume, (*it)->remaining());
+            out.emplace_back(*it, qty);
+            level.total_quantity -= qty;
+            volume -= qty;
+        }
+    };
+    
+    take(market);
+    for (auto it = levels.begin(); it != levels.end() && volume > 0; ++it) {
+        if (levels.key_comp()(price, it->first)) break;  // Worse than the auction price
+        Quantity before = volume;
+        take(it->second);
+        side_total -= before - volume;
+    }
+}
+
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::settle_auction_side(PriceLevel& market, Levels& levels) {
+    // Executed quantity is always a prefix of the side's priority order, so
+    // settling stops at the first order left with open quantity
+    auto settle = [this](PriceLevel& level) {
+        while (!level.orders.empty()) {
+            Order* order = level.orders.front();
+            if (order->filled < order->quantity) {
+                if (order->filled > 0) order->status = OrderStatus::PARTIAL;
+                return false;
+            }
+            order->status = OrderStatus::FILLED;
+            forget(order);
+            level.orders.pop_front();
+        }
+        return true;
+    };
+    
+    settle(market);
+    while (!levels.empty() && settle(levels.begin()->second)) {
+        levels.erase(levels.begin());
+    }
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::execute_trade(Order* buy_order, Order* sell_order, 
+                                               Price price, Quantity qty) {
     Trade trade{
         buy_order->id,
         sell_order->id,
@@ -130,6 +540,9 @@ void OrderBook::execute_trade(Order* buy_order, Order* sell_order,
         std::max(buy_order->timestamp, sell_order->timestamp)
     };
     
+    last_trade_price_ = price;
+    last_trade_quantity_ = qty;
+    
     if (trade_callback_) {
         trade_callback_(trade);
     }
@@ -137,20 +550,191 @@ void OrderBook::execute_trade(Order* buy_order, Order* sell_order,
     ++total_trades_;
 }
 
-Quantity OrderBook::bid_volume() const {
-    Quantity vol = 0;
-    for (const auto& [price, level] : bids_) {
-        vol += level.total_quantity;
+template<typename Allocation>
+void BasicOrderBook<Allocation>::publish_top() {
+    if (dirty_) {
+        dirty_->mark(symbol_id_);
+    }
+    if (features_enabled_) {
+        refresh_features();
+    }
+    if (!top_slot_ && top_listeners_.empty()) return;
+    
+    TopOfBookSnapshot snap;
+    if (!bids_.empty()) {
+        snap.bid = bids_.begin()->first;
+        snap.bid_quantity = bids_.begin()->second.total_quantity;
+    }
+    if (!asks_.empty()) {
+        snap.ask = asks_.begin()->first;
+        snap.ask_quantity = asks_.begin()->second.total_quantity;
+    }
+    snap.last_price = last_trade_price_;
+    snap.last_quantity = last_trade_quantity_;
+    snap.bid_total = bid_total_;
+    snap.ask_total = ask_total_;
+    snap.timestamp = last_update_;
+    if (top_slot_) {
+        top_slot_->publish(snap);
+    }
+    
+    if (!top_listeners_.empty() &&
+        (snap.bid != notified_top_.bid || snap.bid_quantity != notified_top_.bid_quantity ||
+         snap.ask != notified_top_.ask || snap.ask_quantity != notified_top_.ask_quantity)) {
+        notified_top_ = snap;
+        for (auto& [id, listener] : top_listeners_) {
+            listener();
+        }
+    }
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::enable_features(size_t depth_levels, Timestamp depletion_half_life) {
+    features_enabled_ = true;
+    feature_levels_ = depth_levels;
+    depletion_tau_ns_ = static_cast<double>(depletion_half_life ? depletion_half_life : 1) / std::log(2.0);
+    features_ = BookFeatures{};
+    bid_depleted_at_ = ask_depleted_at_ = last_update_;
+    reset_features();
+    refresh_features();
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::reset_features() {
+    if (!features_enabled_) return;
+    bid_depth_.reset(bids_, feature_levels_);
+    ask_depth_.reset(asks_, feature_levels_);
+}
+
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::level_inserted(Levels& levels, typename Levels::iterator it) {
+    if (!features_enabled_) return;
+    if constexpr (std::is_same_v<Levels, BidLevels>) {
+        bid_depth_.inserted(levels, it);
+    } else {
+        ask_depth_.inserted(levels, it);
+    }
+}
+
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::level_changed(Levels& levels, typename Levels::iterator it, Quantity delta) {
+    if (!features_enabled_ || delta == 0) return;
+    constexpr bool bid_side = std::is_same_v<Levels, BidLevels>;
+    if constexpr (bid_side) {
+        bid_depth_.changed(levels, it, delta);
+    } else {
+        ask_depth_.changed(levels, it, delta);
+    }
+    
+    // Touch depletion: rate = sum(q_i * exp(-(t - t_i) / tau)) / tau
+    if (delta < 0 && it == levels.begin()) {
+        double& rate = bid_side ? features_.bid_depletion : features_.ask_depletion;
+        Timestamp& at = bid_side ? bid_depleted_at_ : ask_depleted_at_;
+        Timestamp elapsed = last_update_ > at ? last_update_ - at : 0;
+        rate = rate * std::exp(-static_cast<double>(elapsed) / depletion_tau_ns_) +
+               static_cast<double>(-delta) * 1e9 / depletion_tau_ns_;
+        at = std::max(at, last_update_);
+    }
+}
+
+template<typename Allocation>
+template<typename Levels>
+void BasicOrderBook<Allocation>::level_erasing(Levels& levels, typename Levels::iterator it) {
+    if (!features_enabled_) return;
+    if constexpr (std::is_same_v<Levels, BidLevels>) {
+        bid_depth_.erasing(levels, it);
+    } else {
+        ask_depth_.erasing(levels, it);
     }
-    return vol;
 }
 
-Quantity OrderBook::ask_volume() const {
-    Quantity vol = 0;
-    for (const auto& [price, level] : asks_) {
-        vol += level.total_quantity;
+template<typename Allocation>
+void BasicOrderBook<Allocation>::refresh_features() {
+    BookFeatures& f = features_;
+    f.bid = best_bid();
+    f.ask = best_ask();
+    f.bid_quantity = best_bid_quantity();
+    f.ask_quantity = best_ask_quantity();
+    
+    if (f.bid && f.ask) {
+        f.mid = (static_cast<double>(f.bid) + static_cast<double>(f.ask)) / 2.0;
+        double size = static_cast<double>(f.bid_quantity + f.ask_quantity);
+        f.microprice = (static_cast<double>(f.bid) * static_cast<double>(f.ask_quantity) +
+                        static_cast<double>(f.ask) * static_cast<double>(f.bid_quantity)) / size;
+    } else {
+        f.mid = f.microprice = static_cast<double>(f.bid ? f.bid : f.ask);
     }
-    return vol;
+    
+    auto imbalance = [](Quantity b, Quantity a) {
+        return b + a > 0 ? static_cast<double>(b - a) / static_cast<double>(b + a) : 0.0;
+    };
+    f.imbalance = imbalance(f.bid_quantity, f.ask_quantity);
+    f.bid_depth = bid_depth_.quantity();
+    f.ask_depth = ask_depth_.quantity();
+    f.depth_imbalance = imbalance(f.bid_depth, f.ask_depth);
+    f.timestamp = last_update_;
+    ++f.updates;
+}
+
+template<typename Allocation>
+uint32_t BasicOrderBook<Allocation>::add_top_listener(TopListener listener) {
+    // Listeners start from the current top; only later changes notify
+    notified_top_.bid = best_bid();
+    notified_top_.bid_quantity = best_bid_quantity();
+    notified_top_.ask = best_ask();
+    notified_top_.ask_quantity = best_ask_quantity();
+    top_listeners_.emplace_back(next_listener_id_, std::move(listener));
+    return next_listener_id_++;
+}
+
+template<typename Allocation>
+void BasicOrderBook<Allocation>::remove_top_listener(uint32_t id) {
+    top_listeners_.erase(std::remove_if(top_listeners_.begin(), top_listeners_.end(),
+                                        [id](const auto& entry) { return entry.first == id; }),
+                         top_listeners_.end());
 }
 
+template<typename Allocation>
+size_t BasicOrderBook<Allocation>::depth(Side side, size_t levels, Price* prices, Quantity* quantities) const {
+    size_t n = 0;
+    auto copy_levels = [&](const auto& book_side) {
+        for (auto it = book_side.begin(); it != book_side.end() && n < levels; ++it, ++n) {
+            prices[n] = it->first;
+            quantities[n] = it->second.total_quantity;
+        }
+    };
+    
+    if (side == Side::BUY) {
+        copy_levels(bids_);
+    } else {
+        copy_levels(asks_);
+    }
+    return n;
+}
+
+template<typename Allocation>
+Quantity BasicOrderBook<Allocation>::executable_top(Side side, uint32_t user_id) const {
+    auto top = [&](const auto& book_side) -> Quantity {
+        if (book_side.empty()) return 0;
+        const PriceLevel& level = book_side.begin()->second;
+        if (stp_ == SelfTradePrevention::NONE) return level.total_quantity;
+        
+        Quantity ahead = 0;
+        for (const Order* resting : level.orders) {
+            if (resting->user_id == user_id) {
+                return std::is_same_v<Allocation, FifoAllocation> ? ahead : 0;
+            }
+            ahead += resting->remaining();
+        }
+        return ahead;
+    };
+    return side == Side::BUY ? top(bids_) : top(asks_);
+}
+
+template class BasicOrderBook<FifoAllocation>;
+template class BasicOrderBook<ProRataAllocation>;
+template class BasicOrderBook<FifoProRataAllocation>;
+
 } // namespace trading
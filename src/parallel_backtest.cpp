@@ -0,0 +1,819 @@
+#include "tick_engine.hpp"
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace trading {
+
+namespace {
+
+constexpr Timestamp NEVER = std::numeric_limits<Timestamp>::max();
+
+// One event crossing between shards (or from a shard to itself). Messages
+// apply in (time, rank, a, b) order, which no partition can change:
+// orders and cancels (rank 0) by (sending strategy, its send sequence),
+// then book reports (rank 1) by (symbol, the book's report sequence).
+struct ShardMessage {
+    enum Kind : uint8_t { NEW_ORDER = 0, CANCEL = 1, TRADE = 2, CANCELLED = 3 };
+
+    Timestamp time = 0;
+    uint64_t a = 0;
+    uint64_t b = 0;
+    Kind kind = NEW_ORDER;
+    uint32_t from = 0;           // Sending shard
+    SymbolId symbol = 0;
+    OrderHandle owner = 0;       // Sender's handle (NEW_ORDER, CANCEL, CANCELLED)
+    Order order;                 // NEW_ORDER
+    Trade trade;                 // TRADE, ids are the owners' handles
+    uint32_t buy_shard = 0;
+    uint32_t sell_shard = 0;
+    uint32_t buy_key = 0;        // Global strategy index of each side
+    uint32_t sell_key = 0;
+
+    bool operator<(const ShardMessage& other) const {
+        bool report = kind >= TRADE, other_report = other.kind >= TRADE;
+        if (time != other.time) return time < other.time;
+        if (report != other_report) return other_report;
+        return a != other.a ? a < other.a : b < other.b;
+    }
+};
+
+} // namespace
+
+// Drives the shard engines of one run_backtest(ticks, config) call. Each
+// shard is a TickEngine holding the books it owns, the strategies homed on
+// it and the owner records of their orders; messages are exchanged through
+// mailbox_[parity][from][to], written by one shard and read by one other,
+// with the window barrier as the only synchronization. Every shard keeps
+// its own copy of the book routing table, so rebalancing can change it
+// between windows without a shared write.
+class ParallelRun {
+public:
+    ParallelRun(TickEngine& coordinator, const std::vector<Tick>& ticks, const ParallelConfig& config);
+    void run();
+
+    // Called on the shard engines
+    OrderHandle submit(TickEngine& engine, const Order& order, SymbolId symbol);
+    bool cancel(TickEngine& engine, OrderHandle handle);
+    void report_trade(TickEngine& engine, const Trade& trade, SymbolId symbol);
+
+private:
+    struct OwnerRef {
+        uint32_t shard = 0;
+        uint32_t key = 0;          // Global strategy index
+        OrderHandle handle = 0;    // Handle in the owner shard
+    };
+
+    struct Shard {
+        TickEngine* engine = nullptr;
+        std::vector<uint32_t> ticks;            // Indices into ticks_
+        size_t next_tick = 0;
+        std::vector<ShardMessage> inbox;        // Sorted from `consumed` on
+        size_t consumed = 0;
+        Timestamp sent_min = NEVER;             // Earliest message sent this window
+        Timestamp next = NEVER;                 // Earliest pending event after the window
+        uint32_t parity = 0;
+        std::exception_ptr error;
+        std::vector<uint32_t> keys;             // Local strategy -> global index
+        std::vector<uint32_t> submitter;        // Owner pool slot -> global strategy index
+        // Book side
+        std::vector<OwnerRef> owner_of;         // Book pool slot -> owner
+        std::vector<std::vector<std::pair<OrderHandle, OrderHandle>>> by_owner;  // [shard][owner slot] -> (owner handle, book handle)
+        std::vector<uint64_t> report_seq;       // SymbolId -> reports sent
+        std::vector<OrderHandle> touched;       // Book orders to retire after the operation
+        std::vector<uint16_t> route;            // SymbolId -> owning shard
+        // Work: strategy callbacks plus book operations, in total and
+        // since the last rebalancing check (per owned book as well)
+        uint64_t total_work = 0;
+        uint64_t work = 0;
+        std::vector<uint64_t> symbol_work;
+    };
+
+    // A book changing shards, passed across the second rebalancing barrier
+    struct Handover {
+        std::string name;
+        SymbolId symbol = 0;
+        std::unique_ptr<OrderBook> book;
+        uint64_t fingerprint = 0;
+        uint64_t report_seq = 0;
+    };
+
+    uint32_t owner_of_symbol(SymbolId symbol) const {
+        return symbol < owner_.size() ? owner_[symbol] : static_cast<uint32_t>(symbol % shards_.size());
+    }
+    uint32_t key_of(Shard& shard, Strategy* strategy) const;
+    void send(Shard& shard, uint32_t to, const ShardMessage& message);
+    void shard_loop(uint32_t k, std::barrier<>& sync);
+    void process_window(uint32_t k, Timestamp end);
+    void apply(Shard& shard, const ShardMessage& message);
+    void arrive(Shard& shard, const ShardMessage& message);
+    void arrive_cancel(Shard& shard, const ShardMessage& message);
+    void deliver_trade(Shard& shard, const ShardMessage& message);
+    void retire_touched(Shard& shard);
+    void dispatch_tick(Shard& shard, uint32_t index);
+    void charge(Shard& shard, uint64_t work) {
+        shard.work += work;
+        shard.total_work += work;
+    }
+    // Rebalancing at window boundaries
+    void publish_candidates(Shard& shard, uint32_t parity);
+    std::vector<SymbolId> plan_migrations(uint32_t parity, uint32_t& from, uint32_t& to) const;
+    void migrate(uint32_t k, uint32_t parity, std::barrier<>& sync);
+    void hand_over(Shard& shard, const std::vector<SymbolId>& symbols);
+    void adopt(Shard& shard);
+
+    TickEngine& coordinator_;
+    const std::vector<Tick>& ticks_;
+    std::vector<SymbolId> tick_symbols_;
+    Timestamp latency_;
+    std::vector<uint16_t> owner_;               // SymbolId -> shard
+    std::vector<Shard> shards_;
+    std::vector<uint64_t> strategy_seq_;        // Global strategy -> messages sent
+    std::vector<std::vector<std::vector<ShardMessage>>> mailbox_[2];
+    std::vector<Timestamp> next_[2];            // Per window parity, per shard
+    std::vector<uint8_t> failed_[2];
+    Timestamp start_ = NEVER;
+    // Rebalancing: published work and idle books (work, symbol) per window
+    // parity and shard, and the books in transit
+    Timestamp rebalance_interval_ = 0;
+    double rebalance_threshold_ = 0.0;
+    size_t max_migrations_ = 0;
+    std::vector<uint64_t> work_[2];
+    std::vector<std::vector<std::pair<uint64_t, SymbolId>>> candidates_[2];
+    std::vector<Handover> handover_;
+    std::vector<ShardMessage> handover_messages_;
+    uint64_t windows_ = 0;
+    uint64_t migrations_ = 0;
+};
+
+ParallelRun::ParallelRun(TickEngine& coordinator, const std::vector<Tick>& ticks,
+                         const ParallelConfig& config)
+    : coordinator_(coordinator), ticks_(ticks), latency_(config.order_latency),
+      rebalance_interval_(config.shards > 1 ? config.rebalance_interval : 0),
+      rebalance_threshold_(config.rebalance_threshold), max_migrations_(config.max_migrations) {
+    if (config.order_latency == 0) {
+        throw std::logic_error("parallel run needs a non-zero order latency");
+    }
+    if (!coordinator.spreads_.empty() || !coordinator.chains_.empty() ||
+        coordinator.bars_.resolutions() > 0 || coordinator.sampler_ || coordinator.live_stats_ ||
+        coordinator.book_updates_ || coordinator.stp_ != SelfTradePrevention::NONE) {
+        throw std::logic_error("parallel run does not support spreads, option chains, bars, "
+                               "sampling, live stats, book updates or self-trade prevention");
+    }
+    if (coordinator.timers_.size() > 0 || coordinator.order_pool_.allocated_count() > 0) {
+        throw std::logic_error("parallel run must start without open orders or timers");
+    }
+
+    size_t count = std::max<size_t>(config.shards, 1);
+    for (size_t i = 0; i < config.shard_of.size(); ++i) {
+        if (config.shard_of[i] >= count) throw std::logic_error("shard_of names a missing shard");
+    }
+
+    // Register every symbol up front: the registry is not safe to extend
+    // from the shard threads
+    auto& registry = SymbolRegistry::instance();
+    tick_symbols_.resize(ticks.size());
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        if (i > 0 && ticks[i].timestamp < ticks[i - 1].timestamp) {
+            throw std::logic_error("parallel run needs ticks in timestamp order");
+        }
+        tick_symbols_[i] = registry.register_symbol(ticks[i].symbol);
+    }
+    size_t symbols = registry.size();
+    owner_.resize(symbols);
+    for (size_t s = 0; s < symbols; ++s) {
+        owner_[s] = static_cast<uint16_t>(s < config.shard_of.size() ? config.shard_of[s] : s % count);
+    }
+
+    shards_.resize(count);
+    for (auto& old : coordinator.shards_) {  // Drop the previous run's books
+        for (SymbolId s = 0; s < old->books_by_id_.size() && s < coordinator.books_by_id_.size(); ++s) {
+            if (coordinator.books_by_id_[s] == old->books_by_id_[s]) coordinator.books_by_id_[s] = nullptr;
+        }
+    }
+    coordinator.shards_.clear();
+    for (uint32_t k = 0; k < count; ++k) {
+        auto engine = std::make_unique<TickEngine>();
+        engine->parallel_ = this;
+        engine->shard_ = k;
+        engine->current_time_ = coordinator.current_time_;
+        engine->current_symbol_ = std::numeric_limits<SymbolId>::max();
+        engine->feature_levels_ = coordinator.feature_levels_;
+        engine->feature_half_life_ = coordinator.feature_half_life_;
+        shards_[k].engine = engine.get();
+        shards_[k].by_owner.resize(count);
+        shards_[k].report_seq.resize(symbols);
+        shards_[k].route = owner_;
+        shards_[k].symbol_work.resize(symbols);
+        coordinator.shards_.push_back(std::move(engine));
+    }
+    for (int p = 0; p < 2; ++p) {
+        mailbox_[p].assign(count, std::vector<std::vector<ShardMessage>>(count));
+        next_[p].assign(count, NEVER);
+        failed_[p].assign(count, 0);
+        work_[p].assign(count, 0);
+        candidates_[p].resize(count);
+    }
+
+    // Books of traded symbols exist from the start, as in a serial run
+    std::vector<uint8_t> seen(symbols, 0);
+    for (SymbolId symbol : tick_symbols_) {
+        if (seen[symbol]) continue;
+        seen[symbol] = 1;
+        shards_[owner_[symbol]].engine->get_or_create_book(registry.get_symbol(symbol));
+    }
+
+    // Home each strategy on the shard of its lowest subscribed symbol
+    TickEngine& c = coordinator;
+    std::sort(c.subscriptions_.begin(), c.subscriptions_.end());
+    c.subscriptions_.erase(std::unique(c.subscriptions_.begin(), c.subscriptions_.end()),
+                           c.subscriptions_.end());
+    std::vector<uint32_t> home(c.strategies_.size(), 0);
+    std::vector<uint8_t> homed(c.strategies_.size(), 0);
+    for (const auto& [symbol, index] : c.subscriptions_) {
+        if (!homed[index]) {
+            home[index] = owner_of_symbol(symbol);
+            homed[index] = 1;
+        }
+    }
+    std::vector<uint32_t> local(c.strategies_.size());
+    for (uint32_t i = 0; i < c.strategies_.size(); ++i) {
+        TickEngine& shard = *shards_[home[i]].engine;
+        local[i] = static_cast<uint32_t>(shard.strategies_.size());
+        shard.strategies_.push_back(std::move(c.strategies_[i]));
+        shard.sees_all_.push_back(c.sees_all_[i]);
+        shard.dispatch_dirty_ = true;
+        shards_[home[i]].keys.push_back(i);
+    }
+    for (const auto& [symbol, index] : c.subscriptions_) {
+        shards_[home[index]].engine->subscriptions_.emplace_back(symbol, local[index]);
+    }
+    strategy_seq_.assign(c.strategies_.size(), 0);
+
+    // Each shard replays the ticks its strategies subscribe to
+    for (uint32_t k = 0; k < count; ++k) {
+        Shard& shard = shards_[k];
+        for (uint32_t i = 0; i < ticks.size(); ++i) {
+            auto [first, last] = shard.engine->subscribers(tick_symbols_[i]);
+            if (first != last) shard.ticks.push_back(i);
+        }
+    }
+    if (!ticks.empty()) start_ = ticks.front().timestamp;
+}
+
+void ParallelRun::run() {
+    if (start_ != NEVER) {
+        std::barrier<> sync(static_cast<std::ptrdiff_t>(shards_.size()));
+        std::vector<std::thread> threads;
+        for (uint32_t k = 1; k < shards_.size(); ++k) {
+            threads.emplace_back([this, k, &sync] { shard_loop(k, sync); });
+        }
+        shard_loop(0, sync);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Hand strategies back in their original order and merge the results
+    TickEngine& c = coordinator_;
+    std::vector<uint32_t> taken(shards_.size(), 0);
+    TickEngine::Stats stats;
+    for (uint32_t i = 0; i < c.strategies_.size(); ++i) {
+        for (uint32_t k = 0; k < shards_.size(); ++k) {
+            Shard& shard = shards_[k];
+            if (taken[k] < shard.keys.size() && shard.keys[taken[k]] == i) {
+                c.strategies_[i] = std::move(shard.engine->strategies_[taken[k]++]);
+                break;
+            }
+        }
+    }
+    for (Shard& shard : shards_) {
+        TickEngine& engine = *shard.engine;
+        engine.strategies_.clear();
+        engine.dispatch_dirty_ = true;
+        engine.parallel_ = nullptr;
+        stats.orders_submitted += engine.stats_.orders_submitted;
+        stats.trades_executed += engine.stats_.trades_executed;
+        stats.total_latency_ns += engine.stats_.total_latency_ns;
+        stats.fingerprint = RunFingerprint::combine(stats.fingerprint, engine.stats_.fingerprint);
+        c.current_time_ = std::max(c.current_time_, engine.current_time_);
+        for (SymbolId s = 0; s < engine.books_by_id_.size(); ++s) {
+            if (!engine.books_by_id_[s]) continue;
+            if (s >= c.books_by_id_.size()) c.books_by_id_.resize(s + 1, nullptr);
+            c.books_by_id_[s] = engine.books_by_id_[s];
+        }
+    }
+    for (SymbolId symbol : tick_symbols_) {
+        if (symbol >= c.activity_.size()) c.activity_.resize(symbol + 1);
+        ++c.activity_[symbol].ticks;
+    }
+    for (Shard& shard : shards_) {
+        const ActivityProfile& activity = shard.engine->activity_;
+        if (activity.size() > c.activity_.size()) c.activity_.resize(activity.size());
+        for (SymbolId s = 0; s < activity.size(); ++s) {
+            c.activity_[s].orders += activity[s].orders;
+        }
+    }
+    
+    TickEngine::ParallelStats& parallel = c.parallel_stats_;
+    parallel = {};
+    uint64_t busiest = 0, total = 0;
+    for (Shard& shard : shards_) {
+        parallel.shard_work.push_back(shard.total_work);
+        busiest = std::max(busiest, shard.total_work);
+        total += shard.total_work;
+    }
+    parallel.balance_factor = total ? static_cast<double>(busiest) * shards_.size() / total : 1.0;
+    parallel.windows = windows_;
+    parallel.migrations = migrations_;
+    
+    stats.ticks_processed = ticks_.size();
+    c.stats_.ticks_processed += stats.ticks_processed;
+    c.stats_.orders_submitted += stats.orders_submitted;
+    c.stats_.trades_executed += stats.trades_executed;
+    c.stats_.total_latency_ns += stats.total_latency_ns;
+    c.stats_.fingerprint = RunFingerprint::combine(c.stats_.fingerprint, stats.fingerprint);
+
+    for (Shard& shard : shards_) {
+        if (shard.error) std::rethrow_exception(shard.error);
+    }
+}
+
+// Every shard runs the same window sequence: process [W, W + latency),
+// publish the earliest pending event, meet at the barrier, and start the
+// next window at the global minimum (skipping idle stretches). Every
+// decision after the barrier is computed identically by all shards.
+void ParallelRun::shard_loop(uint32_t k, std::barrier<>& sync) {
+    Shard& shard = shards_[k];
+    Timestamp window = start_;
+    Timestamp rebalance_at = rebalance_interval_ ? start_ + rebalance_interval_ : NEVER;
+    for (uint32_t parity = 0;; parity ^= 1) {
+        shard.parity = parity;
+        Timestamp end = window > NEVER - latency_ ? NEVER : window + latency_;
+        bool rebalance = end >= rebalance_at;
+        if (!shard.error) {
+            try {
+                process_window(k, end);
+                if (rebalance) publish_candidates(shard, parity);
+            } catch (...) {
+                shard.error = std::current_exception();
+            }
+        }
+        next_[parity][k] = shard.next;
+        failed_[parity][k] = shard.error != nullptr;
+        work_[parity][k] = shard.work;
+        sync.arrive_and_wait();
+
+        Timestamp next = NEVER;
+        bool failed = false;
+        for (size_t j = 0; j < shards_.size(); ++j) {
+            next = std::min(next, next_[parity][j]);
+            failed |= failed_[parity][j] != 0;
+        }
+        if (k == 0) ++windows_;
+        if (failed || next == NEVER) return;
+        if (rebalance) {
+            rebalance_at = end + rebalance_interval_;
+            migrate(k, parity, sync);
+        }
+        window = next;
+    }
+}
+
+void ParallelRun::process_window(uint32_t k, Timestamp end) {
+    Shard& shard = shards_[k];
+    TickEngine& engine = *shard.engine;
+
+    // Messages sent during the previous window
+    size_t before = shard.inbox.size();
+    for (auto& from : mailbox_[shard.parity ^ 1]) {
+        auto& box = from[k];
+        shard.inbox.insert(shard.inbox.end(), box.begin(), box.end());
+        box.clear();
+    }
+    if (shard.inbox.size() != before) {
+        std::sort(shard.inbox.begin() + shard.consumed, shard.inbox.end());
+    }
+    shard.sent_min = NEVER;
+
+    auto tick_time = [&] {
+        return shard.next_tick < shard.ticks.size() ? ticks_[shard.ticks[shard.next_tick]].timestamp : NEVER;
+    };
+    auto timer_time = [&] {
+        return engine.timers_.size() > 0 ? std::max(engine.timers_.next_deadline(), engine.current_time_) : NEVER;
+    };
+
+    for (;;) {
+        Timestamp now = std::min(tick_time(), timer_time());
+        if (shard.consumed < shard.inbox.size()) {
+            now = std::min(now, shard.inbox[shard.consumed].time);
+        }
+        if (now >= end) break;
+        engine.current_time_ = now;
+
+        // Arrivals, then reports, then timers, then market data
+        while (shard.consumed < shard.inbox.size() && shard.inbox[shard.consumed].time == now) {
+            apply(shard, shard.inbox[shard.consumed++]);
+        }
+        if (engine.timers_.size() > 0) {
+            engine.current_symbol_ = std::numeric_limits<SymbolId>::max();
+            engine.fire_timers(now);
+            engine.active_ = nullptr;
+        }
+        while (tick_time() == now) {
+            dispatch_tick(shard, shard.ticks[shard.next_tick++]);
+        }
+    }
+
+    shard.inbox.erase(shard.inbox.begin(), shard.inbox.begin() + shard.consumed);
+    shard.consumed = 0;
+    shard.next = std::min({tick_time(), timer_time(), shard.sent_min,
+                           shard.inbox.empty() ? NEVER : shard.inbox.front().time});
+}
+
+void ParallelRun::dispatch_tick(Shard& shard, uint32_t index) {
+    auto start = std::chrono::steady_clock::now();
+    TickEngine& engine = *shard.engine;
+    const Tick& tick = ticks_[index];
+    engine.current_symbol_ = tick_symbols_[index];
+
+    auto [first, last] = engine.subscribers(engine.current_symbol_);
+    charge(shard, last - first);
+    for (Strategy* const* it = first; it != last; ++it) {
+        engine.active_ = *it;
+        (*it)->on_tick(tick, &engine);
+    }
+    engine.active_ = nullptr;
+    engine.current_symbol_ = std::numeric_limits<SymbolId>::max();
+
+    auto end = std::chrono::steady_clock::now();
+    ++engine.stats_.ticks_processed;
+    engine.stats_.total_latency_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+}
+
+uint32_t ParallelRun::key_of(Shard& shard, Strategy* strategy) const {
+    auto& strategies = shard.engine->strategies_;
+    for (uint32_t i = 0; i < strategies.size(); ++i) {
+        if (strategies[i].get() == strategy) return shard.keys[i];
+    }
+    throw std::logic_error("orders in a parallel run must come from strategy callbacks");
+}
+
+void ParallelRun::send(Shard& shard, uint32_t to, const ShardMessage& message) {
+    mailbox_[shard.parity][shard.engine->shard_][to].push_back(message);
+    shard.sent_min = std::min(shard.sent_min, message.time);
+}
+
+OrderHandle ParallelRun::submit(TickEngine& engine, const Order& order_template, SymbolId symbol) {
+    if (symbol == std::numeric_limits<SymbolId>::max()) {
+        // One-argument submit_order outside on_tick: there is no current book
+        throw std::logic_error("submit_order without a symbol is only valid in on_tick");
+    }
+    Shard& shard = shards_[engine.shard_];
+    OrderHandle handle = engine.new_order(order_template);
+    Order* order = engine.order_pool_.at(handle_slot(handle));
+    if (symbol >= owner_.size()) {
+        order->status = OrderStatus::CANCELLED;  // No book to route to
+        return handle;
+    }
+
+    size_t slot = handle_slot(handle);
+    if (engine.order_symbols_.size() < engine.order_pool_.capacity()) {
+        engine.order_symbols_.resize(engine.order_pool_.capacity());
+    }
+    if (shard.submitter.size() < engine.order_pool_.capacity()) {
+        shard.submitter.resize(engine.order_pool_.capacity());
+    }
+    engine.order_symbols_[slot] = symbol;
+    uint32_t key = key_of(shard, engine.active_);
+    shard.submitter[slot] = key;
+
+    ShardMessage message;
+    message.time = engine.current_time_ + latency_;
+    message.a = key;
+    message.b = strategy_seq_[key]++;
+    message.kind = ShardMessage::NEW_ORDER;
+    message.from = engine.shard_;
+    message.symbol = symbol;
+    message.owner = handle;
+    message.order = *order;
+    send(shard, shard.route[symbol], message);
+    return handle;
+}
+
+bool ParallelRun::cancel(TickEngine& engine, OrderHandle handle) {
+    const Order* order = engine.find_order(handle);
+    if (!order || !order->is_open()) return false;
+
+    // Keyed by the submitting strategy, also for GTT expiries
+    Shard& shard = shards_[engine.shard_];
+    size_t slot = handle_slot(handle);
+    uint32_t key = shard.submitter[slot];
+    ShardMessage message;
+    message.time = engine.current_time_ + latency_;
+    message.a = key;
+    message.b = strategy_seq_[key]++;
+    message.kind = ShardMessage::CANCEL;
+    message.from = engine.shard_;
+    message.symbol = engine.order_symbols_[slot];
+    message.owner = handle;
+    send(shard, shard.route[message.symbol], message);
+    return true;
+}
+
+void ParallelRun::apply(Shard& shard, const ShardMessage& message) {
+    switch (message.kind) {
+    case ShardMessage::NEW_ORDER:
+        charge(shard, 1);
+        ++shard.symbol_work[message.symbol];
+        arrive(shard, message);
+        break;
+    case ShardMessage::CANCEL:
+        charge(shard, 1);
+        ++shard.symbol_work[message.symbol];
+        arrive_cancel(shard, message);
+        break;
+    case ShardMessage::TRADE:
+        charge(shard, shard.keys.size());
+        deliver_trade(shard, message);
+        break;
+    case ShardMessage::CANCELLED:
+        charge(shard, 1);
+        if (Order* order = const_cast<Order*>(shard.engine->find_order(message.owner))) {
+            order->status = OrderStatus::CANCELLED;
+        }
+        break;
+    }
+}
+
+void ParallelRun::arrive(Shard& shard, const ShardMessage& message) {
+    TickEngine& engine = *shard.engine;
+    OrderBook* book = engine.get_order_book(message.symbol);
+    if (!book) {
+        book = engine.get_or_create_book(SymbolRegistry::instance().get_symbol(message.symbol));
+    }
+
+    OrderHandle handle = engine.new_order(message.order);
+    size_t slot = handle_slot(handle);
+    if (shard.owner_of.size() < engine.order_pool_.capacity()) {
+        shard.owner_of.resize(engine.order_pool_.capacity());
+    }
+    shard.owner_of[slot] = OwnerRef{message.from, static_cast<uint32_t>(message.a), message.owner};
+    auto& by_owner = shard.by_owner[message.from];
+    if (by_owner.size() <= handle_slot(message.owner)) {
+        by_owner.resize(handle_slot(message.owner) + 1);
+    }
+    by_owner[handle_slot(message.owner)] = {message.owner, handle};
+
+    shard.touched.push_back(handle);
+    engine.enter_order(engine.order_pool_.at(slot), book);
+    retire_touched(shard);
+}
+
+void ParallelRun::arrive_cancel(Shard& shard, const ShardMessage& message) {
+    auto& by_owner = shard.by_owner[message.from];
+    size_t owner_slot = handle_slot(message.owner);
+    if (owner_slot >= by_owner.size() || by_owner[owner_slot].first != message.owner) return;
+
+    // Filled or cancelled in the meantime: nothing to do
+    TickEngine& engine = *shard.engine;
+    OrderHandle handle = by_owner[owner_slot].second;
+    Order* order = const_cast<Order*>(engine.find_order(handle));
+    if (!order) return;
+
+    OrderBook* book = engine.book_of(handle_slot(handle));
+    if (book->cancel_order(order)) {
+        engine.fingerprint_.record(book->symbol_id(), RunFingerprint::CANCEL,
+                                   static_cast<uint64_t>(order->price), static_cast<uint64_t>(order->remaining()),
+                                   order->user_id, engine.current_time_);
+        engine.stats_.fingerprint = engine.fingerprint_.value();
+    }
+    shard.touched.push_back(handle);
+    retire_touched(shard);
+}
+
+// Book records stay alive while their book can still reference them.
+// Closed ones are released after the operation that closed them (never
+// from inside the trade callback); cancellations are reported to the owner.
+void ParallelRun::retire_touched(Shard& shard) {
+    TickEngine& engine = *shard.engine;
+    for (OrderHandle handle : shard.touched) {
+        const Order* order = engine.find_order(handle);
+        if (!order || order->is_open()) continue;
+
+        size_t slot = handle_slot(handle);
+        const OwnerRef& owner = shard.owner_of[slot];
+        SymbolId symbol = engine.order_symbols_[slot];
+        if (order->status == OrderStatus::CANCELLED) {
+            ShardMessage message;
+            message.time = engine.current_time_ + latency_;
+            message.a = symbol;
+            message.b = shard.report_seq[symbol]++;
+            message.kind = ShardMessage::CANCELLED;
+            message.from = engine.shard_;
+            message.symbol = symbol;
+            message.owner = owner.handle;
+            send(shard, owner.shard, message);
+        }
+        auto& entry = shard.by_owner[owner.shard][handle_slot(owner.handle)];
+        if (entry.first == owner.handle) entry = {};
+        engine.order_pool_.release(slot);
+    }
+    shard.touched.clear();
+}
+
+void ParallelRun::report_trade(TickEngine& engine, const Trade& trade, SymbolId symbol) {
+    Shard& shard = shards_[engine.shard_];
+    charge(shard, 1);
+    ++shard.symbol_work[symbol];
+    const OwnerRef& buy = shard.owner_of[handle_slot(trade.buy_order_id)];
+    const OwnerRef& sell = shard.owner_of[handle_slot(trade.sell_order_id)];
+
+    ShardMessage message;
+    message.time = engine.current_time_ + latency_;
+    message.a = symbol;
+    message.b = shard.report_seq[symbol]++;
+    message.kind = ShardMessage::TRADE;
+    message.from = engine.shard_;
+    message.symbol = symbol;
+    message.trade = trade;
+    message.trade.buy_order_id = buy.handle;
+    message.trade.sell_order_id = sell.handle;
+    message.buy_shard = buy.shard;
+    message.sell_shard = sell.shard;
+    message.buy_key = buy.key;
+    message.sell_key = sell.key;
+    for (uint32_t to = 0; to < shards_.size(); ++to) {
+        send(shard, to, message);
+    }
+    shard.touched.push_back(trade.buy_order_id);
+    shard.touched.push_back(trade.sell_order_id);
+}
+
+// Every strategy sees every trade, with only its own order ids filled in;
+// the owner records take the fill after the callbacks, as in a serial run
+void ParallelRun::deliver_trade(Shard& shard, const ShardMessage& message) {
+    TickEngine& engine = *shard.engine;
+    uint32_t k = engine.shard_;
+    for (uint32_t i = 0; i < shard.keys.size(); ++i) {
+        Trade trade = message.trade;
+        if (message.buy_key != shard.keys[i]) trade.buy_order_id = 0;
+        if (message.sell_key != shard.keys[i]) trade.sell_order_id = 0;
+        Strategy* strategy = engine.strategies_[i].get();
+        engine.active_ = strategy;
+        strategy->on_trade(trade);
+    }
+    engine.active_ = nullptr;
+
+    for (auto [side_shard, handle] : {std::pair{message.buy_shard, message.trade.buy_order_id},
+                                      std::pair{message.sell_shard, message.trade.sell_order_id}}) {
+        if (side_shard != k) continue;
+        Order* order = const_cast<Order*>(engine.find_order(handle));
+        if (!order || order->status == OrderStatus::CANCELLED) continue;
+        order->filled += message.trade.quantity;
+        order->status = order->filled >= order->quantity ? OrderStatus::FILLED : OrderStatus::PARTIAL;
+    }
+}
+
+// Books without orders carry no pool state, so they can move between
+// shards as a whole. Candidates are listed busiest first.
+void ParallelRun::publish_candidates(Shard& shard, uint32_t parity) {
+    auto& list = candidates_[parity][shard.engine->shard_];
+    list.clear();
+    for (const auto& [name, book] : shard.engine->order_books_) {
+        SymbolId symbol = book->symbol_id();
+        if (shard.symbol_work[symbol] == 0 || book->bid_volume() > 0 || book->ask_volume() > 0 ||
+            book->pending_stops() > 0) {
+            continue;
+        }
+        list.emplace_back(shard.symbol_work[symbol], symbol);
+    }
+    std::sort(list.begin(), list.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+}
+
+// From the busiest shard to the least busy one, largest books first, while
+// each move still narrows the gap
+std::vector<SymbolId> ParallelRun::plan_migrations(uint32_t parity, uint32_t& from, uint32_t& to) const {
+    const auto& work = work_[parity];
+    from = static_cast<uint32_t>(std::max_element(work.begin(), work.end()) - work.begin());
+    to = static_cast<uint32_t>(std::min_element(work.begin(), work.end()) - work.begin());
+    double mean = 0.0;
+    for (uint64_t w : work) mean += static_cast<double>(w);
+    mean /= static_cast<double>(work.size());
+
+    std::vector<SymbolId> moves;
+    if (from == to || static_cast<double>(work[from]) <= rebalance_threshold_ * mean) return moves;
+    uint64_t budget = (work[from] - work[to]) / 2;
+    for (const auto& [symbol_work, symbol] : candidates_[parity][from]) {
+        if (moves.size() >= max_migrations_) break;
+        if (symbol_work > budget) continue;
+        moves.push_back(symbol);
+        budget -= symbol_work;
+    }
+    return moves;
+}
+
+// Messages sent up to the current window still go to the old owner and
+// arrive before the next window ends, so they are handed over with the
+// books; from the next window on, senders route to the new owner. The
+// second barrier orders the hand-over before the adoption.
+void ParallelRun::migrate(uint32_t k, uint32_t parity, std::barrier<>& sync) {
+    Shard& shard = shards_[k];
+    uint32_t from, to;
+    std::vector<SymbolId> moves = plan_migrations(parity, from, to);
+    shard.work = 0;
+    std::fill(shard.symbol_work.begin(), shard.symbol_work.end(), 0);
+    if (moves.empty()) return;
+
+    for (SymbolId symbol : moves) {
+        shard.route[symbol] = static_cast<uint16_t>(to);
+    }
+    if (k == from) hand_over(shard, moves);
+    sync.arrive_and_wait();
+    if (k == to) adopt(shard);
+    if (k == 0) migrations_ += moves.size();
+}
+
+void ParallelRun::hand_over(Shard& shard, const std::vector<SymbolId>& symbols) {
+    TickEngine& engine = *shard.engine;
+    for (SymbolId symbol : symbols) {
+        Handover handover;
+        handover.name = SymbolRegistry::instance().get_symbol(symbol);
+        handover.symbol = symbol;
+        auto it = engine.order_books_.find(handover.name);
+        handover.book = std::move(it->second);
+        engine.order_books_.erase(it);
+        engine.books_by_id_[symbol] = nullptr;
+        handover.fingerprint = engine.fingerprint_.take(symbol);
+        handover.report_seq = shard.report_seq[symbol];
+        handover_.push_back(std::move(handover));
+    }
+    engine.stats_.fingerprint = engine.fingerprint_.value();
+
+    // Orders and cancels for the moved books: queued here, or still in this
+    // window's mailboxes
+    auto moving = [&](const ShardMessage& message) {
+        return message.kind <= ShardMessage::CANCEL &&
+               std::find(symbols.begin(), symbols.end(), message.symbol) != symbols.end();
+    };
+    auto extract = [&](std::vector<ShardMessage>& messages) {
+        auto kept = std::stable_partition(messages.begin(), messages.end(),
+                                          [&](const ShardMessage& m) { return !moving(m); });
+        handover_messages_.insert(handover_messages_.end(), kept, messages.end());
+        messages.erase(kept, messages.end());
+    };
+    extract(shard.inbox);
+    for (auto& from : mailbox_[shard.parity]) {
+        extract(from[engine.shard_]);
+    }
+}
+
+void ParallelRun::adopt(Shard& shard) {
+    TickEngine& engine = *shard.engine;
+    TickEngine* owner = &engine;
+    for (Handover& handover : handover_) {
+        SymbolId symbol = handover.symbol;
+        // The top-of-book slot stays in the old shard's table, which lives
+        // as long as the run
+        handover.book->set_trade_callback([owner, symbol](const Trade& t) { owner->on_trade(t, symbol); });
+        if (symbol >= engine.books_by_id_.size()) {
+            engine.books_by_id_.resize(symbol + 1, nullptr);
+        }
+        engine.books_by_id_[symbol] = handover.book.get();
+        engine.order_books_.emplace(handover.name, std::move(handover.book));
+        engine.fingerprint_.put(symbol, handover.fingerprint);
+        shard.report_seq[symbol] = handover.report_seq;
+    }
+    engine.stats_.fingerprint = engine.fingerprint_.value();
+    handover_.clear();
+
+    shard.inbox.insert(shard.inbox.end(), handover_messages_.begin(), handover_messages_.end());
+    std::sort(shard.inbox.begin(), shard.inbox.end());
+    handover_messages_.clear();
+}
+
+OrderHandle TickEngine::parallel_submit(const Order& order, SymbolId symbol) {
+    return parallel_->submit(*this, order, symbol);
+}
+
+bool TickEngine::parallel_cancel(OrderHandle handle) {
+    return parallel_->cancel(*this, handle);
+}
+
+void TickEngine::parallel_trade(const Trade& trade, SymbolId symbol) {
+    parallel_->report_trade(*this, trade, symbol);
+}
+
+void TickEngine::run_backtest(const std::vector<Tick>& ticks, const ParallelConfig& config) {
+    ParallelRun run(*this, ticks, config);
+    run.run();
+}
+
+} // namespace trading
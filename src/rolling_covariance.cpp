@@ -0,0 +1,125 @@
+#include "rolling_covariance.hpp"
+#include "cpu_dispatch.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace trading {
+
+RollingCovariance::RollingCovariance(size_t symbols, size_t window, WorkerPool* pool)
+    : n_(symbols),
+      padded_((symbols + TILE - 1) / TILE * TILE),
+      tiles_(padded_ / TILE),
+      window_(window ? window : 1),
+      pool_(pool),
+      ring_(window_ * padded_, 0.0),
+      mean_(padded_, 0.0),
+      moments_(tiles_ * (tiles_ + 1) / 2 * TILE * TILE, 0.0),
+      u_(padded_, 0.0),
+      v_(padded_, 0.0) {}
+
+void RollingCovariance::add(const double* returns) {
+    double* slot = &ring_[head_ * padded_];
+
+    if (count_ < window_) {
+        // Growing: moments += n/(n+1) * d d^T, d = x - mean
+        double n = static_cast<double>(count_);
+        for (size_t i = 0; i < n_; ++i) {
+            u_[i] = returns[i] - mean_[i];
+            mean_[i] += u_[i] / (n + 1);
+        }
+        rank2_update(n / (n + 1), u_.data(), 0.0, u_.data());
+        ++count_;
+    } else if (window_ > 1) {
+        // Sliding: downdate the evicted bar and add the new one in one pass.
+        //   u = old - mean,  mean' = mean - u/(n-1),  moments -= n/(n-1) u u^T
+        //   v = x - mean',   mean'' = mean' + v/n,    moments += (n-1)/n v v^T
+        double n = static_cast<double>(window_);
+        for (size_t i = 0; i < n_; ++i) {
+            u_[i] = slot[i] - mean_[i];
+            double without = mean_[i] - u_[i] / (n - 1);
+            v_[i] = returns[i] - without;
+            mean_[i] = without + v_[i] / n;
+        }
+        rank2_update(-n / (n - 1), u_.data(), (n - 1) / n, v_.data());
+    } else {
+        std::copy(returns, returns + n_, mean_.begin());  // Single-bar window
+    }
+
+    std::copy(returns, returns + n_, slot);
+    head_ = (head_ + 1) % window_;
+}
+
+void RollingCovariance::rank2_update(double a, const double* u, double b, const double* v) {
+    const KernelTable& k = kernels();
+    auto update_tile_row = [&](size_t ti) {
+        size_t rows = std::min(TILE, n_ - ti * TILE);
+        for (size_t tj = ti; tj < tiles_; ++tj) {
+            double* tile = &moments_[tile_index(ti, tj) * TILE * TILE];
+            const double* u_cols = u + tj * TILE;
+            const double* v_cols = v + tj * TILE;
+            for (size_t r = 0; r < rows; ++r) {
+                size_t i = ti * TILE + r;
+                k.rank2_update_f64(tile + r * TILE, a * u[i], u_cols, b * v[i], v_cols, TILE);
+            }
+        }
+    };
+
+    if (pool_ && tiles_ > 1) {
+        pool_->parallel_for(tiles_, update_tile_row);
+    } else {
+        for (size_t ti = 0; ti < tiles_; ++ti) update_tile_row(ti);
+    }
+}
+
+double RollingCovariance::comoment(size_t i, size_t j) const {
+    if (i > j) std::swap(i, j);
+    const double* tile = &moments_[tile_index(i / TILE, j / TILE) * TILE * TILE];
+    return tile[(i % TILE) * TILE + j % TILE];
+}
+
+double RollingCovariance::covariance(size_t i, size_t j) const {
+    return count_ > 1 ? comoment(i, j) / static_cast<double>(count_ - 1) : 0.0;
+}
+
+double RollingCovariance::correlation(size_t i, size_t j) const {
+    double denom = std::sqrt(comoment(i, i) * comoment(j, j));
+    return denom > 0.0 ? comoment(i, j) / denom : 0.0;
+}
+
+void RollingCovariance::covariance_matrix(double* out) const {
+    for (size_t i = 0; i < n_; ++i) {
+        for (size_t j = i; j < n_; ++j) {
+            out[i * n_ + j] = out[j * n_ + i] = covariance(i, j);
+        }
+    }
+}
+
+void RollingCovariance::correlation_matrix(double* out) const {
+    std::vector<double> scale(n_);
+    for (size_t i = 0; i < n_; ++i) {
+        double var = comoment(i, i);
+        scale[i] = var > 0.0 ? 1.0 / std::sqrt(var) : 0.0;
+    }
+    for (size_t i = 0; i < n_; ++i) {
+        for (size_t j = i; j < n_; ++j) {
+            out[i * n_ + j] = out[j * n_ + i] = comoment(i, j) * scale[i] * scale[j];
+        }
+    }
+}
+
+void RollingCovariance::recompute() {
+    size_t bars = count_;
+    size_t oldest = (head_ + window_ - bars) % window_;
+    std::vector<double> history(ring_);
+
+    std::fill(mean_.begin(), mean_.end(), 0.0);
+    std::fill(moments_.begin(), moments_.end(), 0.0);
+    count_ = 0;
+    head_ = 0;
+    for (size_t b = 0; b < bars; ++b) {
+        add(&history[((oldest + b) % window_) * padded_]);
+    }
+}
+
+} // namespace trading
@@ -0,0 +1,98 @@
+#include "shard_planner.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace trading {
+
+namespace {
+
+double max_over_mean(const std::vector<double>& load) {
+    double total = std::accumulate(load.begin(), load.end(), 0.0);
+    if (load.empty() || total <= 0.0) return 1.0;
+    return *std::max_element(load.begin(), load.end()) * static_cast<double>(load.size()) / total;
+}
+
+} // namespace
+
+ActivityProfile measure_activity(const std::vector<Tick>& ticks) {
+    auto& registry = SymbolRegistry::instance();
+    ActivityProfile activity;
+    const std::string* last = nullptr;
+    SymbolId symbol = 0;
+    for (const Tick& tick : ticks) {
+        if (!last || tick.symbol != *last) {  // Runs of one symbol skip the hash lookup
+            symbol = registry.register_symbol(tick.symbol);
+            last = &tick.symbol;
+        }
+        if (symbol >= activity.size()) activity.resize(symbol + 1);
+        ++activity[symbol].ticks;
+    }
+    return activity;
+}
+
+ActivityProfile load_activity_csv(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("could not open activity metadata " + path);
+    }
+
+    auto& registry = SymbolRegistry::instance();
+    ActivityProfile activity;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t first = line.find(',');
+        if (first == std::string::npos) continue;
+        size_t second = line.find(',', first + 1);
+        std::string ticks = line.substr(first + 1, second == std::string::npos ? std::string::npos
+                                                                                : second - first - 1);
+        if (ticks.empty() || !std::isdigit(static_cast<unsigned char>(ticks[0]))) continue;  // Header
+
+        SymbolId symbol = registry.register_symbol(line.substr(0, first));
+        if (symbol >= activity.size()) activity.resize(symbol + 1);
+        activity[symbol].ticks = std::stoull(ticks);
+        if (second != std::string::npos) {
+            activity[symbol].orders = std::stoull(line.substr(second + 1));
+        }
+    }
+    return activity;
+}
+
+ShardPlan plan_shards(const ActivityProfile& activity, size_t shards, const ShardCostModel& model) {
+    shards = std::max<size_t>(shards, 1);
+    std::vector<std::pair<double, SymbolId>> costs;
+    costs.reserve(activity.size());
+    for (SymbolId s = 0; s < activity.size(); ++s) {
+        costs.emplace_back(model.cost(activity[s]), s);
+    }
+    std::sort(costs.begin(), costs.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    ShardPlan plan;
+    plan.shard_of.assign(activity.size(), 0);
+    plan.load.assign(shards, 0.0);
+    for (const auto& [cost, symbol] : costs) {
+        size_t lightest = std::min_element(plan.load.begin(), plan.load.end()) - plan.load.begin();
+        plan.shard_of[symbol] = static_cast<uint16_t>(lightest);
+        plan.load[lightest] += cost;
+    }
+    plan.balance_factor = max_over_mean(plan.load);
+    return plan;
+}
+
+double balance_factor(const ActivityProfile& activity, const std::vector<uint16_t>& shard_of,
+                      size_t shards, const ShardCostModel& model) {
+    shards = std::max<size_t>(shards, 1);
+    std::vector<double> load(shards, 0.0);
+    for (SymbolId s = 0; s < activity.size(); ++s) {
+        size_t shard = s < shard_of.size() ? shard_of[s] : s % shards;
+        if (shard >= shards) throw std::logic_error("shard_of names a missing shard");
+        load[shard] += model.cost(activity[s]);
+    }
+    return max_over_mean(load);
+}
+
+} // namespace trading
@@ -0,0 +1,123 @@
+#include "order_book.hpp"
+#include "book_diff.hpp"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <string>
+
+using namespace trading;
+
+// Candidate with an injected defect: cancels of 7-lot orders are acknowledged
+// but the order stays in the book. Used to prove the harness and shrinker.
+class LeakyCancelBook : public OrderBook {
+public:
+    using OrderBook::OrderBook;
+    
+    bool cancel_order(Order* order) {
+        if (order->quantity == 7 && order->status == OrderStatus::PENDING) {
+            order->status = OrderStatus::CANCELLED;
+            return true;
+        }
+        return OrderBook::cancel_order(order);
+    }
+};
+
+void test_identical_books_agree(uint64_t ops, uint64_t seed) {
+    std::cout << "Testing reference vs candidate over " << ops << " random ops...\n";
+    
+    BookOpGenerator::Config config;
+    config.seed = seed;
+    BookOpGenerator generator(config);
+    DifferentialHarness<OrderBook, OrderBook> harness;
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    auto divergence = harness.run(generator, ops);
+    auto end = std::chrono::high_resolution_clock::now();
+    double secs = std::chrono::duration<double>(end - start).count();
+    
+    if (divergence) {
+        std::cerr << "  Divergence at step " << divergence->step << ": " << divergence->what << "\n";
+        auto repro = harness.shrink(DifferentialHarness<OrderBook, OrderBook>::record(config, divergence->step + 1));
+        save_book_ops("book_diff_repro.csv", repro);
+        std::cerr << "  Minimal reproducer (" << repro.size() << " ops) saved to book_diff_repro.csv\n";
+    }
+    assert(!divergence);
+    
+    std::cout << "  ✓ " << harness.steps_compared() << " steps compared, "
+              << static_cast<uint64_t>(ops / secs) << " ops/sec\n";
+    std::cout << "✅ Lockstep agreement: PASSED\n\n";
+}
+
+void test_shrinks_injected_bug() {
+    std::cout << "Testing divergence detection and shrinking...\n";
+    
+    BookOpGenerator::Config config;
+    config.seed = 7;
+    BookOpGenerator generator(config);
+    DifferentialHarness<OrderBook, LeakyCancelBook> harness;
+    
+    auto divergence = harness.run(generator, 1000000);
+    assert(divergence);
+    std::cout << "  Diverged at step " << divergence->step << ": " << divergence->what << "\n";
+    
+    auto ops = DifferentialHarness<OrderBook, LeakyCancelBook>::record(config, divergence->step + 1);
+    auto repro = harness.shrink(ops);
+    assert(harness.run(repro));
+    
+    // The defect needs exactly a 7-lot resting order and its cancel
+    assert(repro.size() == 2);
+    assert(repro[0].type == BookOpType::ADD && repro[0].quantity == 7);
+    assert(repro[1].type == BookOpType::CANCEL && repro[1].ref == repro[0].ref);
+    
+    // Reproducers round-trip through the ops file
+    const char* path = "test_book_diff_repro.csv";
+    assert(save_book_ops(path, repro));
+    auto loaded = load_book_ops(path);
+    std::remove(path);
+    assert(loaded.size() == repro.size());
+    assert(harness.run(loaded));
+    
+    std::cout << "  ✓ Shrunk " << ops.size() << " ops to " << repro.size() << "\n";
+    
+    // Sparse refs from a shrunk stream must not evict each other on replay
+    std::vector<BookOp> sparse = {
+        {BookOpType::ADD, Side::BUY, 1, 0, 990000, 7},
+        {BookOpType::ADD, Side::BUY, 2, 4, 980000, 5},
+        {BookOpType::CANCEL, Side::BUY, 1, 0, 0, 0},
+    };
+    assert(harness.run(sparse));
+    std::cout << "  ✓ Replay keeps every order of a sparse-ref reproducer addressable\n";
+    std::cout << "✅ Divergence shrinking: PASSED\n\n";
+}
+
+// Usage: test_differential [ops] [seed]     stream random ops
+//        test_differential --replay ops.csv replay a recorded sequence
+int main(int argc, char** argv) {
+    std::cout << "=== Differential Order Book Tests ===\n\n";
+    
+    try {
+        if (argc > 2 && std::string(argv[1]) == "--replay") {
+            auto ops = load_book_ops(argv[2]);
+            DifferentialHarness<OrderBook, OrderBook> harness;
+            auto divergence = harness.run(ops);
+            if (divergence) {
+                std::cerr << "❌ Divergence at step " << divergence->step << ": " << divergence->what << "\n";
+                return 1;
+            }
+            std::cout << "Replayed " << ops.size() << " ops without divergence\n";
+            return 0;
+        }
+        
+        uint64_t ops = argc > 1 ? std::stoull(argv[1]) : 500000;
+        uint64_t seed = argc > 2 ? std::stoull(argv[2]) : 42;
+        
+        test_identical_books_agree(ops, seed);
+        test_shrinks_injected_bug();
+        
+        std::cout << "=== ALL DIFFERENTIAL TESTS PASSED ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ TEST FAILED: " << e.what() << "\n";
+        return 1;
+    }
+}
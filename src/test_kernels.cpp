@@ -0,0 +1,174 @@
+#include "cpu_dispatch.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace trading;
+
+// Every tier compiled into the binary must agree with the scalar reference
+void test_kernels_match_scalar() {
+    std::cout << "Testing SIMD kernels against scalar reference...\n";
+    
+    const KernelTable& ref = kernel_table(CpuLevel::SCALAR);
+    std::mt19937_64 rng(7);
+    
+    for (int l = 0; l <= static_cast<int>(CpuLevel::AVX512); ++l) {
+        CpuLevel level = static_cast<CpuLevel>(l);
+        if (!cpu_level_supported(level)) continue;
+        const KernelTable& k = kernel_table(level);
+        assert(k.level == level);
+        
+        // Odd lengths exercise every tail path
+        for (size_t n : {0, 1, 3, 7, 8, 15, 17, 63, 64, 65, 1000, 4099}) {
+            std::vector<int64_t> values(n);
+            for (auto& v : values) v = static_cast<int64_t>(rng());
+            
+            assert(k.sum_i64(values.data(), n) == ref.sum_i64(values.data(), n));
+            
+            std::vector<int64_t> expected(n), actual(n);
+            ref.prefix_sum_i64(values.data(), expected.data(), n);
+            k.prefix_sum_i64(values.data(), actual.data(), n);
+            assert(actual == expected);
+            
+            // In-place scan
+            k.prefix_sum_i64(values.data(), values.data(), n);
+            assert(values == expected);
+            
+            // Bit-identical across tiers (no FMA contraction)
+            std::vector<double> x(n), y(n), row(n);
+            for (size_t i = 0; i < n; ++i) {
+                x[i] = static_cast<double>(static_cast<int32_t>(rng())) * 1e-9;
+                y[i] = static_cast<double>(static_cast<int32_t>(rng())) * 1e-9;
+                row[i] = static_cast<double>(static_cast<int32_t>(rng())) * 1e-6;
+            }
+            std::vector<double> row_ref = row;
+            ref.rank2_update_f64(row_ref.data(), 0.75, x.data(), -1.25, y.data(), n);
+            k.rank2_update_f64(row.data(), 0.75, x.data(), -1.25, y.data(), n);
+            assert(row == row_ref);
+            
+            std::string text(n, 'a');
+            assert(k.find_byte(text.data(), n, ',') == n);
+            if (n > 0) {
+                size_t pos = rng() % n;
+                text[pos] = ',';
+                if (pos + 1 < n) text[n - 1] = ',';
+                assert(k.find_byte(text.data(), n, ',') == pos);
+            }
+        }
+        std::cout << "  ✓ " << k.name << "\n";
+    }
+    
+    std::cout << "✅ Kernels match scalar: PASSED\n\n";
+}
+
+// A strip of strikes and expiries, calls and puts, from deep ITM to deep
+// OTM; the far wings hit the continued-fraction branch of the normal CDF
+struct OptionGrid {
+    std::vector<double> strike, time, vol, sign, value, delta, gamma, vega;
+    
+    explicit OptionGrid(size_t n) : strike(n), time(n), vol(n), sign(n),
+                                    value(n), delta(n), gamma(n), vega(n) {
+        for (size_t i = 0; i < n; ++i) {
+            strike[i] = 40.0 + 5.0 * static_cast<double>(i % 25);
+            time[i] = 0.002 + 0.25 * static_cast<double>((i / 25) % 9);
+            vol[i] = 0.05 + 0.05 * static_cast<double>(i % 225 % 7);
+            sign[i] = (i / 225) % 2 ? -1.0 : 1.0;  // Puts repeat the calls' grid
+        }
+    }
+    
+    OptionBatch batch() {
+        return OptionBatch{strike.data(), time.data(), vol.data(), sign.data(),
+                           value.data(), delta.data(), gamma.data(), vega.data()};
+    }
+};
+
+bool close(double actual, double expected, double tolerance) {
+    return std::fabs(actual - expected) <= tolerance * std::max(1.0, std::fabs(expected));
+}
+
+void test_black_scholes_kernels() {
+    std::cout << "Testing Black-Scholes kernels...\n";
+    
+    const double spot = 100.0;
+    const double rate = 0.03;
+    
+    // Scalar kernel against the closed form with libm
+    OptionGrid grid(500);
+    kernel_table(CpuLevel::SCALAR).black_scholes_f64(spot, rate, grid.batch(), grid.strike.size());
+    for (size_t i = 0; i < grid.strike.size(); ++i) {
+        double k = grid.strike[i], t = grid.time[i], v = grid.vol[i], w = grid.sign[i];
+        double vs = v * std::sqrt(t);
+        double d1 = (std::log(spot / k) + (rate + 0.5 * v * v) * t) / vs;
+        double d2 = d1 - vs;
+        auto cdf = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+        double pdf = std::exp(-0.5 * d1 * d1) / std::sqrt(2.0 * std::numbers::pi);
+        double value = w * (spot * cdf(w * d1) - k * std::exp(-rate * t) * cdf(w * d2));
+        assert(close(grid.value[i], value, 1e-10));
+        assert(close(grid.delta[i], w * cdf(w * d1), 1e-10));
+        assert(close(grid.gamma[i], pdf / (spot * vs), 1e-10));
+        assert(close(grid.vega[i], spot * pdf * std::sqrt(t), 1e-10));
+    }
+    
+    // Put-call parity: C - P = S - K e^(-rT), delta_C - delta_P = 1
+    for (size_t i = 0; i < 225; ++i) {
+        size_t put = i + 225;
+        double forward = spot - grid.strike[i] * std::exp(-rate * grid.time[i]);
+        assert(std::fabs(grid.value[i] - grid.value[put] - forward) < 1e-9);
+        assert(std::fabs(grid.delta[i] - grid.delta[put] - 1.0) < 1e-12);
+    }
+    
+    // Every tier against scalar, including tails
+    for (int l = 0; l <= static_cast<int>(CpuLevel::AVX512); ++l) {
+        CpuLevel level = static_cast<CpuLevel>(l);
+        if (!cpu_level_supported(level)) continue;
+        const KernelTable& k = kernel_table(level);
+        for (size_t n : {0, 1, 3, 4, 5, 8, 13, 500}) {
+            OptionGrid expected(n), actual(n);
+            kernel_table(CpuLevel::SCALAR).black_scholes_f64(spot, rate, expected.batch(), n);
+            k.black_scholes_f64(spot, rate, actual.batch(), n);
+            for (size_t i = 0; i < n; ++i) {
+                assert(close(actual.value[i], expected.value[i], 1e-12));
+                assert(close(actual.delta[i], expected.delta[i], 1e-12));
+                assert(close(actual.gamma[i], expected.gamma[i], 1e-12));
+                assert(close(actual.vega[i], expected.vega[i], 1e-12));
+            }
+        }
+        std::cout << "  ✓ " << k.name << "\n";
+    }
+    
+    std::cout << "✅ Black-Scholes kernels: PASSED\n\n";
+}
+
+void test_dispatch_selection() {
+    std::cout << "Testing runtime dispatch selection...\n";
+    
+    CpuLevel detected = detect_cpu_level();
+    assert(cpu_level_supported(CpuLevel::SCALAR));
+    assert(cpu_level_supported(detected));
+    assert(kernels().level <= detected);
+    
+    std::cout << "  Detected: " << cpu_level_name(detected)
+              << ", selected: " << kernels().name << "\n";
+    std::cout << "✅ Dispatch selection: PASSED\n\n";
+}
+
+int main() {
+    std::cout << "=== SIMD Kernel Tests ===\n\n";
+    
+    try {
+        test_kernels_match_scalar();
+        test_black_scholes_kernels();
+        test_dispatch_selection();
+        
+        std::cout << "=== ALL KERNEL TESTS PASSED ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ TEST FAILED: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,6 +1,15 @@
 #include "order_book.hpp"
+#include "implied_book.hpp"
+#include "l3_replay.hpp"
 #include <iostream>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <random>
 
 using namespace trading;
 
@@ -106,6 +115,819 @@ void test_fifo_ordering() {
     std::cout << "✅ FIFO price-time priority: PASSED\n\n";
 }
 
+void test_cancel_order() {
+    std::cout << "Testing order cancellation...\n";
+    
+    OrderBook book("TEST");
+    
+    Order sell1(1, 1000000, 100, 1000, Side::SELL, OrderType::LIMIT, 1);
+    Order sell2(2, 1000000, 100, 2000, Side::SELL, OrderType::LIMIT, 2);
+    book.add_order(&sell1);
+    book.add_order(&sell2);
+    
+    assert(book.cancel_order(&sell1));
+    assert(sell1.status == OrderStatus::CANCELLED);
+    assert(book.ask_volume() == 100);
+    assert(!book.cancel_order(&sell1));  // Already gone
+    
+    // Cancelled order no longer participates in matching
+    Order buy(3, 1000000, 50, 3000, Side::BUY, OrderType::LIMIT, 3);
+    book.add_order(&buy);
+    assert(sell1.filled == 0);
+    assert(sell2.filled == 50);
+    
+    // Cancelling the last order removes the level
+    assert(book.cancel_order(&sell2));
+    assert(book.ask_volume() == 0);
+    assert(book.best_ask() == 0);
+    
+    std::cout << "  ✓ Cancelled orders leave the queue\n";
+    std::cout << "✅ Order cancellation: PASSED\n\n";
+}
+
+void test_depth_snapshot() {
+    std::cout << "Testing depth snapshot...\n";
+    
+    OrderBook book("TEST");
+    
+    Order bid1(1, 990000, 100, 1000, Side::BUY, OrderType::LIMIT, 1);
+    Order bid2(2, 995000, 200, 1000, Side::BUY, OrderType::LIMIT, 1);
+    Order ask1(3, 1005000, 300, 1000, Side::SELL, OrderType::LIMIT, 2);
+    book.add_order(&bid1);
+    book.add_order(&bid2);
+    book.add_order(&ask1);
+    
+    assert(book.best_bid() == 995000);  // Highest bid, not lowest
+    
+    Price prices[3];
+    Quantity quantities[3];
+    assert(book.depth(Side::BUY, 3, prices, quantities) == 2);
+    assert(prices[0] == 995000 && quantities[0] == 200);
+    assert(prices[1] == 990000 && quantities[1] == 100);
+    assert(book.depth(Side::SELL, 3, prices, quantities) == 1);
+    assert(prices[0] == 1005000 && quantities[0] == 300);
+    
+    std::cout << "  ✓ Levels reported best-first\n";
+    std::cout << "✅ Depth snapshot: PASSED\n\n";
+}
+
+void test_top_of_book_publish() {
+    std::cout << "Testing seqlocked top-of-book publishing...\n";
+    
+    OrderBook book("TEST");
+    TopOfBookSlot slot;
+    book.set_top_of_book_slot(&slot);
+    
+    Order bid(1, 995000, 200, 1000, Side::BUY, OrderType::LIMIT, 1);
+    Order ask1(2, 1005000, 100, 2000, Side::SELL, OrderType::LIMIT, 2);
+    Order ask2(3, 1010000, 300, 2000, Side::SELL, OrderType::LIMIT, 2);
+    book.add_order(&bid);
+    book.add_order(&ask1);
+    book.add_order(&ask2);
+    
+    Order sweep(4, 0, 150, 3000, Side::BUY, OrderType::MARKET, 3);
+    book.add_order(&sweep);
+    
+    TopOfBookSnapshot snap = slot.read();
+    assert(snap.bid == 995000 && snap.bid_quantity == 200);
+    assert(snap.ask == 1010000 && snap.ask_quantity == 250);
+    assert(snap.last_price == 1010000 && snap.last_quantity == 50);
+    assert(snap.bid_total == 200 && snap.ask_total == 250);
+    assert(snap.timestamp == 3000);
+    std::cout << "  ✓ Snapshot reflects book after sweep\n";
+    
+    TopOfBookTable table(4);
+    table.slot(1)->publish(snap);
+    assert(table.read(1).ask == 1010000);
+    assert(table.slot(4) == nullptr && table.read(4).timestamp == 0 && table.read(4).bid == 0);
+    std::cout << "  ✓ Table reads past its capacity return an empty snapshot\n";
+    
+    // Concurrent reader must never observe a torn snapshot
+    TopOfBookSlot shared;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            TopOfBookSnapshot s = shared.read();
+            assert(s.bid == s.ask && s.ask == s.bid_total && s.bid_total == s.ask_total);
+        }
+    });
+    for (int64_t i = 0; i < 200000; ++i) {
+        TopOfBookSnapshot s;
+        s.bid = s.ask = s.bid_total = s.ask_total = i;
+        shared.publish(s);
+    }
+    done = true;
+    reader.join();
+    assert(shared.version() == 200000);
+    std::cout << "  ✓ No torn reads under concurrent publish\n";
+    
+    std::cout << "✅ Top-of-book publishing: PASSED\n\n";
+}
+
+void test_auction_uncross() {
+    std::cout << "Testing auction uncross...\n";
+    
+    OrderBook book("TEST");
+    book.start_auction();
+    
+    // Crossing orders accumulate without matching
+    Order bid1(1, 1010000, 100, 1000, Side::BUY, OrderType::LIMIT, 1);
+    Order bid2(2, 1000000, 200, 2000, Side::BUY, OrderType::LIMIT, 2);
+    Order ask1(3, 990000, 150, 3000, Side::SELL, OrderType::LIMIT, 3);
+    Order ask2(4, 1000000, 100, 4000, Side::SELL, OrderType::LIMIT, 4);
+    for (Order* o : {&bid1, &bid2, &ask1, &ask2}) book.add_order(o);
+    assert(book.total_trades() == 0);
+    assert(book.best_bid() > book.best_ask());
+    
+    // Executable volume: 150 @ 99, 250 @ 100, 100 @ 101
+    AuctionResult indicative = book.indicative_uncross();
+    assert(indicative.price == 1000000);
+    assert(indicative.volume == 250);
+    assert(indicative.imbalance == 50);
+    
+    AuctionResult result = book.uncross();
+    assert(result.price == 1000000 && result.volume == 250);
+    assert(book.phase() == TradingPhase::CONTINUOUS);
+    assert(bid1.status == OrderStatus::FILLED);
+    assert(bid2.status == OrderStatus::PARTIAL && bid2.filled == 150);
+    assert(ask1.status == OrderStatus::FILLED && ask2.status == OrderStatus::FILLED);
+    assert(book.bid_volume() == 50 && book.ask_volume() == 0);
+    assert(book.best_bid() == 1000000 && book.last_trade_price() == 1000000);
+    std::cout << "  ✓ Maximum volume at 100.00, residual rests in price-time order\n";
+    
+    // Market orders rank ahead of limits; unfilled ones are cancelled
+    book.start_auction();
+    Order mkt_buy(5, 0, 80, 5000, Side::BUY, OrderType::MARKET, 5);
+    Order mkt_sell(6, 0, 10, 6000, Side::SELL, OrderType::MARKET, 6);
+    Order ask3(7, 1010000, 40, 7000, Side::SELL, OrderType::LIMIT, 7);
+    for (Order* o : {&mkt_buy, &mkt_sell, &ask3}) book.add_order(o);
+    assert(mkt_buy.status == OrderStatus::PENDING);
+    assert(book.cancel_order(&mkt_sell));
+    
+    result = book.uncross();
+    assert(result.price == 1010000 && result.volume == 40);
+    assert(mkt_buy.filled == 40 && mkt_buy.status == OrderStatus::CANCELLED);
+    assert(bid2.filled == 150);  // Market order took priority
+    assert(book.ask_volume() == 0 && book.bid_volume() == 50);
+    std::cout << "  ✓ Market orders execute first\n";
+    
+    std::cout << "✅ Auction uncross: PASSED\n\n";
+}
+
+void test_auction_tie_breaks() {
+    std::cout << "Testing auction tie-breaks...\n";
+    
+    auto equilibrium = [](Quantity bid_qty, Quantity ask_qty, Price reference) {
+        OrderBook book("TEST");
+        Order seed_ask(1, reference, 1, 0, Side::SELL, OrderType::LIMIT, 1);
+        Order seed_bid(2, reference, 1, 0, Side::BUY, OrderType::LIMIT, 2);
+        if (reference > 0) {
+            book.add_order(&seed_ask);
+            book.add_order(&seed_bid);
+        }
+        book.start_auction();
+        Order bid(3, 1020000, bid_qty, 1000, Side::BUY, OrderType::LIMIT, 3);
+        Order ask(4, 1000000, ask_qty, 2000, Side::SELL, OrderType::LIMIT, 4);
+        book.add_order(&bid);
+        book.add_order(&ask);
+        return book.indicative_uncross().price;
+    };
+    
+    // Same volume and imbalance at 100 and 102: surplus side sets the price
+    assert(equilibrium(300, 100, 0) == 1020000);
+    assert(equilibrium(100, 300, 0) == 1000000);
+    std::cout << "  ✓ Market pressure\n";
+    
+    // Balanced: closest to the reference price, lower on equal distance
+    assert(equilibrium(100, 100, 1019000) == 1020000);
+    assert(equilibrium(100, 100, 1003000) == 1000000);
+    assert(equilibrium(100, 100, 0) == 1000000);
+    std::cout << "  ✓ Reference price\n";
+    
+    std::cout << "✅ Auction tie-breaks: PASSED\n\n";
+}
+
+template<typename Book>
+void fill_level(Book& book, Order* orders, const Quantity* sizes, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        orders[i] = Order(i + 1, 1000000, sizes[i], 1000 * (i + 1), Side::SELL, OrderType::LIMIT, i + 1);
+        book.add_order(&orders[i]);
+    }
+}
+
+void test_pro_rata_allocation() {
+    std::cout << "Testing pro-rata level allocation...\n";
+    
+    const Quantity sizes[] = {100, 300, 600};
+    Order asks[3];
+    
+    ProRataOrderBook book("TEST");
+    fill_level(book, asks, sizes, 3);
+    Order buy(10, 1000000, 100, 5000, Side::BUY, OrderType::LIMIT, 10);
+    book.add_order(&buy);
+    assert(asks[0].filled == 10 && asks[1].filled == 30 && asks[2].filled == 60);
+    assert(buy.status == OrderStatus::FILLED);
+    assert(book.ask_volume() == 900);
+    std::cout << "  ✓ Allocation proportional to resting size\n";
+    
+    // Odd lots go to the earliest orders; allocations sum exactly
+    const Quantity ones[] = {1, 1, 1};
+    ProRataOrderBook odd("TEST");
+    fill_level(odd, asks, ones, 3);
+    Order buy2(11, 1000000, 2, 6000, Side::BUY, OrderType::LIMIT, 11);
+    odd.add_order(&buy2);
+    assert(asks[0].filled == 1 && asks[1].filled == 1 && asks[2].filled == 0);
+    assert(asks[0].status == OrderStatus::FILLED && odd.ask_volume() == 1);
+    
+    // Filled orders leave the queue; the survivor takes the next fill
+    Order buy3(12, 1000000, 1, 7000, Side::BUY, OrderType::LIMIT, 12);
+    odd.add_order(&buy3);
+    assert(asks[2].filled == 1 && odd.ask_volume() == 0 && odd.best_ask() == 0);
+    std::cout << "  ✓ Remainder handled in time priority\n";
+    
+    // Top order first, then pro-rata over the rest
+    FifoProRataOrderBook top("TEST");
+    fill_level(top, asks, sizes, 3);
+    Order buy4(13, 1000000, 400, 8000, Side::BUY, OrderType::LIMIT, 13);
+    top.add_order(&buy4);
+    assert(asks[0].filled == 100 && asks[1].filled == 100 && asks[2].filled == 200);
+    assert(top.ask_volume() == 600);
+    std::cout << "  ✓ FIFO top order then pro-rata\n";
+    
+    // Sweeping a whole level fills everyone and moves on
+    ProRataOrderBook sweep("TEST");
+    fill_level(sweep, asks, sizes, 3);
+    Order far(20, 1010000, 50, 9000, Side::SELL, OrderType::LIMIT, 20);
+    sweep.add_order(&far);
+    Order buy5(14, 1010000, 1020, 10000, Side::BUY, OrderType::LIMIT, 14);
+    sweep.add_order(&buy5);
+    assert(asks[0].status == OrderStatus::FILLED && asks[2].status == OrderStatus::FILLED);
+    assert(far.filled == 20 && sweep.ask_volume() == 30 && sweep.best_ask() == 1010000);
+    
+    std::cout << "✅ Pro-rata allocation: PASSED\n\n";
+}
+
+void test_stop_orders() {
+    std::cout << "Testing stop and stop-limit orders...\n";
+    
+    OrderBook book("TEST");
+    Order ask1(1, 1010000, 10, 1000, Side::SELL, OrderType::LIMIT, 1);
+    Order ask2(2, 1020000, 10, 2000, Side::SELL, OrderType::LIMIT, 1);
+    Order ask3(3, 1030000, 10, 3000, Side::SELL, OrderType::LIMIT, 1);
+    for (Order* o : {&ask1, &ask2, &ask3}) book.add_order(o);
+    
+    Order stop1(4, 0, 10, 4000, Side::BUY, OrderType::STOP, 2);
+    stop1.stop_price = 1010000;
+    Order stop2(5, 0, 10, 5000, Side::BUY, OrderType::STOP, 3);
+    stop2.stop_price = 1020000;
+    Order far_stop(6, 0, 10, 6000, Side::BUY, OrderType::STOP, 4);
+    far_stop.stop_price = 1050000;
+    for (Order* o : {&stop1, &stop2, &far_stop}) book.add_order(o);
+    assert(book.pending_stops() == 3 && book.total_trades() == 0);
+    
+    // A trade at 101 elects stop1, whose fills at 102 elect stop2
+    Order lift(7, 1010000, 5, 7000, Side::BUY, OrderType::LIMIT, 5);
+    book.add_order(&lift);
+    assert(stop1.status == OrderStatus::FILLED && stop1.type == OrderType::MARKET);
+    assert(stop2.status == OrderStatus::FILLED);
+    assert(ask1.status == OrderStatus::FILLED && ask2.status == OrderStatus::FILLED);
+    assert(ask3.filled == 5 && book.last_trade_price() == 1030000);
+    assert(far_stop.status == OrderStatus::PENDING && book.pending_stops() == 1);
+    std::cout << "  ✓ Triggered stops cascade through the book\n";
+    
+    assert(book.cancel_order(&far_stop));
+    assert(book.pending_stops() == 0 && !book.cancel_order(&far_stop));
+    
+    // Sell stop-limit rests at its limit once elected
+    Order protect(8, 1000000, 20, 8000, Side::SELL, OrderType::STOP_LIMIT, 2);
+    protect.stop_price = 1010000;
+    book.add_order(&protect);
+    assert(protect.status == OrderStatus::PENDING && book.bid_volume() == 0);
+    
+    Order bid(9, 1005000, 8, 9000, Side::BUY, OrderType::LIMIT, 6);
+    Order hit(10, 1005000, 3, 10000, Side::SELL, OrderType::LIMIT, 7);
+    book.add_order(&bid);
+    book.add_order(&hit);  // Trade at 100.50 crosses the 101 stop
+    assert(protect.type == OrderType::LIMIT);
+    assert(protect.filled == 5 && bid.status == OrderStatus::FILLED);
+    assert(book.best_ask() == 1000000 && book.ask_volume() == 15 + 5);
+    std::cout << "  ✓ Stop-limit enters at its limit price\n";
+    
+    std::cout << "✅ Stop orders: PASSED\n\n";
+}
+
+void test_self_trade_prevention() {
+    std::cout << "Testing self-trade prevention...\n";
+    
+    // Resting: user 1 (60) then user 2 (40) at 100; aggressor is user 1 buying 80
+    struct Outcome { Quantity bought; OrderStatus aggressor; OrderStatus own_resting; Quantity book_volume; };
+    auto run = [](SelfTradePrevention mode) {
+        OrderBook book("TEST");
+        book.set_self_trade_prevention(mode);
+        Order own(1, 1000000, 60, 1000, Side::SELL, OrderType::LIMIT, 1);
+        Order other(2, 1000000, 40, 2000, Side::SELL, OrderType::LIMIT, 2);
+        Order buy(3, 1000000, 80, 3000, Side::BUY, OrderType::LIMIT, 1);
+        book.add_order(&own);
+        book.add_order(&other);
+        book.add_order(&buy);
+        assert(own.filled == 0 || mode == SelfTradePrevention::NONE);
+        return Outcome{buy.filled, buy.status, own.status, book.ask_volume() + book.bid_volume()};
+    };
+    
+    Outcome none = run(SelfTradePrevention::NONE);
+    assert(none.bought == 80 && none.own_resting == OrderStatus::FILLED);
+    
+    Outcome newest = run(SelfTradePrevention::CANCEL_NEWEST);
+    assert(newest.bought == 0 && newest.aggressor == OrderStatus::CANCELLED);
+    assert(newest.own_resting == OrderStatus::PENDING && newest.book_volume == 100);
+    
+    Outcome oldest = run(SelfTradePrevention::CANCEL_OLDEST);
+    assert(oldest.bought == 40 && oldest.own_resting == OrderStatus::CANCELLED);
+    assert(oldest.aggressor == OrderStatus::PARTIAL && oldest.book_volume == 40);  // Residual bid rests
+    
+    Outcome both = run(SelfTradePrevention::CANCEL_BOTH);
+    assert(both.bought == 0 && both.aggressor == OrderStatus::CANCELLED);
+    assert(both.own_resting == OrderStatus::CANCELLED && both.book_volume == 40);
+    
+    // 80 vs 60: the resting order is cancelled, the aggressor shrinks to 20
+    Outcome decrement = run(SelfTradePrevention::DECREMENT);
+    assert(decrement.bought == 20 && decrement.aggressor == OrderStatus::FILLED);
+    assert(decrement.own_resting == OrderStatus::CANCELLED && decrement.book_volume == 20);
+    std::cout << "  ✓ Cancel-newest, cancel-oldest, cancel-both and decrement\n";
+    
+    // Pro-rata levels apply the same rule to each allocation
+    ProRataOrderBook pro("TEST");
+    pro.set_self_trade_prevention(SelfTradePrevention::CANCEL_OLDEST);
+    Order own(1, 1000000, 50, 1000, Side::SELL, OrderType::LIMIT, 1);
+    Order other(2, 1000000, 50, 2000, Side::SELL, OrderType::LIMIT, 2);
+    Order buy(3, 1000000, 40, 3000, Side::BUY, OrderType::LIMIT, 1);
+    pro.add_order(&own);
+    pro.add_order(&other);
+    pro.add_order(&buy);
+    assert(own.status == OrderStatus::CANCELLED && other.filled == 40);
+    assert(buy.status == OrderStatus::FILLED && pro.ask_volume() == 10);
+    assert(pro.self_trades_prevented() == 1);
+    std::cout << "  ✓ Pro-rata allocation skips own orders\n";
+    
+    std::cout << "✅ Self-trade prevention: PASSED\n\n";
+}
+
+void test_implied_spread() {
+    std::cout << "Testing implied spread matching...\n";
+    
+    OrderBook front("F1"), back("F2"), spread("F1-F2");
+    Order f_bid(1, 1000000, 10, 100, Side::BUY, OrderType::LIMIT, 1);
+    Order f_ask(2, 1001000, 5, 200, Side::SELL, OrderType::LIMIT, 1);
+    Order b_bid(3, 995000, 8, 300, Side::BUY, OrderType::LIMIT, 2);
+    Order b_ask(4, 996000, 20, 400, Side::SELL, OrderType::LIMIT, 2);
+    for (Order* o : {&f_bid, &f_ask}) front.add_order(o);
+    for (Order* o : {&b_bid, &b_ask}) back.add_order(o);
+    
+    ImpliedSpread linked(front, back, spread);
+    assert(linked.implied_in().ask == 6000 && linked.implied_in().ask_quantity == 5);
+    assert(linked.implied_in().bid == 4000 && linked.implied_in().bid_quantity == 10);
+    
+    // Changes below the top do not touch the implieds
+    uint64_t recomputes = linked.recomputes();
+    Order deep(5, 1005000, 50, 500, Side::SELL, OrderType::LIMIT, 1);
+    front.add_order(&deep);
+    assert(linked.recomputes() == recomputes);
+    std::cout << "  ✓ Implied-in quotes from leg tops, recomputed only on top changes\n";
+    
+    // Direct liquidity first at equal price, then implied legs
+    Order s_ask(6, 6000, 3, 600, Side::SELL, OrderType::LIMIT, 9);
+    linked.add_order(&s_ask);
+    Order buy(7, 6000, 6, 700, Side::BUY, OrderType::LIMIT, 7);
+    linked.add_order(&buy);
+    assert(buy.status == OrderStatus::FILLED);
+    assert(s_ask.status == OrderStatus::FILLED);
+    assert(f_ask.filled == 3 && b_bid.filled == 3);
+    assert(linked.implied_fills() == 1);
+    assert(linked.implied_in().ask_quantity == 2);
+    std::cout << "  ✓ Spread buy took direct then implied liquidity atomically\n";
+    
+    // Implied-out: front bid = spread bid + back bid
+    Order s_bid(8, 3000, 4, 800, Side::BUY, OrderType::LIMIT, 9);
+    linked.add_order(&s_bid);
+    assert(linked.implied_out_front().bid == 998000);
+    assert(linked.implied_out_front().bid_quantity == 4);
+    
+    // Sell 12: implied bid (40.00 x 10) beats the direct 30.00 bid
+    Order sell(9, 0, 12, 900, Side::SELL, OrderType::MARKET, 7);
+    linked.add_order(&sell);
+    assert(sell.status == OrderStatus::FILLED);
+    assert(f_bid.status == OrderStatus::FILLED && b_ask.filled == 10);
+    assert(s_bid.filled == 2);
+    assert(linked.implied_in().bid_quantity == 0);
+    std::cout << "  ✓ Spread sell routed by best price across direct and implied\n";
+    
+    // Self-trade prevention on the back book: the user's own bid there caps
+    // the implied fill, so the front leg never trades alone
+    for (SelfTradePrevention mode : {SelfTradePrevention::CANCEL_NEWEST, SelfTradePrevention::DECREMENT}) {
+        OrderBook f("F1"), b("F2"), s("F1-F2");
+        b.set_self_trade_prevention(mode);
+        Order ask(1, 1001000, 5, 100, Side::SELL, OrderType::LIMIT, 1);
+        Order other(2, 995000, 4, 200, Side::BUY, OrderType::LIMIT, 2);
+        Order own(3, 995000, 3, 300, Side::BUY, OrderType::LIMIT, 7);
+        f.add_order(&ask);
+        b.add_order(&other);
+        b.add_order(&own);
+        ImpliedSpread legs(f, b, s);
+        assert(legs.implied_in().ask_quantity == 5);
+        assert(b.executable_top(Side::BUY, 7) == 4 && b.executable_top(Side::BUY, 9) == 7);
+        
+        Order spread_buy(4, 6000, 5, 400, Side::BUY, OrderType::LIMIT, 7);
+        legs.add_order(&spread_buy);
+        assert(spread_buy.filled == 4 && spread_buy.status == OrderStatus::PARTIAL);
+        assert(ask.filled == 4 && other.filled == 4);
+        assert(own.filled == 0 && own.status != OrderStatus::CANCELLED);
+        assert(b.self_trades_prevented() == 0);
+        assert(s.best_bid() == 6000 && s.best_bid_quantity() == 1);  // Remainder rests
+    }
+    std::cout << "  ✓ Implied fills capped by self-trade prevention on a leg; no naked leg\n";
+    
+    // Implied-out: outright leg orders take the spread plus the other leg
+    // when that beats the leg's own book
+    {
+        OrderBook f("F1"), b("F2"), s("F1-F2");
+        Order f_bid(1, 1000000, 10, 100, Side::BUY, OrderType::LIMIT, 1);
+        Order f_ask(2, 1001000, 5, 200, Side::SELL, OrderType::LIMIT, 1);
+        Order b_bid(3, 995000, 8, 300, Side::BUY, OrderType::LIMIT, 2);
+        Order b_ask(4, 996000, 20, 400, Side::SELL, OrderType::LIMIT, 2);
+        Order s_ask(5, 4500, 3, 500, Side::SELL, OrderType::LIMIT, 9);
+        for (Order* o : {&f_bid, &f_ask}) f.add_order(o);
+        for (Order* o : {&b_bid, &b_ask}) b.add_order(o);
+        s.add_order(&s_ask);
+        ImpliedSpread legs(f, b, s);
+        std::vector<std::pair<Trade, const OrderBook*>> reported;
+        legs.set_trade_callback([&](const Trade& t, const OrderBook& book) { reported.push_back({t, &book}); });
+        ImpliedSpread* spreads[] = {&legs};
+        assert(legs.implied_out_front().ask == 1000500 && legs.implied_out_front().ask_quantity == 3);
+        
+        // Buy front 6: 3 implied at 100.05 (spread ask + back ask), then 3 direct
+        Order buy(6, 1001000, 6, 600, Side::BUY, OrderType::LIMIT, 7);
+        ImpliedSpread::add_outright(&buy, f, spreads, spreads + 1);
+        assert(buy.status == OrderStatus::FILLED);
+        assert(s_ask.filled == 3 && b_ask.filled == 3 && f_ask.filled == 3);
+        assert(legs.implied_fills() == 1 && reported.size() == 1);
+        assert(reported[0].second == &f && reported[0].first.buy_order_id == 6);
+        assert(reported[0].first.price == 1000500 && reported[0].first.quantity == 3);
+        
+        // Sell back 10: back bid = front bid - spread ask = 99.60 x 2 beats 99.50
+        Order s_ask2(7, 4000, 2, 700, Side::SELL, OrderType::LIMIT, 9);
+        s.add_order(&s_ask2);
+        assert(legs.implied_out_back().bid == 996000 && legs.implied_out_back().bid_quantity == 2);
+        Order sell(8, 0, 10, 800, Side::SELL, OrderType::MARKET, 7);
+        ImpliedSpread::add_outright(&sell, b, spreads, spreads + 1);
+        assert(sell.status == OrderStatus::FILLED);
+        assert(f_bid.filled == 2 && s_ask2.filled == 2 && b_bid.filled == 8);
+        assert(reported.size() == 2 && reported[1].second == &b && reported[1].first.price == 996000);
+    }
+    std::cout << "  ✓ Outright orders match implied-out liquidity from the spread and other leg\n";
+    
+    std::cout << "✅ Implied spread: PASSED\n\n";
+}
+
+// Brute-force top-N depth via depth(), compared with the O(1) feature block
+template<typename Book>
+void check_features(const Book& book, size_t n) {
+    std::vector<Price> prices(n);
+    std::vector<Quantity> qty(n);
+    Quantity depth[2] = {0, 0};
+    for (Side side : {Side::BUY, Side::SELL}) {
+        size_t levels = book.depth(side, n, prices.data(), qty.data());
+        for (size_t i = 0; i < levels; ++i) depth[static_cast<int>(side)] += qty[i];
+    }
+    const BookFeatures& f = book.features();
+    assert(f.bid_depth == depth[0] && f.ask_depth == depth[1]);
+    assert(f.bid == book.best_bid() && f.ask == book.best_ask());
+    assert(f.bid_quantity == book.best_bid_quantity() && f.ask_quantity == book.best_ask_quantity());
+}
+
+template<typename Book>
+void run_feature_ops(size_t depth_levels, uint64_t seed) {
+    Book book("FEAT");
+    book.enable_features(depth_levels);
+    std::deque<Order> orders;
+    std::vector<Order*> live;
+    std::mt19937_64 rng(seed);
+    
+    for (int step = 0; step < 20000; ++step) {
+        int op = static_cast<int>(rng() % 10);
+        if (op < 6 || live.empty()) {
+            bool buy = rng() % 2;
+            Price px = 1000000 + static_cast<Price>(rng() % 20) * 100 - (buy ? 1000 : 0);
+            bool market = op == 0;
+            orders.emplace_back(step + 1, market ? 0 : px, 1 + rng() % 50, step, buy ? Side::BUY : Side::SELL,
+                                market ? OrderType::MARKET : OrderType::LIMIT, 1);
+            book.add_order(&orders.back());
+            if (orders.back().is_open()) live.push_back(&orders.back());
+        } else {
+            size_t i = rng() % live.size();
+            Order* order = live[i];
+            if (op < 9 || !order->is_open()) {
+                book.cancel_order(order);
+            } else {
+                book.modify_order(order, order->price, order->filled + std::max<Quantity>(1, order->remaining() / 2));
+            }
+            live[i] = live.back();
+            live.pop_back();
+            if (order->is_open()) live.push_back(order);
+        }
+        check_features(book, depth_levels);
+    }
+}
+
+void test_book_features() {
+    std::cout << "Testing incremental book features...\n";
+    
+    OrderBook book("FEAT");
+    Order bid(1, 999900, 300, 0, Side::BUY, OrderType::LIMIT, 1);
+    Order ask(2, 1000100, 100, 0, Side::SELL, OrderType::LIMIT, 2);
+    book.add_order(&bid);
+    book.add_order(&ask);
+    book.enable_features(2, 1000000000);
+    
+    const BookFeatures& f = book.features();
+    assert(f.mid == 1000000.0);
+    // Heavy bid leans the microprice towards the ask
+    assert(std::abs(f.microprice - (999900.0 * 100 + 1000100.0 * 300) / 400) < 1e-6);
+    assert(std::abs(f.imbalance - 0.5) < 1e-12);
+    assert(f.bid_depth == 300 && f.ask_depth == 100);
+    
+    // 60 taken from the ask touch at t = 0, then decay for one half-life
+    Order take(3, 1000100, 60, 0, Side::BUY, OrderType::LIMIT, 3);
+    book.add_order(&take);
+    double rate = f.ask_depletion;
+    assert(rate > 0 && f.bid_depletion == 0);
+    Order take2(4, 1000100, 40, 1000000000, Side::BUY, OrderType::LIMIT, 3);
+    book.add_order(&take2);
+    assert(std::abs(f.ask_depletion - (rate / 2 + rate * 40 / 60)) < 1e-6 * rate);
+    assert(f.ask == 0 && f.ask_depth == 0 && f.imbalance == 1.0);
+    std::cout << "  ✓ Microprice, imbalance and depletion EWMA\n";
+    
+    for (size_t n : {1, 3, 8}) {
+        run_feature_ops<OrderBook>(n, 100 + n);
+        run_feature_ops<ProRataOrderBook>(n, 200 + n);
+    }
+    std::cout << "  ✓ Top-N depth matches a book walk after 120k random ops\n";
+    
+    // Auction uncross settles in bulk, then the window is rebuilt
+    OrderBook auction("FEAT-AUCTION");
+    auction.enable_features(2);
+    auction.start_auction();
+    Order a1(1, 1000000, 100, 0, Side::BUY, OrderType::LIMIT, 1);
+    Order a2(2, 999900, 100, 0, Side::BUY, OrderType::LIMIT, 1);
+    Order a3(3, 999800, 100, 0, Side::BUY, OrderType::LIMIT, 1);
+    Order a4(4, 999900, 150, 0, Side::SELL, OrderType::LIMIT, 2);
+    for (Order* o : {&a1, &a2, &a3, &a4}) auction.add_order(o);
+    auction.uncross();
+    check_features(auction, 2);
+    Order a5(5, 999700, 10, 0, Side::BUY, OrderType::LIMIT, 1);
+    auction.add_order(&a5);
+    check_features(auction, 2);
+    std::cout << "  ✓ Consistent after an auction uncross\n";
+    std::cout << "✅ Book features: PASSED\n\n";
+}
+
+template<typename Book>
+void run_order_index_ops(uint64_t seed) {
+    // Same flow into an indexed and a scanning book; ids 64..79 fall
+    // outside the index and take the scan path in both
+    constexpr size_t slots = 80;
+    Book indexed("INDEX"), scanned("SCAN");
+    indexed.enable_order_index(64);
+    std::vector<Order> a(slots), b(slots);
+    for (size_t k = 0; k < slots; ++k) {
+        a[k] = b[k] = Order(k, 0, 0, 0, Side::BUY, OrderType::LIMIT, 0);
+        a[k].status = b[k].status = OrderStatus::CANCELLED;
+    }
+    std::vector<Trade> trades_a, trades_b;
+    indexed.set_trade_callback([&](const Trade& t) { trades_a.push_back(t); });
+    scanned.set_trade_callback([&](const Trade& t) { trades_b.push_back(t); });
+    indexed.set_self_trade_prevention(SelfTradePrevention::CANCEL_OLDEST);
+    scanned.set_self_trade_prevention(SelfTradePrevention::CANCEL_OLDEST);
+    std::mt19937_64 rng(seed);
+    
+    for (int step = 0; step < 20000; ++step) {
+        if (step % 5000 == 4000) {
+            indexed.start_auction();
+            scanned.start_auction();
+        } else if (step % 5000 == 4500) {
+            indexed.uncross();
+            scanned.uncross();
+        }
+        
+        size_t k = rng() % slots;
+        int op = static_cast<int>(rng() % 10);
+        if (op < 3) {
+            assert(indexed.cancel_order(&a[k]) == scanned.cancel_order(&b[k]));
+        } else if (op < 5) {
+            Quantity qty = a[k].filled + 1 + static_cast<Quantity>(rng() % 40);
+            Price px = op == 3 ? a[k].price : 1000000 + static_cast<Price>(rng() % 12) * 100 - 600;
+            assert(indexed.modify_order(&a[k], px, qty) == scanned.modify_order(&b[k], px, qty));
+        } else {
+            // Reuse the slot's Order for a new order, as pools and agents do
+            indexed.cancel_order(&a[k]);
+            scanned.cancel_order(&b[k]);
+            bool buy = rng() % 2;
+            Price px = 1000000 + static_cast<Price>(rng() % 12) * 100 - (buy ? 800 : 300);
+            Quantity qty = 1 + static_cast<Quantity>(rng() % 60);
+            a[k] = b[k] = Order(k, px, qty, step, buy ? Side::BUY : Side::SELL, OrderType::LIMIT,
+                                static_cast<uint32_t>(k % 7));
+            indexed.add_order(&a[k]);
+            scanned.add_order(&b[k]);
+        }
+        
+        assert(trades_a.size() == trades_b.size());
+        assert(indexed.bid_volume() == scanned.bid_volume() && indexed.ask_volume() == scanned.ask_volume());
+        assert(indexed.best_bid() == scanned.best_bid() && indexed.best_ask() == scanned.best_ask());
+    }
+    for (size_t i = 0; i < trades_a.size(); ++i) {
+        assert(trades_a[i].buy_order_id == trades_b[i].buy_order_id);
+        assert(trades_a[i].sell_order_id == trades_b[i].sell_order_id);
+        assert(trades_a[i].price == trades_b[i].price && trades_a[i].quantity == trades_b[i].quantity);
+    }
+    Price pa[64], pb[64];
+    Quantity qa[64], qb[64];
+    for (Side side : {Side::BUY, Side::SELL}) {
+        size_t n = indexed.depth(side, 64, pa, qa);
+        assert(n == scanned.depth(side, 64, pb, qb));
+        for (size_t i = 0; i < n; ++i) assert(pa[i] == pb[i] && qa[i] == qb[i]);
+    }
+}
+
+void test_order_index() {
+    std::cout << "Testing O(1) order index...\n";
+    
+    run_order_index_ops<OrderBook>(11);
+    run_order_index_ops<ProRataOrderBook>(12);
+    run_order_index_ops<FifoProRataOrderBook>(13);
+    std::cout << "  ✓ Same trades and depth as level scans, with reused orders, STP and auctions\n";
+    std::cout << "✅ Order index: PASSED\n\n";
+}
+
+// Open historical quantity per venue id, straight from the messages
+struct L3Model {
+    struct Open { Side side; Price price; Quantity quantity; };
+    std::unordered_map<uint64_t, Open> orders;
+    
+    void apply(const L3Message& m) {
+        switch (m.type) {
+            case L3MessageType::ADD: orders[m.order_id] = {m.side, m.price, m.quantity}; break;
+            case L3MessageType::CANCEL:
+            case L3MessageType::EXECUTE:
+                if ((orders[m.order_id].quantity -= m.quantity) == 0) orders.erase(m.order_id);
+                break;
+            case L3MessageType::DELETE: orders.erase(m.order_id); break;
+            case L3MessageType::REPLACE: {
+                Side side = orders[m.order_id].side;
+                orders.erase(m.order_id);
+                orders[m.new_order_id] = {side, m.price, m.quantity};
+                break;
+            }
+        }
+    }
+    Quantity total() const {
+        Quantity sum = 0;
+        for (const auto& [id, o] : orders) sum += o.quantity;
+        return sum;
+    }
+};
+
+void test_l3_replay() {
+    std::cout << "Testing L3 replay with strategy orders...\n";
+    
+    BookOpGenerator::Config config;
+    config.seed = 94;
+    config.target_window = 2000;
+    std::vector<L3Message> feed = record_l3_feed(config, 50000);
+    
+    {
+        // Pure replay rebuilds the venue's book level by level
+        L3Replay replay("L3");
+        L3Model model;
+        size_t trades = 0, executes = 0;
+        replay.set_trade_callback([&](const Trade&) { ++trades; });
+        for (const L3Message& m : feed) {
+            replay.apply(m);
+            model.apply(m);
+            executes += m.type == L3MessageType::EXECUTE;
+        }
+        assert(replay.stats().unknown_orders == 0 && replay.ghost_quantity() == 0);
+        assert(trades == executes && replay.historical_orders() == model.orders.size());
+        
+        std::map<Price, Quantity> bids, asks;
+        for (const auto& [id, o] : model.orders) (o.side == Side::BUY ? bids : asks)[o.price] += o.quantity;
+        Price px[256];
+        Quantity qty[256];
+        size_t n = replay.book().depth(Side::BUY, 256, px, qty);
+        assert(n == bids.size());
+        for (size_t i = 0; i < n; ++i) assert(bids[px[i]] == qty[i]);
+        n = replay.book().depth(Side::SELL, 256, px, qty);
+        assert(n == asks.size());
+        for (size_t i = 0; i < n; ++i) assert(asks[px[i]] == qty[i]);
+        std::cout << "  ✓ " << feed.size() << " messages rebuild the venue book, one trade per execute\n";
+    }
+    
+    auto msg = [](L3MessageType type, uint64_t id, Side side, Price price, Quantity qty) {
+        L3Message m;
+        m.type = type;
+        m.order_id = id;
+        m.side = side;
+        m.price = price;
+        m.quantity = qty;
+        return m;
+    };
+    
+    {
+        // Strategy takes 60 of a historical offer; history then executes
+        // 50 (all ghost), cancels 30 (10 ghost + 20 real) and deletes it
+        L3Replay replay("GHOST");
+        replay.apply(msg(L3MessageType::ADD, 7, Side::SELL, 1000000, 100));
+        OrderHandle buy = replay.submit_order(Order(0, 1000000, 60, 0, Side::BUY, OrderType::LIMIT, 9));
+        assert(replay.find_order(buy)->status == OrderStatus::FILLED);
+        assert(replay.ghost(7) == 60 && replay.book().best_ask_quantity() == 40);
+        
+        replay.apply(msg(L3MessageType::EXECUTE, 7, Side::SELL, 1000000, 50));
+        assert(replay.ghost(7) == 10 && replay.book().best_ask_quantity() == 40);
+        replay.apply(msg(L3MessageType::CANCEL, 7, Side::SELL, 0, 30));
+        assert(replay.ghost(7) == 0 && replay.book().best_ask_quantity() == 20);
+        replay.apply(msg(L3MessageType::DELETE, 7, Side::SELL, 0, 0));
+        assert(replay.book().best_ask() == 0 && replay.historical_orders() == 0);
+        
+        const auto& stats = replay.stats();
+        assert(stats.ghost_created == 60 && stats.ghost_reconciled == 60 && replay.ghost_quantity() == 0);
+        assert(stats.strategy_volume == 60 && stats.unknown_orders == 0);
+        replay.apply(msg(L3MessageType::EXECUTE, 7, Side::SELL, 1000000, 5));
+        assert(replay.stats().unknown_orders == 1);
+        std::cout << "  ✓ Consumed liquidity becomes ghost and is reconciled by executes and cancels\n";
+    }
+    
+    {
+        // A historical aggressor fills strategy bids queued ahead of the
+        // executed order; orders behind it are untouched
+        L3Replay replay("QUEUE");
+        replay.apply(msg(L3MessageType::ADD, 1, Side::BUY, 999900, 100));
+        OrderHandle behind = replay.submit_order(Order(0, 999900, 50, 0, Side::BUY, OrderType::LIMIT, 9));
+        OrderHandle ahead = replay.submit_order(Order(0, 1000000, 20, 0, Side::BUY, OrderType::LIMIT, 9));
+        std::vector<Trade> trades;
+        replay.set_trade_callback([&](const Trade& t) { trades.push_back(t); });
+        
+        replay.apply(msg(L3MessageType::EXECUTE, 1, Side::BUY, 999900, 30));
+        assert(trades.size() == 2);
+        assert(trades[0].buy_order_id == ahead && trades[0].sell_order_id == INVALID_ORDER_HANDLE);
+        assert(trades[1].buy_order_id != ahead && trades[1].quantity == 10);
+        assert(replay.find_order(ahead)->status == OrderStatus::FILLED);
+        assert(replay.find_order(behind)->filled == 0);
+        assert(replay.is_strategy_order(ahead) && !replay.is_strategy_order(trades[1].buy_order_id));
+        // History stays authoritative: 70 left, as the feed says
+        assert(replay.book().bid_volume() == 70 + 50 && replay.ghost(1) == 0);
+        
+        replay.release_order(behind);
+        assert(replay.find_order(behind) == nullptr && replay.book().bid_volume() == 70);
+        std::cout << "  ✓ Historical executes fill strategy orders ahead in the queue\n";
+    }
+    
+    {
+        // Random strategy flow on top of the feed
+        L3Replay replay("MIXED");
+        L3Model model;
+        std::mt19937_64 rng(4);
+        std::vector<OrderHandle> working;
+        for (size_t i = 0; i < feed.size(); ++i) {
+            replay.apply(feed[i]);
+            model.apply(feed[i]);
+            if (i % 20 == 0) {
+                bool buy = rng() % 2;
+                Price px = 1000000 + static_cast<Price>(rng() % 40) * 100 - 2000;
+                working.push_back(replay.submit_order(Order(0, px, 1 + rng() % 80, 0,
+                                  buy ? Side::BUY : Side::SELL, OrderType::LIMIT, 9)));
+            }
+            if (i % 30 == 0 && !working.empty()) {
+                size_t k = rng() % working.size();
+                replay.release_order(working[k]);
+                working[k] = working.back();
+                working.pop_back();
+            }
+            const auto& stats = replay.stats();
+            assert(replay.ghost_quantity() >= 0);
+            assert(stats.ghost_created - stats.ghost_reconciled == replay.ghost_quantity());
+        }
+        for (OrderHandle h : working) replay.release_order(h);
+        
+        const auto& stats = replay.stats();
+        assert(stats.unknown_orders == 0 && stats.ghost_created > 0 && stats.strategy_volume > 0);
+        assert(replay.historical_orders() == model.orders.size());
+        // Every open historical share is either resting or ghost
+        assert(replay.book().bid_volume() + replay.book().ask_volume() + replay.ghost_quantity() == model.total());
+        std::cout << "  ✓ " << stats.strategy_orders << " strategy orders, " << stats.ghost_created
+                  << " ghost created, feed and book reconcile\n";
+    }
+    
+    std::cout << "✅ L3 replay: PASSED\n\n";
+}
+
 int main() {
     std::cout << "=== Order Book Correctness Tests ===\n\n";
     
@@ -113,6 +935,18 @@ int main() {
         test_partial_fill_volume();
         test_multiple_price_levels();
         test_fifo_ordering();
+        test_cancel_order();
+        test_depth_snapshot();
+        test_top_of_book_publish();
+        test_auction_uncross();
+        test_auction_tie_breaks();
+        test_pro_rata_allocation();
+        test_stop_orders();
+        test_self_trade_prevention();
+        test_implied_spread();
+        test_book_features();
+        test_order_index();
+        test_l3_replay();
         
         std::cout << "=== ALL TESTS PASSED ===\n";
         return 0;
@@ -1,8 +1,18 @@
 #include "tick_engine.hpp"
 #include "../strategies/momentum_strategy.hpp"
+#include "../strategies/pairs_strategy.hpp"
+#include "rolling_regression.hpp"
+#include "rolling_covariance.hpp"
+#include "parallel.hpp"
+#include "execution_algo.hpp"
+#include "agent_sim.hpp"
+#include <atomic>
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
 
 using namespace trading;
 
@@ -24,7 +34,7 @@ void test_momentum_strategy_signals() {
     
     // Next ticks show uptrend (should trigger buy)
     for (int i = 5; i < 10; ++i) {
-        Price price = base_price + (i - 4) * 3000;  // +$0.30 per tick
+        Price price = base_price + (i - 4) * 30000;  // +$3.00 per tick, clears the 2% band
         ticks.push_back(Tick{"TEST", price, 100, static_cast<Timestamp>(i * 1000), Side::BUY});
     }
     
@@ -136,9 +146,1325 @@ void test_multiple_strategies() {
     assert(stats.ticks_processed == 200);
     assert(stats.orders_submitted > 0);  // Both strategies should trade
     
+    // The market maker's own quotes never trade with each other under STP
+    TickEngine guarded;
+    guarded.set_self_trade_prevention(SelfTradePrevention::CANCEL_OLDEST);
+    guarded.add_strategy(std::make_unique<MarketMakerStrategy>(-200, 25, 300));  // Crossed quotes
+    guarded.run_backtest(ticks);
+    assert(guarded.get_stats().orders_submitted > 0);
+    assert(guarded.get_stats().trades_executed == 0);
+    assert(guarded.get_order_book("TEST")->self_trades_prevented() > 0);
+    
     std::cout << "✅ Multiple strategies: PASSED\n\n";
 }
 
+void test_order_handles() {
+    std::cout << "Testing generational order handles...\n";
+    
+    TickEngine engine;
+    engine.process_tick(Tick{"TEST", 1000000, 100, 0, Side::BUY});
+    
+    OrderHandle ask = engine.submit_order(
+        Order(0, 1000000, 100, 0, Side::SELL, OrderType::LIMIT, 1));
+    assert(ask != INVALID_ORDER_HANDLE);
+    assert(engine.order_status(ask) == OrderStatus::PENDING);
+    assert(engine.find_order(ask)->id == ask);
+    
+    // Partial fill is visible through the resting order's handle
+    OrderHandle bid = engine.submit_order(
+        Order(0, 1000000, 40, 0, Side::BUY, OrderType::LIMIT, 2));
+    assert(engine.order_status(bid) == OrderStatus::FILLED);
+    assert(engine.order_status(ask) == OrderStatus::PARTIAL);
+    assert(engine.find_order(ask)->filled == 40);
+    
+    // Cancel removes the residual from the book
+    assert(engine.cancel_order(ask));
+    assert(engine.order_status(ask) == OrderStatus::CANCELLED);
+    assert(engine.get_order_book("TEST")->ask_volume() == 0);
+    assert(!engine.cancel_order(ask));
+    
+    // Released slots are recycled under a new generation
+    engine.release_order(ask);
+    assert(!engine.order_status(ask).has_value());
+    OrderHandle reused = engine.submit_order(
+        Order(0, 1010000, 10, 0, Side::SELL, OrderType::LIMIT, 1));
+    assert(handle_slot(reused) == handle_slot(ask));
+    assert(handle_generation(reused) != handle_generation(ask));
+    assert(engine.find_order(ask) == nullptr);
+    assert(engine.order_status(reused) == OrderStatus::PENDING);
+    
+    std::cout << "  ✓ Stale handles rejected after slot reuse\n";
+    std::cout << "✅ Order handles: PASSED\n\n";
+}
+
+void test_engine_timers() {
+    std::cout << "Testing engine timers and GTT orders...\n";
+    
+    // Quote refresh driven by simulated time rather than tick count
+    TickEngine engine;
+    auto* maker = new MarketMakerStrategy(1000, 50, 500, 25000);  // Every 25 µs
+    engine.add_strategy(std::unique_ptr<Strategy>(maker));
+    for (int i = 0; i < 100; ++i) {
+        engine.process_tick(Tick{"TEST", 1000000, 100, static_cast<Timestamp>(i * 1000), Side::BUY});
+    }
+    assert(maker->quotes() == 3);  // Fires at 25, 50 and 75 µs
+    assert(engine.get_stats().orders_submitted == 6);
+    assert(engine.pending_timers() == 1);
+    std::cout << "  ✓ Market maker requotes every 25 µs of simulated time\n";
+    
+    // Timers fire before on_tick, so with two symbols the quote must go to
+    // the book its mid came from, not to the book of the triggering tick
+    TickEngine pair;
+    auto* two = new MarketMakerStrategy(1000, 50, 500, 25000);
+    pair.add_strategy(std::unique_ptr<Strategy>(two));
+    pair.process_tick(Tick{"TMR-A", 1000000, 100, 0, Side::BUY});
+    pair.submit_order(Order(0, 1001000, 100, 0, Side::SELL, OrderType::LIMIT, 1));
+    for (int i = 0; i < 100; ++i) {
+        Timestamp t = static_cast<Timestamp>(i * 1000);
+        pair.process_tick(Tick{"TMR-A", 1000000, 100, t, Side::BUY});
+        pair.process_tick(Tick{"TMR-B", 2000000, 100, t + 500, Side::BUY});
+    }
+    const OrderBook* a = pair.get_order_book("TMR-A");
+    const OrderBook* b = pair.get_order_book("TMR-B");
+    assert(two->quotes() == 3);  // Fired by TMR-A ticks after a TMR-B tick
+    assert(a->total_trades() == 0 && a->bid_volume() == 0);
+    assert(b->best_bid() == 1999500 && b->best_ask() == 2000500);
+    assert(b->bid_volume() == 150 && b->ask_volume() == 150);
+    std::cout << "  ✓ Timer quotes go to the symbol of the quoted mid\n";
+    
+    // GTT order is cancelled once time passes its expiry
+    TickEngine gtt;
+    gtt.process_tick(Tick{"TEST", 1000000, 100, 0, Side::BUY});
+    OrderHandle resting = gtt.submit_gtt_order(
+        Order(0, 1010000, 100, 0, Side::SELL, OrderType::LIMIT, 1), 50000);
+    OrderHandle filled = gtt.submit_gtt_order(
+        Order(0, 990000, 10, 0, Side::BUY, OrderType::LIMIT, 1), 50000);
+    assert(gtt.pending_timers() == 2);
+    
+    gtt.process_tick(Tick{"TEST", 1000000, 100, 49000, Side::BUY});
+    assert(gtt.order_status(resting) == OrderStatus::PENDING);
+    Order hit(0, 990000, 10, 0, Side::SELL, OrderType::LIMIT, 2);
+    gtt.submit_order(hit);
+    assert(gtt.order_status(filled) == OrderStatus::FILLED);
+    
+    gtt.process_tick(Tick{"TEST", 1000000, 100, 50000, Side::BUY});
+    assert(gtt.order_status(resting) == OrderStatus::CANCELLED);
+    assert(gtt.order_status(filled) == OrderStatus::FILLED);
+    assert(gtt.get_order_book("TEST")->ask_volume() == 0);
+    assert(gtt.pending_timers() == 0);
+    std::cout << "  ✓ GTT orders expire on simulated time\n";
+    
+    std::cout << "✅ Engine timers: PASSED\n\n";
+}
+
+void test_engine_spread_routing() {
+    std::cout << "Testing spread routing through the engine...\n";
+    
+    struct Recorder : Strategy {
+        void on_tick(const Tick&, TickEngine*) override {}
+        void on_trade(const Trade& trade) override { trades.push_back(trade); }
+        const char* name() const override { return "Recorder"; }
+        std::vector<Trade> trades;
+    };
+    TickEngine engine;
+    auto* recorder = new Recorder;
+    engine.add_strategy(std::unique_ptr<Strategy>(recorder));
+    engine.link_spread("ES-SPREAD", "ES-FRONT", "ES-BACK");
+    SymbolId front = SymbolRegistry::instance().register_symbol("ES-FRONT");
+    SymbolId back = SymbolRegistry::instance().register_symbol("ES-BACK");
+    SymbolId spread = SymbolRegistry::instance().register_symbol("ES-SPREAD");
+    
+    engine.submit_order(Order(0, 1001000, 5, 0, Side::SELL, OrderType::LIMIT, 1), front);
+    engine.submit_order(Order(0, 995000, 5, 0, Side::BUY, OrderType::LIMIT, 2), back);
+    OrderHandle buy = engine.submit_order(Order(0, 6000, 5, 0, Side::BUY, OrderType::LIMIT, 3), spread);
+    
+    assert(engine.order_status(buy) == OrderStatus::FILLED);
+    assert(engine.get_stats().trades_executed == 3);  // One per leg, plus the spread fill
+    assert(recorder->trades.size() == 3);
+    assert(recorder->trades.back().buy_order_id == buy && recorder->trades.back().sell_order_id == 0);
+    assert(recorder->trades.back().price == 6000 && recorder->trades.back().quantity == 5);
+    assert(engine.get_order_book(front)->ask_volume() == 0);
+    assert(engine.get_order_book(back)->bid_volume() == 0);
+    
+    std::cout << "  ✓ Spread order filled against both legs and reported as a spread trade\n";
+    
+    // Outright front buy takes implied-out liquidity: spread ask + back ask
+    engine.submit_order(Order(0, 2000, 4, 0, Side::SELL, OrderType::LIMIT, 1), spread);
+    engine.submit_order(Order(0, 996000, 4, 0, Side::SELL, OrderType::LIMIT, 2), back);
+    OrderHandle outright = engine.submit_order(Order(0, 999000, 4, 0, Side::BUY, OrderType::LIMIT, 3), front);
+    assert(engine.order_status(outright) == OrderStatus::FILLED);
+    assert(engine.get_order_book(spread)->ask_volume() == 0);
+    assert(engine.get_order_book(back)->ask_volume() == 0);
+    assert(recorder->trades.back().buy_order_id == outright && recorder->trades.back().price == 998000);
+    assert(engine.get_stats().trades_executed == 6);
+    std::cout << "  ✓ Outright order filled against implied-out liquidity\n";
+    std::cout << "✅ Spread routing: PASSED\n\n";
+}
+
+void test_engine_book_features() {
+    std::cout << "Testing book features through the engine...\n";
+    
+    TickEngine engine;
+    engine.enable_book_features(3);
+    SymbolId sym = SymbolRegistry::instance().register_symbol("FEAT-ENG");
+    engine.submit_order(Order(0, 999900, 200, 0, Side::BUY, OrderType::LIMIT, 1), sym);
+    engine.submit_order(Order(0, 1000100, 100, 0, Side::SELL, OrderType::LIMIT, 2), sym);
+    
+    const BookFeatures& f = engine.get_order_book(sym)->features();
+    assert(engine.get_order_book(sym)->features_enabled());
+    assert(f.bid_depth == 200 && f.ask_depth == 100);
+    assert(std::abs(f.imbalance - 1.0 / 3.0) < 1e-12);
+    assert(f.microprice > f.mid);
+    
+    std::cout << "  ✓ Books created after enabling carry the feature block\n";
+    std::cout << "✅ Engine book features: PASSED\n\n";
+}
+
+// One scripted step for a symbol: quote both sides, cross, then cancel
+void fingerprint_step(TickEngine& engine, const std::string& symbol, int step, Quantity size) {
+    Price px = 1000000 + (step % 7) * 100;
+    Timestamp ts = static_cast<Timestamp>(step) * 1000;
+    engine.process_tick(Tick{symbol, px, 100, ts, Side::BUY});
+    OrderHandle bid = engine.submit_order(Order(0, px - 100, size, 0, Side::BUY, OrderType::LIMIT, 1));
+    engine.submit_order(Order(0, px + 100, size, 0, Side::SELL, OrderType::LIMIT, 2));
+    engine.submit_order(Order(0, px - 100, size / 2, 0, Side::SELL, OrderType::LIMIT, 3));
+    engine.cancel_order(bid);
+}
+
+void test_run_fingerprint() {
+    std::cout << "Testing deterministic run fingerprint...\n";
+    
+    auto run = [](Quantity size) {
+        TickEngine engine;
+        for (int i = 0; i < 50; ++i) fingerprint_step(engine, "FPA", i, size);
+        return engine.get_stats().fingerprint;
+    };
+    
+    uint64_t a = run(100);
+    assert(a != 0);
+    assert(run(100) == a);
+    assert(run(101) != a);
+    
+    // Per-symbol runs combine to the fingerprint of an interleaved run
+    TickEngine only_a, only_b, both;
+    for (int i = 0; i < 50; ++i) {
+        fingerprint_step(only_a, "FPA", i, 100);
+        fingerprint_step(only_b, "FPB", i, 60);
+        fingerprint_step(both, "FPA", i, 100);
+        fingerprint_step(both, "FPB", i, 60);
+    }
+    assert(only_a.get_stats().fingerprint == a);
+    assert(both.get_stats().trades_executed == only_a.get_stats().trades_executed +
+                                               only_b.get_stats().trades_executed);
+    assert(RunFingerprint::combine(only_a.get_stats().fingerprint, only_b.get_stats().fingerprint) ==
+           both.get_stats().fingerprint);
+    
+    // Orders follow the tick's symbol rather than the first book created
+    assert(both.get_order_book("FPB")->total_trades() == only_b.get_order_book("FPB")->total_trades());
+    
+    std::cout << "  Fingerprint: 0x" << std::hex << a << std::dec << "\n";
+    std::cout << "✅ Run fingerprint: PASSED\n\n";
+}
+
+void test_book_sampler() {
+    std::cout << "Testing book-state sampler...\n";
+    
+    const char* path = "test_book_sampler.bin";
+    {
+        TickEngine engine;
+        engine.process_tick(Tick{"TEST", 1000000, 100, 0, Side::BUY});
+        engine.submit_order(Order(0, 995000, 300, 0, Side::BUY, OrderType::LIMIT, 1));
+        engine.submit_order(Order(0, 1005000, 100, 0, Side::SELL, OrderType::LIMIT, 2));
+        
+        SamplerConfig config;
+        config.path = path;
+        config.interval_ns = 10000;
+        config.depth_levels = 2;
+        config.rows_per_chunk = 4;
+        engine.enable_sampling(config);
+        
+        // 50 ticks 1us apart: initial sample plus 5 interval boundaries
+        for (int i = 1; i <= 50; ++i) {
+            engine.process_tick(Tick{"TEST", 1000000, 100, static_cast<Timestamp>(i * 1000), Side::BUY});
+        }
+        assert(engine.sampler()->rows_written() == 6);
+    }  // Engine teardown drains the writer
+    
+    std::FILE* f = std::fopen(path, "rb");
+    assert(f);
+    int64_t header[3];
+    assert(std::fread(header, sizeof(int64_t), 3, f) == 3);
+    assert(std::memcmp(&header[0], "BTSAMPL1", 8) == 0);
+    assert(header[1] == 2 && header[2] == 14);
+    
+    // First chunk holds 4 rows, column-major
+    int64_t rows;
+    assert(std::fread(&rows, sizeof(rows), 1, f) == 1 && rows == 4);
+    std::vector<int64_t> columns(14 * 4);
+    assert(std::fread(columns.data(), sizeof(int64_t), columns.size(), f) == columns.size());
+    assert(columns[0 * 4] == 1000);              // timestamp
+    assert(columns[2 * 4] == 995000);            // best bid
+    assert(columns[4 * 4] == 10000);             // spread
+    assert(columns[5 * 4] == 5000);              // (300 - 100) / 400 in bps
+    assert(columns[8 * 4] == 300);               // bid qty level 1
+    
+    assert(std::fread(&rows, sizeof(rows), 1, f) == 1 && rows == 2);
+    std::fclose(f);
+    std::remove(path);
+    
+    std::cout << "  ✓ Columnar chunks written asynchronously\n";
+    
+    // A full disk is reported, not left as a silently truncated file
+    {
+        TickEngine engine;
+        engine.process_tick(Tick{"TEST", 1000000, 100, 0, Side::BUY});
+        SamplerConfig config;
+        config.path = "/dev/full";
+        config.every_n_events = 1;
+        config.rows_per_chunk = 0;  // Treated as one row per chunk
+        engine.enable_sampling(config);
+        for (int i = 1; i <= 10; ++i) {
+            engine.process_tick(Tick{"TEST", 1000000, 100, static_cast<Timestamp>(i * 1000), Side::BUY});
+        }
+        assert(engine.sampler()->rows_written() == 10);
+        bool threw = false;
+        try {
+            engine.sampler()->close();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && engine.sampler()->failed());
+        engine.process_tick(Tick{"TEST", 1000000, 100, 20000, Side::BUY});  // Closed: no sample
+        assert(engine.sampler()->rows_written() == 10);
+    }
+    std::cout << "  ✓ Short writes surface as errors\n";
+    std::cout << "✅ Book sampler: PASSED\n\n";
+}
+
+void test_live_stats_segment() {
+    std::cout << "Testing live stats shared-memory segment...\n";
+    
+    LiveStatsRegion region = LiveStatsRegion::create("/bt_test_live_stats");
+    TickEngine engine;
+    engine.enable_live_stats(region);
+    
+    std::vector<Tick> ticks;
+    for (uint32_t i = 0; i < TickEngine::LIVE_STATS_INTERVAL + 10; ++i) {
+        ticks.push_back(Tick{"TEST", 1000000, 100, static_cast<Timestamp>(i * 1000), Side::BUY});
+    }
+    engine.run_backtest(ticks);
+    
+    // A separate mapping sees what the engine published
+    LiveStatsRegion reader = LiveStatsRegion::attach("/bt_test_live_stats");
+    const LiveStatsSegment* seg = reader.segment();
+    assert(seg->threads_in_use.load() == 1);
+    
+    const LiveThreadStats& t = seg->threads[0];
+    assert(t.state.load() == LiveThreadStats::FINISHED);
+    assert(t.ticks_processed.load() == ticks.size());
+    assert(t.simulated_time.load() == ticks.back().timestamp);
+    
+    uint64_t histogram_total = 0;
+    for (const auto& bucket : t.latency_histogram) histogram_total += bucket.load();
+    assert(histogram_total == ticks.size());
+    
+    std::cout << "  ✓ Stats visible through a second mapping\n";
+    std::cout << "✅ Live stats segment: PASSED\n\n";
+}
+
+void test_rolling_regression() {
+    std::cout << "Testing sliding-window regression...\n";
+    
+    // Price-sized inputs with small variance: raw sums would cancel badly
+    const size_t window = 64;
+    RollingRegression reg(window);
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> noise(0.0, 25.0);
+    std::vector<double> xs, ys;
+    for (int i = 0; i < 20000; ++i) {
+        double x = 1.0e7 + 500.0 * std::sin(i * 0.01) + noise(rng);
+        double y = 3.0e6 + 1.5 * x + noise(rng);
+        xs.push_back(x);
+        ys.push_back(y);
+        reg.add(x, y);
+    }
+    assert(reg.full() && reg.count() == window);
+    
+    // Two-pass batch OLS over the same window
+    size_t begin = xs.size() - window;
+    double mx = 0, my = 0;
+    for (size_t i = begin; i < xs.size(); ++i) { mx += xs[i]; my += ys[i]; }
+    mx /= window;
+    my /= window;
+    double sxx = 0, sxy = 0, syy = 0;
+    for (size_t i = begin; i < xs.size(); ++i) {
+        sxx += (xs[i] - mx) * (xs[i] - mx);
+        sxy += (xs[i] - mx) * (ys[i] - my);
+        syy += (ys[i] - my) * (ys[i] - my);
+    }
+    double slope = sxy / sxx;
+    double stddev = std::sqrt((syy - sxy * slope) / (window - 2));
+    
+    assert(std::abs(reg.slope() - slope) < 1e-9 * std::abs(slope));
+    assert(std::abs(reg.intercept() - (my - slope * mx)) < 1e-6 * std::abs(my));
+    assert(std::abs(reg.residual_stddev() - stddev) < 1e-6 * stddev);
+    assert(std::abs(reg.correlation() - sxy / std::sqrt(sxx * syy)) < 1e-9);
+    std::cout << "  ✓ Matches batch OLS after 20k add/evict steps\n";
+    
+    // Exact-fit window: zero residual, half-life of a decaying spread
+    RollingRegression line(10);
+    for (int i = 0; i < 25; ++i) line.add(i, 4.0 + 2.0 * i);
+    assert(std::abs(line.slope() - 2.0) < 1e-12);
+    assert(std::abs(line.intercept() - 4.0) < 1e-9);
+    assert(line.residual_stddev() < 1e-6);
+    assert(std::abs(mean_reversion_half_life(std::log(0.5)) - 1.0) < 1e-12);
+    assert(std::isinf(mean_reversion_half_life(0.1)));
+    std::cout << "  ✓ Exact fit and half-life\n";
+    std::cout << "✅ Rolling regression: PASSED\n\n";
+}
+
+void test_pairs_strategy() {
+    std::cout << "Testing pairs strategy...\n";
+    
+    TickEngine engine;
+    auto* strategy = new PairsStrategy("PAIR-Y", "PAIR-X", 100, 2.0, 0.5, 100);
+    engine.add_strategy(std::unique_ptr<Strategy>(strategy));
+    
+    // Y = 2 * X plus a fast mean-reverting AR(1) spread
+    std::mt19937_64 rng(11);
+    std::normal_distribution<double> step(0.0, 500.0);
+    std::normal_distribution<double> shock(0.0, 300.0);
+    double x = 1000000.0;
+    double spread = 0.0;
+    std::vector<Tick> ticks;
+    for (int i = 0; i < 2000; ++i) {
+        x += step(rng);
+        spread = 0.6 * spread + shock(rng);
+        Timestamp ts = static_cast<Timestamp>(i) * 1000;
+        ticks.push_back(Tick{"PAIR-X", static_cast<Price>(x), 100, ts, Side::BUY});
+        ticks.push_back(Tick{"PAIR-Y", static_cast<Price>(2.0 * x + spread), 100, ts + 500, Side::BUY});
+    }
+    engine.run_backtest(ticks);
+    
+    assert(std::abs(strategy->hedge_ratio() - 2.0) < 0.05);
+    assert(std::isfinite(strategy->half_life()) && strategy->half_life() < 10.0);
+    assert(strategy->entries() > 0);
+    assert(strategy->exits() > 0);
+    assert(strategy->entries() - strategy->exits() == (strategy->state() != 0 ? 1u : 0u));
+    std::cout << "  ✓ Hedge ratio " << strategy->hedge_ratio() << ", half-life "
+              << strategy->half_life() << " samples\n";
+    std::cout << "  ✓ " << strategy->entries() << " entries, " << strategy->exits() << " exits\n";
+    std::cout << "✅ Pairs strategy: PASSED\n\n";
+}
+
+void test_worker_pool() {
+    std::cout << "Testing worker pool...\n";
+    
+    WorkerPool pool(4);
+    assert(pool.size() == 4);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<std::atomic<int>> hits(97);
+        pool.parallel_for(hits.size(), [&](size_t i) { hits[i].fetch_add(1); });
+        for (auto& h : hits) assert(h.load() == 1);
+    }
+    pool.parallel_for(0, [](size_t) { assert(false); });
+    std::cout << "  ✓ Every index runs exactly once, pool reused across 200 jobs\n";
+    std::cout << "✅ Worker pool: PASSED\n\n";
+}
+
+void test_rolling_covariance() {
+    std::cout << "Testing rolling covariance matrix...\n";
+    
+    // Spans several tiles with a ragged last tile
+    const size_t n = 150;
+    const size_t window = 20;
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> noise(0.0, 0.01);
+    std::vector<std::vector<double>> bars;
+    for (int b = 0; b < 500; ++b) {
+        double market = noise(rng);
+        std::vector<double> r(n);
+        for (size_t i = 0; i < n; ++i) r[i] = 0.0005 + (i % 3) * market + noise(rng);
+        bars.push_back(r);
+    }
+    
+    WorkerPool pool(4);
+    RollingCovariance serial(n, window);
+    RollingCovariance parallel(n, window, &pool);
+    for (auto& r : bars) {
+        serial.add(r.data());
+        parallel.add(r.data());
+    }
+    assert(serial.full() && serial.count() == window);
+    
+    // Naive two-pass covariance over the last window
+    std::vector<double> mean(n, 0.0);
+    for (size_t b = bars.size() - window; b < bars.size(); ++b) {
+        for (size_t i = 0; i < n; ++i) mean[i] += bars[b][i] / window;
+    }
+    std::vector<double> cov(n * n), corr(n * n);
+    serial.covariance_matrix(cov.data());
+    serial.correlation_matrix(corr.data());
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            double c = 0.0;
+            for (size_t b = bars.size() - window; b < bars.size(); ++b) {
+                c += (bars[b][i] - mean[i]) * (bars[b][j] - mean[j]);
+            }
+            c /= window - 1;
+            assert(std::abs(serial.covariance(i, j) - c) < 1e-12);
+            assert(cov[i * n + j] == serial.covariance(i, j));
+            assert(std::abs(corr[i * n + j] - serial.correlation(i, j)) < 1e-12);
+            // Row-block scheduling does not change the arithmetic
+            assert(parallel.covariance(i, j) == serial.covariance(i, j));
+        }
+        assert(std::abs(serial.mean(i) - mean[i]) < 1e-12);
+        assert(std::abs(serial.correlation(i, i) - 1.0) < 1e-12);
+    }
+    std::cout << "  ✓ Matches naive recomputation after 500 bars (serial and pooled)\n";
+    
+    double before = serial.covariance(0, 3);
+    serial.recompute();
+    assert(serial.count() == window);
+    assert(std::abs(serial.covariance(0, 3) - before) < 1e-15);
+    std::cout << "  ✓ Exact recompute agrees with incremental moments\n";
+    std::cout << "✅ Rolling covariance: PASSED\n\n";
+}
+
+// Resting liquidity from user 1: `levels` price levels of `qty` on one side
+void seed_levels(TickEngine& engine, SymbolId symbol, Side side, Price best, int levels, Quantity qty) {
+    Price step = side == Side::SELL ? 100 : -100;
+    for (int l = 0; l < levels; ++l) {
+        engine.submit_order(Order(0, best + l * step, qty, 0, side, OrderType::LIMIT, 1), symbol);
+    }
+}
+
+// Market data every 100 ms on [from, to) with 1000 shares per tick
+void run_ticks(TickEngine& engine, const std::string& symbol, Timestamp from, Timestamp to) {
+    for (Timestamp ts = from; ts < to; ts += 100000000) {
+        engine.process_tick(Tick{symbol, 1000000, 1000, ts, Side::BUY});
+    }
+}
+
+void test_execution_algos() {
+    std::cout << "Testing TWAP/VWAP/POV execution algos...\n";
+    constexpr Timestamp SEC = 1000000000;
+    
+    {
+        TickEngine engine;
+        SymbolId sym = SymbolRegistry::instance().register_symbol("ALGO-T");
+        seed_levels(engine, sym, Side::SELL, 1000000, 50, 1000);
+        seed_levels(engine, sym, Side::BUY, 999900, 5, 1000);
+        auto* algos = new ExecutionAlgos(engine);
+        engine.add_strategy(std::unique_ptr<Strategy>(algos));
+        
+        ParentOrder parent;
+        parent.symbol = sym;
+        parent.quantity = 6000;
+        parent.end = 60 * SEC;
+        ParentId twap = algos->submit(parent);
+        
+        run_ticks(engine, "ALGO-T", 0, 30 * SEC);
+        assert(algos->report(twap).filled == 3000);  // On schedule at the half-way mark
+        run_ticks(engine, "ALGO-T", 30 * SEC, 61 * SEC);
+        
+        ExecutionReport r = algos->report(twap);
+        assert(r.done && r.filled == 6000 && r.children == 60);
+        assert(r.arrival_price == 999950);
+        assert(std::abs(r.average_price - 1000250.0) < 1e-6);  // Walked six 1000-lot levels
+        assert(std::abs(r.shortfall - 300.0 * 6000) < 1e-3);
+        assert(r.shortfall_bps > 2.9 && r.shortfall_bps < 3.1);
+        assert(algos->active_parents() == 0);
+        std::cout << "  ✓ TWAP: 60 children, shortfall " << r.shortfall_bps << " bps\n";
+    }
+    
+    {
+        TickEngine engine;
+        SymbolId sym = SymbolRegistry::instance().register_symbol("ALGO-V");
+        seed_levels(engine, sym, Side::SELL, 1000000, 20, 1000);
+        auto* algos = new ExecutionAlgos(engine);
+        algos->set_volume_profile({3, 1, 1, 3});  // U-shaped
+        engine.add_strategy(std::unique_ptr<Strategy>(algos));
+        
+        ParentOrder parent;
+        parent.symbol = sym;
+        parent.quantity = 8000;
+        parent.end = 40 * SEC;
+        parent.algo = ExecutionAlgo::VWAP;
+        ParentId vwap = algos->submit(parent);
+        
+        run_ticks(engine, "ALGO-V", 0, 10 * SEC);
+        assert(algos->report(vwap).filled == 3000);  // 3/8 in the first quarter
+        run_ticks(engine, "ALGO-V", 10 * SEC, 30 * SEC);
+        assert(algos->report(vwap).filled == 5000);
+        run_ticks(engine, "ALGO-V", 30 * SEC, 41 * SEC);
+        assert(algos->report(vwap).done && algos->report(vwap).filled == 8000);
+        std::cout << "  ✓ VWAP follows the volume profile\n";
+    }
+    
+    {
+        TickEngine engine;
+        SymbolId sym = SymbolRegistry::instance().register_symbol("ALGO-P");
+        seed_levels(engine, sym, Side::SELL, 1000000, 100, 1000);
+        auto* algos = new ExecutionAlgos(engine);
+        engine.add_strategy(std::unique_ptr<Strategy>(algos));
+        
+        ParentOrder parent;
+        parent.symbol = sym;
+        parent.quantity = 1000000;  // Not reachable at 10% of 10k/s in a minute
+        parent.end = 60 * SEC;
+        parent.algo = ExecutionAlgo::POV;
+        parent.participation = 0.1;
+        ParentId pov = algos->submit(parent);
+        
+        run_ticks(engine, "ALGO-P", 0, 61 * SEC);
+        ExecutionReport r = algos->report(pov);
+        // Last decision at 59 s sees 59 s of volume
+        assert(r.done && r.filled == 59000);
+        assert(r.shortfall > 0);  // Opportunity cost of the unfilled rest counts too
+        std::cout << "  ✓ POV: filled " << r.filled << " at 10% participation\n";
+    }
+    
+    {
+        // 10k concurrent parents over 10 symbols, both sides
+        TickEngine engine;
+        std::vector<SymbolId> syms;
+        for (int s = 0; s < 10; ++s) {
+            std::string name = "ALGO-S" + std::to_string(s);
+            syms.push_back(SymbolRegistry::instance().register_symbol(name));
+            seed_levels(engine, syms.back(), Side::SELL, 1000100, 10, 5000);
+            seed_levels(engine, syms.back(), Side::BUY, 999900, 10, 5000);
+        }
+        auto* algos = new ExecutionAlgos(engine);
+        engine.add_strategy(std::unique_ptr<Strategy>(algos));
+        
+        for (int p = 0; p < 10000; ++p) {
+            ParentOrder parent;
+            parent.symbol = syms[p % 10];
+            parent.side = (p / 10) % 2 ? Side::SELL : Side::BUY;
+            parent.quantity = 10;
+            parent.end = 10 * SEC;
+            algos->submit(parent);
+        }
+        for (Timestamp ts = 0; ts < 11 * SEC; ts += 10000000) {
+            engine.process_tick(Tick{"ALGO-S" + std::to_string(ts / 10000000 % 10), 1000000, 100, ts, Side::BUY});
+        }
+        
+        assert(algos->parents() == 10000 && algos->active_parents() == 0);
+        for (ParentId p = 0; p < 10000; ++p) {
+            ExecutionReport r = algos->report(p);
+            assert(r.done && r.filled == 10);
+        }
+        assert(engine.pending_timers() == 0);
+        std::cout << "  ✓ 10,000 concurrent parents completed\n";
+    }
+    
+    {
+        // The resting side belongs to another strategy under the algo's user
+        // id: only the child is credited, not both sides of each trade
+        TickEngine engine;
+        SymbolId sym = SymbolRegistry::instance().register_symbol("ALGO-U");
+        engine.submit_order(Order(0, 1000000, 1000, 0, Side::SELL, OrderType::LIMIT, 4), sym);
+        auto* algos = new ExecutionAlgos(engine, 4);
+        engine.add_strategy(std::unique_ptr<Strategy>(algos));
+        
+        ParentOrder parent;
+        parent.symbol = sym;
+        parent.quantity = 1000;
+        parent.end = 10 * SEC;
+        ParentId twap = algos->submit(parent);
+        
+        run_ticks(engine, "ALGO-U", 0, 5 * SEC);
+        assert(algos->report(twap).filled == 500);
+        run_ticks(engine, "ALGO-U", 5 * SEC, 11 * SEC);
+        ExecutionReport r = algos->report(twap);
+        assert(r.done && r.filled == 1000 && r.children == 10);
+        assert(std::abs(r.average_price - 1000000.0) < 1e-6);
+        std::cout << "  ✓ Same-user resting orders are not credited to the parent\n";
+    }
+    
+    std::cout << "✅ Execution algos: PASSED\n\n";
+}
+
+void test_agent_simulator() {
+    std::cout << "Testing agent-based market simulator...\n";
+    
+    AgentSimConfig config;
+    config.symbol = "AGENT";
+    config.noise_agents = 20000;
+    config.market_makers = 200;
+    config.momentum_agents = 2000;
+    
+    AgentSimulator sim(config);
+    std::vector<Tick> ticks;
+    sim.run(300, &ticks);
+    
+    const auto& stats = sim.stats();
+    assert(stats.steps == 300 && stats.trades > 0 && stats.volume > 0);
+    assert(ticks.size() == stats.trades);
+    assert(sim.book().best_bid() > 0 && sim.book().best_ask() > sim.book().best_bid());
+    assert(sim.now() == config.start_time + 300 * config.step_ns);
+    std::cout << "  ✓ " << stats.orders << " orders, " << stats.trades
+              << " trades, two-sided book\n";
+    
+    // Every trade moves shares and cash between two agents
+    int64_t inventory = 0, cash = 0;
+    size_t makers_traded = 0;
+    for (size_t i = 0; i < sim.agents(); ++i) {
+        inventory += sim.inventory(i);
+        cash += sim.cash(i);
+        if (sim.type(i) == AgentSimulator::MARKET_MAKER && sim.inventory(i) != 0) ++makers_traded;
+    }
+    assert(inventory == 0 && cash == 0);
+    assert(makers_traded > 0);
+    std::cout << "  ✓ Inventory and cash conserved across agents\n";
+    
+    // Decisions run in parallel, but the tick stream must not depend on it
+    config.threads = 4;
+    AgentSimulator parallel(config);
+    std::vector<Tick> parallel_ticks;
+    parallel.run(300, &parallel_ticks);
+    assert(parallel_ticks.size() == ticks.size());
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        assert(parallel_ticks[i].price == ticks[i].price);
+        assert(parallel_ticks[i].volume == ticks[i].volume);
+        assert(parallel_ticks[i].timestamp == ticks[i].timestamp);
+        assert(parallel_ticks[i].side == ticks[i].side);
+    }
+    std::cout << "  ✓ Identical tick stream with 4 decision threads\n";
+    
+    // Captured ticks drive the engine like any other feed
+    TickEngine engine;
+    engine.add_strategy(std::make_unique<MomentumStrategy>(5, 10));
+    for (const Tick& tick : ticks) engine.process_tick(tick);
+    assert(engine.get_stats().ticks_processed == ticks.size());
+    std::cout << "  ✓ Simulated ticks replay through TickEngine\n";
+    
+    std::cout << "✅ Agent simulator: PASSED\n\n";
+}
+
+// Sums chain delta on every reprice and checks it arrives before on_tick
+class ChainDeltaProbe : public Strategy {
+public:
+    void on_chain_update(const OptionChain& chain, TickEngine* engine) override {
+        assert(chain.updated_at() == engine->now());
+        net_delta = 0.0;
+        for (size_t i = 0; i < chain.size(); ++i) net_delta += chain.deltas()[i];
+        ++chain_updates;
+        pending = true;
+    }
+    void on_tick(const Tick& tick, TickEngine*) override {
+        if (tick.symbol == "OPT-UL") {
+            assert(pending);
+            pending = false;
+        }
+        ++ticks;
+    }
+    void on_trade(const Trade&) override {}
+    const char* name() const override { return "ChainDeltaProbe"; }
+    
+    double net_delta = 0.0;
+    int chain_updates = 0;
+    int ticks = 0;
+    bool pending = false;
+};
+
+void test_option_chain() {
+    std::cout << "Testing option chains...\n";
+    
+    const Timestamp year = static_cast<Timestamp>(365.25 * 86400.0 * 1e9);
+    TickEngine engine;
+    OptionChain& chain = engine.add_option_chain("OPT-UL", 0.02);
+    size_t call = chain.add_option(1000000, year, OptionRight::CALL, 0.2);
+    size_t put = chain.add_option(1000000, year, OptionRight::PUT, 0.2);
+    size_t expiring = chain.add_option(900000, year / 2, OptionRight::CALL, 0.3);
+    auto* probe = new ChainDeltaProbe();
+    engine.add_strategy(std::unique_ptr<Strategy>(probe));
+    
+    SymbolId underlying = SymbolRegistry::instance().register_symbol("OPT-UL");
+    assert(engine.option_chain(underlying) == &chain);
+    assert(&engine.add_option_chain("OPT-UL") == &chain);
+    
+    engine.process_tick(Tick{"OTHER", 500000, 100, 0, Side::BUY});
+    assert(probe->chain_updates == 0);
+    engine.process_tick(Tick{"OPT-UL", 1000000, 100, 0, Side::BUY});
+    assert(probe->chain_updates == 1 && !probe->pending);
+    std::cout << "  ✓ Repriced on underlying ticks only, before on_tick\n";
+    
+    // At-the-money, one year: closed form with r = 2%, vol = 20%
+    double d1 = (0.02 + 0.5 * 0.2 * 0.2) / 0.2;
+    double d2 = d1 - 0.2;
+    auto cdf = [](double x) { return 0.5 * std::erfc(-x / std::sqrt(2.0)); };
+    double expected = 1000000.0 * (cdf(d1) - std::exp(-0.02) * cdf(d2));
+    assert(std::fabs(chain.value(call) - expected) < 1e-6);
+    assert(std::fabs(chain.delta(call) - cdf(d1)) < 1e-12);
+    assert(std::fabs(chain.delta(call) - chain.delta(put) - 1.0) < 1e-12);
+    assert(chain.gamma(call) == chain.gamma(put) && chain.vega(call) == chain.vega(put));
+    assert(std::fabs(probe->net_delta - (chain.delta(call) + chain.delta(put) + chain.delta(expiring))) < 1e-15);
+    std::cout << "  ✓ Values and greeks match Black-Scholes\n";
+    
+    // Past expiry the call is worth its intrinsic value
+    engine.process_tick(Tick{"OPT-UL", 1050000, 100, year / 2 + 1, Side::BUY});
+    assert(std::fabs(chain.value(expiring) - 150000.0) < 1e-3);
+    assert(chain.delta(expiring) == 1.0 && chain.gamma(expiring) < 1e-300);
+    assert(chain.spot() == 1050000 && chain.updates() == 2 && probe->ticks == 3);
+    std::cout << "  ✓ Expired contracts settle to intrinsic\n";
+    
+    std::cout << "✅ Option chains: PASSED\n\n";
+}
+
+class BarCollector : public Strategy {
+public:
+    void on_tick(const Tick&, TickEngine*) override { ++ticks; }
+    void on_trade(const Trade&) override {}
+    void on_bar(const Bar& bar, TickEngine*) override {
+        bars.push_back(bar);
+        ticks_at_bar.push_back(ticks);
+    }
+    const char* name() const override { return "BarCollector"; }
+    
+    std::vector<Bar> bars;
+    std::vector<int> ticks_at_bar;
+    int ticks = 0;
+};
+
+void test_bar_aggregation() {
+    std::cout << "Testing engine bar aggregation...\n";
+    
+    TickEngine engine;
+    auto* timed = new BarCollector();
+    auto* counted = new BarCollector();
+    engine.add_strategy(std::unique_ptr<Strategy>(timed));
+    engine.add_strategy(std::unique_ptr<Strategy>(counted));
+    size_t minute = engine.subscribe_bars(timed, BarSpec::time(60000000000ULL));
+    size_t volume = engine.subscribe_bars(counted, BarSpec::volume(500));
+    size_t dollar = engine.subscribe_bars(counted, BarSpec::dollar(20000.0));
+    size_t tick = engine.subscribe_bars(counted, BarSpec::ticks(3));
+    assert(engine.subscribe_bars(timed, BarSpec::time(60000000000ULL)) == minute);  // No duplicate
+    assert(engine.bars().resolutions() == 4);
+    
+    // Prices $100.00 + i cents, 200 shares, 20 s apart; BAR-B interleaved
+    const Timestamp sec = 1000000000ULL;
+    for (int i = 0; i < 12; ++i) {
+        Timestamp ts = static_cast<Timestamp>(i) * 20 * sec;
+        engine.process_tick(Tick{"BAR-A", 1000000 + i * 100, 200, ts, Side::BUY});
+        engine.process_tick(Tick{"BAR-B", 500000, 100, ts, Side::SELL});
+    }
+    SymbolId a = SymbolRegistry::instance().register_symbol("BAR-A");
+    
+    // Minute bars: 3 ticks each, the last one still open
+    std::vector<Bar> a_minutes;
+    for (const Bar& bar : timed->bars) {
+        assert(bar.resolution == minute);
+        if (bar.symbol == a) a_minutes.push_back(bar);
+    }
+    assert(a_minutes.size() == 3 && timed->bars.size() == 6);  // Same buckets for B
+    const Bar& first = a_minutes[0];
+    assert(first.open_time == 0 && first.close_time == 60 * sec);
+    assert(first.open == 1000000 && first.high == 1000200 && first.low == 1000000 && first.close == 1000200);
+    assert(first.volume == 600 && first.ticks == 3);
+    assert(std::fabs(first.vwap() - 100.01) < 1e-9);
+    assert(a_minutes[1].open_time == 60 * sec && a_minutes[1].open == 1000300);
+    // Delivered before on_tick of the tick that closed the bucket
+    assert(timed->ticks_at_bar[0] == 6);
+    std::cout << "  ✓ Time bars aligned to the clock, delivered before on_tick\n";
+    
+    size_t by_type[4] = {};
+    for (const Bar& bar : counted->bars) {
+        ++by_type[bar.resolution];
+        if (bar.symbol != a) continue;
+        if (bar.resolution == volume) assert(bar.volume == 600 && bar.ticks == 3);
+        if (bar.resolution == tick) assert(bar.ticks == 3);
+        if (bar.resolution == dollar) assert(bar.notional >= 20000.0 && bar.ticks == 1);
+    }
+    assert(by_type[minute] == 0);
+    assert(by_type[volume] == 4 + 2);   // A: 600 per bar; B: 500 per bar (5 ticks)
+    assert(by_type[tick] == 4 + 4);
+    assert(by_type[dollar] == 12 + 3);  // A: every tick is $20k+; B: 4 x $5k
+    std::cout << "  ✓ Volume, dollar and tick bars close on the threshold\n";
+    
+    SymbolId b = SymbolRegistry::instance().register_symbol("BAR-B");
+    const Bar* open = engine.bars().open_bar(b, volume);
+    assert(open && open->ticks == 2 && open->volume == 200);
+    assert(!engine.bars().open_bar(b, dollar));
+    size_t before = counted->bars.size();
+    engine.flush_bars();
+    assert(counted->bars.size() == before + 1 && timed->bars.size() == 8);
+    assert(!engine.bars().open_bar(b, volume));
+    std::cout << "  ✓ Partial bars flushed on demand\n";
+    
+    std::cout << "✅ Bar aggregation: PASSED\n\n";
+}
+
+// Records the order strategies are called in, and the symbols they see
+class DispatchProbe : public Strategy {
+public:
+    DispatchProbe(int id, std::vector<int>& log) : id_(id), log_(log) {}
+    void on_tick(const Tick& tick, TickEngine*) override {
+        log_.push_back(id_);
+        symbols.push_back(tick.symbol);
+    }
+    void on_trade(const Trade&) override {}
+    const char* name() const override { return "DispatchProbe"; }
+    
+    std::vector<std::string> symbols;
+    
+private:
+    int id_;
+    std::vector<int>& log_;
+};
+
+void test_symbol_subscriptions() {
+    std::cout << "Testing per-strategy symbol subscriptions...\n";
+    
+    TickEngine engine;
+    std::vector<int> log;
+    auto* everything = new DispatchProbe(0, log);
+    auto* only_a = new DispatchProbe(1, log);
+    auto* a_and_b = new DispatchProbe(2, log);
+    auto* late = new DispatchProbe(3, log);
+    engine.add_strategy(std::unique_ptr<Strategy>(only_a), {"SUB-A"});
+    engine.add_strategy(std::unique_ptr<Strategy>(everything));
+    engine.add_strategy(std::unique_ptr<Strategy>(a_and_b), {"SUB-A", "SUB-B", "SUB-A"});
+    engine.add_strategy(std::unique_ptr<Strategy>(late), {});
+    
+    engine.process_tick(Tick{"SUB-A", 1000000, 100, 1, Side::BUY});
+    engine.process_tick(Tick{"SUB-B", 1000000, 100, 2, Side::BUY});
+    engine.process_tick(Tick{"SUB-C", 1000000, 100, 3, Side::BUY});  // Never subscribed
+    assert((log == std::vector<int>{1, 0, 2, 0, 2, 0}));  // Registration order per tick
+    assert(only_a->symbols.size() == 1 && a_and_b->symbols.size() == 2);
+    assert(everything->symbols.size() == 3 && late->symbols.empty());
+    std::cout << "  ✓ Ticks reach subscribers only, in registration order\n";
+    
+    // Subscriptions can be added mid-run, including for unseen symbols
+    engine.subscribe(late, "SUB-C");
+    engine.subscribe(late, "SUB-D");
+    engine.subscribe(everything, "SUB-A");  // Already sees everything
+    log.clear();
+    engine.process_tick(Tick{"SUB-C", 1000000, 100, 4, Side::BUY});
+    engine.process_tick(Tick{"SUB-D", 1000000, 100, 5, Side::BUY});
+    engine.process_tick(Tick{"SUB-A", 1000000, 100, 6, Side::BUY});
+    assert((log == std::vector<int>{0, 3, 0, 3, 1, 0, 2}));
+    std::cout << "  ✓ Subscriptions added during a run take effect on the next tick\n";
+    
+    std::cout << "✅ Symbol subscriptions: PASSED\n\n";
+}
+
+// Sends `orders` resting buys per tick and records coalesced book updates
+class BookUpdateProbe : public Strategy {
+public:
+    explicit BookUpdateProbe(int orders) : orders_(orders) {}
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        for (int i = 0; i < orders_; ++i) {
+            engine->submit_order(Order(0, tick.price - 100 * (i + 1), 10, tick.timestamp,
+                                       Side::BUY, OrderType::LIMIT, 1));
+        }
+    }
+    void on_trade(const Trade&) override {}
+    void on_book_update(SymbolId symbol, TickEngine* engine) override {
+        updates.emplace_back(symbol, engine->now());
+        const OrderBook* book = engine->get_order_book(symbol);
+        bid_volumes.push_back(book->bid_volume());
+    }
+    const char* name() const override { return "BookUpdateProbe"; }
+    
+    std::vector<std::pair<SymbolId, Timestamp>> updates;
+    std::vector<Quantity> bid_volumes;
+    
+private:
+    int orders_;
+};
+
+void test_coalesced_book_updates() {
+    std::cout << "Testing coalesced book updates...\n";
+    
+    TickEngine engine;
+    engine.process_tick(Tick{"UPD-A", 1000000, 100, 0, Side::BUY});  // Book exists before enabling
+    engine.enable_book_updates();
+    auto* probe = new BookUpdateProbe(5);
+    auto* watcher = new BookUpdateProbe(0);
+    engine.add_strategy(std::unique_ptr<Strategy>(probe));
+    engine.add_strategy(std::unique_ptr<Strategy>(watcher), {"UPD-B"});
+    SymbolId a = SymbolRegistry::instance().register_symbol("UPD-A");
+    
+    // Two timestamps, three ticks each over two symbols: 30 book changes per timestamp
+    std::vector<Tick> ticks;
+    for (Timestamp ts : {1000, 2000}) {
+        ticks.push_back(Tick{"UPD-A", 1000000, 100, ts, Side::BUY});
+        ticks.push_back(Tick{"UPD-B", 2000000, 100, ts, Side::BUY});
+        ticks.push_back(Tick{"UPD-A", 1000000, 100, ts, Side::BUY});
+    }
+    engine.run_backtest(ticks);
+    SymbolId b = SymbolRegistry::instance().register_symbol("UPD-B");
+    
+    // One callback per dirty book per timestamp; the book is already final
+    assert(probe->updates.size() == 4);
+    assert(engine.get_stats().book_updates == 4);
+    SymbolId low = std::min(a, b), high = std::max(a, b);
+    assert((probe->updates[0] == std::pair<SymbolId, Timestamp>{low, 1000}));   // Delivered as time moves on
+    assert((probe->updates[1] == std::pair<SymbolId, Timestamp>{high, 1000}));
+    assert(probe->updates[2].second == 2000);  // End of run_backtest
+    assert(probe->bid_volumes[a == low ? 0 : 1] == 100);   // Two ticks x five orders x 10
+    assert(probe->bid_volumes[a == low ? 1 : 0] == 50);
+    std::cout << "  ✓ One on_book_update per changed book per timestamp\n";
+    
+    // Subscriptions apply: the watcher only hears about UPD-B
+    assert(watcher->updates.size() == 2);
+    assert(watcher->updates[0].first == b && watcher->updates[1].first == b);
+    
+    // Nothing changed, nothing delivered
+    engine.process_tick(Tick{"UPD-C", 1000000, 100, 3000, Side::BUY});
+    engine.flush_book_updates();
+    assert(engine.get_stats().book_updates == 5);  // Only UPD-C (the probe's orders)
+    engine.flush_book_updates();
+    assert(engine.get_stats().book_updates == 5);
+    std::cout << "  ✓ Subscriptions and explicit flushes\n";
+    
+    std::cout << "✅ Coalesced book updates: PASSED\n\n";
+}
+
+// Quotes the symbols in `targets` (the tick's own symbol if empty) around
+// each tick, keeps four working orders, sweeps on timers and logs every
+// callback it gets, so two runs can be compared event by event
+class CrossProbe : public Strategy {
+public:
+    CrossProbe(uint32_t user, const std::vector<std::string>& targets) : user_(user), rng_(user * 7919) {
+        for (const auto& symbol : targets) {
+            targets_.push_back(SymbolRegistry::instance().register_symbol(symbol));
+        }
+    }
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        log(1, tick.timestamp, tick.price, engine->now());
+        for (size_t i = 0; i < working_.size(); ++i) {  // Handles differ by shard; statuses may not
+            auto status = engine->order_status(working_[i]);
+            log(4, i, status ? static_cast<uint64_t>(*status) + 1 : 0, 0);
+        }
+        if (working_.size() >= 4) {
+            engine->release_order(working_.front());
+            working_.erase(working_.begin());
+        }
+        
+        Side side = next() % 2 ? Side::BUY : Side::SELL;
+        Price offset = static_cast<Price>(next() % 5) * 100 - 200;
+        Order order(0, tick.price + offset, 100 * (1 + next() % 4), tick.timestamp, side, OrderType::LIMIT, user_);
+        if (targets_.empty()) {
+            working_.push_back(next() % 3 ? engine->submit_order(order)
+                                          : engine->submit_gtt_order(order, tick.timestamp + 2500));
+        } else {
+            working_.push_back(engine->submit_order(order, targets_[next() % targets_.size()]));
+        }
+        if (next() % 5 == 0) {
+            engine->schedule_timer(tick.timestamp + 1500, this, tick.price);
+        }
+    }
+    void on_timer(uint64_t tag, TickEngine* engine) override {
+        log(3, tag, engine->now(), 0);
+        if (!targets_.empty()) {  // No tick, so no current book: needs a symbol
+            engine->submit_order(Order(0, static_cast<Price>(tag), 200, 0, Side::SELL, OrderType::MARKET, user_),
+                                 targets_[next() % targets_.size()]);
+        }
+    }
+    void on_trade(const Trade& trade) override {
+        log(2, static_cast<uint64_t>(trade.price) << 20 | trade.quantity, trade.timestamp,
+            (trade.buy_order_id != 0) | (trade.sell_order_id != 0) << 1);
+        if (trade.buy_order_id != 0 || trade.sell_order_id != 0) ++own_fills;
+    }
+    const char* name() const override { return "CrossProbe"; }
+    
+    std::vector<uint64_t> events;
+    size_t own_fills = 0;
+    
+private:
+    uint64_t next() { rng_ = rng_ * 6364136223846793005ULL + 1442695040888963407ULL; return rng_ >> 33; }
+    void log(uint64_t kind, uint64_t a, uint64_t b, uint64_t c) {
+        events.push_back(mix64(kind ^ mix64(a ^ mix64(b ^ mix64(c)))));
+    }
+    
+    uint32_t user_;
+    uint64_t rng_;
+    std::vector<SymbolId> targets_;
+    std::vector<OrderHandle> working_;
+};
+
+void test_parallel_backtest() {
+    std::cout << "Testing conservative parallel backtest...\n";
+    
+    const std::vector<std::string> symbols = {"PDES-IDX", "PDES-A", "PDES-B", "PDES-C"};
+    std::vector<Tick> ticks;
+    std::mt19937_64 rng(99);
+    std::vector<Price> prices(symbols.size(), 1000000);
+    Timestamp ts = 1000000;
+    for (int i = 0; i < 3000; ++i) {
+        ts += (rng() % 4) * 250;  // Some ticks share a timestamp
+        size_t s = rng() % symbols.size();
+        prices[s] += static_cast<Price>(rng() % 5) * 100 - 200;
+        ticks.push_back(Tick{symbols[s], prices[s], 100, ts, Side::BUY});
+    }
+    
+    struct Result {
+        TickEngine::Stats stats;
+        std::vector<std::vector<uint64_t>> events;
+        size_t own_fills = 0;
+    };
+    auto run = [&](size_t shards, std::vector<uint16_t> shard_of) {
+        TickEngine engine;
+        std::vector<CrossProbe*> probes;
+        auto add = [&](CrossProbe* probe, std::vector<std::string> subscribed) {
+            probes.push_back(probe);
+            if (subscribed.empty()) engine.add_strategy(std::unique_ptr<Strategy>(probe));
+            else engine.add_strategy(std::unique_ptr<Strategy>(probe), subscribed);
+        };
+        add(new CrossProbe(1, symbols), symbols);                // Index arb over every book
+        add(new CrossProbe(2, {}), {"PDES-A"});                  // Single-symbol quoters
+        add(new CrossProbe(3, {}), {"PDES-B"});
+        add(new CrossProbe(4, {"PDES-C", "PDES-IDX"}), {"PDES-C"});
+        add(new CrossProbe(5, {"PDES-A"}), {});                  // Sees every tick
+        
+        ParallelConfig config;
+        config.shards = shards;
+        config.order_latency = 400;
+        config.shard_of = std::move(shard_of);
+        engine.run_backtest(ticks, config);
+        
+        Result result{engine.get_stats(), {}, 0};
+        for (CrossProbe* probe : probes) {
+            result.events.push_back(probe->events);
+            result.own_fills += probe->own_fills;
+        }
+        return result;
+    };
+    
+    Result serial = run(1, {});
+    assert(serial.stats.ticks_processed == ticks.size());
+    assert(serial.stats.trades_executed > 100 && serial.own_fills > 100);
+    assert(serial.stats.orders_submitted > 2000);
+    
+    // Any shard count or mapping replays the same run
+    std::vector<uint16_t> reversed(SymbolRegistry::instance().size());
+    for (const auto& symbol : symbols) {
+        SymbolId id = SymbolRegistry::instance().register_symbol(symbol);
+        reversed[id] = static_cast<uint16_t>(3 - (id % 4));
+    }
+    for (auto& [shards, shard_of] : std::vector<std::pair<size_t, std::vector<uint16_t>>>{
+             {1, {}}, {2, {}}, {4, {}}, {4, reversed}, {3, {}}}) {
+        Result sharded = run(shards, shard_of);
+        assert(sharded.stats.fingerprint == serial.stats.fingerprint);
+        assert(sharded.stats.trades_executed == serial.stats.trades_executed);
+        assert(sharded.stats.orders_submitted == serial.stats.orders_submitted);
+        assert(sharded.own_fills == serial.own_fills);
+        assert(sharded.events == serial.events);
+    }
+    std::cout << "  ✓ Identical fingerprint and callback streams for 1-4 shards and any mapping\n";
+    
+    // Latency: an order reaches its book L after it is sent, the fill is
+    // reported L after it happens
+    TickEngine engine;
+    struct Taker : Strategy {
+        void on_tick(const Tick& tick, TickEngine* engine) override {
+            if (tick.symbol == "PDES-B") {  // The other strategy's resting sell
+                engine->submit_order(Order(0, 1000000, 100, 0, Side::SELL, OrderType::LIMIT, 1),
+                                     SymbolRegistry::instance().register_symbol("PDES-A"));
+            } else if (tick.timestamp == 1050) {
+                handle = engine->submit_order(Order(0, tick.price, 100, 0, Side::BUY, OrderType::LIMIT, 2));
+                assert(engine->order_status(handle) == OrderStatus::PENDING);
+            } else if (tick.timestamp == 1300) {
+                assert(engine->order_status(handle) == OrderStatus::FILLED);
+            }
+        }
+        void on_trade(const Trade& trade) override {
+            if (handle == INVALID_ORDER_HANDLE) {  // The seller: only its own side is visible
+                assert(trade.buy_order_id == 0 && trade.sell_order_id != 0);
+                return;
+            }
+            assert(trade.buy_order_id == handle && trade.sell_order_id == 0);
+            assert(trade.timestamp == 1150);
+            ++fills;
+        }
+        const char* name() const override { return "Taker"; }
+        OrderHandle handle = INVALID_ORDER_HANDLE;
+        int fills = 0;
+    };
+    auto* taker = new Taker;
+    engine.add_strategy(std::make_unique<Taker>(), {"PDES-B"});
+    engine.add_strategy(std::unique_ptr<Strategy>(taker), {"PDES-A"});
+    std::vector<Tick> few = {Tick{"PDES-B", 1000000, 100, 1000, Side::BUY},
+                             Tick{"PDES-A", 1000000, 100, 1050, Side::BUY},
+                             Tick{"PDES-A", 1000000, 100, 1300, Side::BUY}};
+    engine.run_backtest(few, ParallelConfig{2, 100, {}});
+    assert(taker->fills == 1 && engine.get_stats().trades_executed == 1);
+    assert(engine.get_order_book("PDES-A")->bid_volume() == 0);
+    std::cout << "  ✓ Orders arrive and fills are reported after the order latency\n";
+    
+    bool threw = false;
+    try {
+        engine.run_backtest(few, ParallelConfig{2, 0, {}});
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "  ✓ Zero lookahead is rejected\n";
+    
+    // A one-argument submit_order outside on_tick has no book to go to
+    struct TimerQuoter : Strategy {
+        void on_tick(const Tick& tick, TickEngine* engine) override {
+            if (!armed) engine->schedule_timer(tick.timestamp + 100, this);
+            armed = true;
+        }
+        void on_timer(uint64_t, TickEngine* engine) override {
+            engine->submit_order(Order(0, 990000, 10, 0, Side::BUY, OrderType::LIMIT, 7));
+        }
+        void on_trade(const Trade&) override {}
+        const char* name() const override { return "TimerQuoter"; }
+        bool armed = false;
+    };
+    TickEngine timed;
+    timed.add_strategy(std::make_unique<TimerQuoter>(), {"PDES-A"});
+    threw = false;
+    try {
+        timed.run_backtest(few, ParallelConfig{2, 100, {}});
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "  ✓ Symbol-less submits from timers are rejected\n";
+    
+    std::cout << "✅ Parallel backtest: PASSED\n\n";
+}
+
+// Crosses its own buy and sell at the tick price, so its book is empty
+// again after every tick
+class Flipper : public Strategy {
+public:
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        events.push_back(mix64(tick.timestamp ^ mix64(static_cast<uint64_t>(tick.price))));
+        for (OrderHandle handle : working_) {
+            auto status = engine->order_status(handle);
+            events.push_back(status ? static_cast<uint64_t>(*status) + 1 : 0);
+            engine->release_order(handle);
+        }
+        working_.clear();
+        working_.push_back(engine->submit_order(Order(0, tick.price, 100, 0, Side::BUY, OrderType::LIMIT, 7)));
+        working_.push_back(engine->submit_order(Order(0, tick.price, 100, 0, Side::SELL, OrderType::LIMIT, 7)));
+    }
+    void on_trade(const Trade& trade) override {
+        events.push_back(mix64(static_cast<uint64_t>(trade.price) ^ mix64(trade.timestamp)));
+    }
+    const char* name() const override { return "Flipper"; }
+    
+    std::vector<uint64_t> events;
+    
+private:
+    std::vector<OrderHandle> working_;
+};
+
+void test_shard_planning() {
+    std::cout << "Testing activity-aware shard planning and rebalancing...\n";
+    
+    auto& registry = SymbolRegistry::instance();
+    std::vector<std::string> symbols;
+    for (int i = 0; i < 8; ++i) symbols.push_back("PLAN-" + std::to_string(i));
+    
+    // Two hot symbols, both on shard 0 under a round-robin mapping
+    std::vector<Tick> ticks;
+    std::mt19937_64 rng(100);
+    Timestamp ts = 1000000;
+    for (int i = 0; i < 4000; ++i) {
+        ts += 100 + (rng() % 3) * 100;
+        uint64_t r = rng() % 10;
+        size_t s = r < 4 ? 0 : r < 8 ? 4 : 1 + rng() % 7;
+        ticks.push_back(Tick{symbols[s], 1000000 + static_cast<Price>(rng() % 20) * 100, 100, ts, Side::BUY});
+    }
+    SymbolId hot_a = registry.register_symbol(symbols[0]);
+    SymbolId hot_b = registry.register_symbol(symbols[4]);
+    ActivityProfile activity = measure_activity(ticks);
+    std::vector<uint16_t> skewed(activity.size());  // Round robin in listing order
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        skewed[registry.register_symbol(symbols[i])] = static_cast<uint16_t>(i % 4);
+    }
+    
+    size_t hot_ticks = std::count_if(ticks.begin(), ticks.end(),
+                                     [&](const Tick& tick) { return tick.symbol == symbols[0]; });
+    assert(activity[hot_a].ticks == hot_ticks);
+    
+    ShardPlan plan = plan_shards(activity, 4);
+    assert(plan.shard_of[hot_a] != plan.shard_of[hot_b]);
+    assert(plan.balance_factor < balance_factor(activity, skewed, 4));
+    assert(plan.balance_factor == balance_factor(activity, plan.shard_of, 4));
+    bool threw = false;
+    try {
+        balance_factor(activity, std::vector<uint16_t>(activity.size(), 4), 4);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(plan_shards(activity, 4).shard_of == plan.shard_of);
+    std::cout << "  ✓ LPT plan spreads the hot symbols (predicted balance " << plan.balance_factor << ")\n";
+    
+    struct Result {
+        TickEngine::Stats stats;
+        TickEngine::ParallelStats parallel;
+        ActivityProfile activity;
+        std::vector<std::vector<uint64_t>> events;
+    };
+    auto run = [&](ParallelConfig config) {
+        TickEngine engine;
+        std::vector<Flipper*> flippers;
+        for (const auto& symbol : symbols) {
+            flippers.push_back(new Flipper);
+            engine.add_strategy(std::unique_ptr<Strategy>(flippers.back()), {symbol});
+        }
+        auto* probe = new CrossProbe(9, {symbols[2]});
+        engine.add_strategy(std::unique_ptr<Strategy>(probe), {symbols[3]});
+        config.order_latency = 250;
+        engine.run_backtest(ticks, config);
+        for (const auto& symbol : symbols) {
+            assert(engine.get_order_book(symbol) != nullptr);  // Found wherever it moved
+        }
+        
+        Result result{engine.get_stats(), engine.parallel_stats(), engine.symbol_activity(), {}};
+        for (Flipper* flipper : flippers) result.events.push_back(flipper->events);
+        result.events.push_back(probe->events);
+        return result;
+    };
+    
+    Result serial = run(ParallelConfig{});
+    assert(serial.activity[hot_a].ticks == hot_ticks);
+    assert(serial.activity[hot_a].orders == 2 * hot_ticks);
+    assert(serial.parallel.shard_work.size() == 1 && serial.parallel.balance_factor == 1.0);
+    assert(serial.stats.trades_executed > 2 * hot_ticks);
+    
+    ParallelConfig modulo;
+    modulo.shards = 4;
+    modulo.shard_of = skewed;
+    Result unbalanced = run(modulo);
+    
+    ParallelConfig planned = modulo;
+    planned.shard_of = plan.shard_of;
+    Result balanced = run(planned);
+    assert(balanced.parallel.balance_factor < unbalanced.parallel.balance_factor);
+    
+    // Aggressive rebalancing from the skewed mapping: books move, the run
+    // stays the serial run
+    ParallelConfig rebalanced = modulo;
+    rebalanced.rebalance_interval = 20000;
+    rebalanced.rebalance_threshold = 1.05;
+    Result moved = run(rebalanced);
+    assert(moved.parallel.migrations > 0);
+    assert(moved.parallel.windows > 0 && moved.parallel.shard_work.size() == 4);
+    
+    for (const Result* result : {&unbalanced, &balanced, &moved}) {
+        assert(result->stats.fingerprint == serial.stats.fingerprint);
+        assert(result->stats.trades_executed == serial.stats.trades_executed);
+        assert(result->events == serial.events);
+        assert(result->activity[hot_b].orders == serial.activity[hot_b].orders);
+    }
+    std::cout << "  ✓ Measured balance " << unbalanced.parallel.balance_factor << " (round robin) -> "
+              << balanced.parallel.balance_factor << " (planned); " << moved.parallel.migrations
+              << " migrations, all runs identical to serial\n";
+    
+    std::cout << "✅ Shard planning: PASSED\n\n";
+}
+
 int main() {
     std::cout << "=== Strategy Correctness Tests ===\n\n";
     
@@ -147,6 +1473,25 @@ int main() {
         test_market_maker_quoting();
         test_strategy_position_tracking();
         test_multiple_strategies();
+        test_order_handles();
+        test_engine_timers();
+        test_engine_spread_routing();
+        test_engine_book_features();
+        test_run_fingerprint();
+        test_book_sampler();
+        test_live_stats_segment();
+        test_rolling_regression();
+        test_pairs_strategy();
+        test_worker_pool();
+        test_rolling_covariance();
+        test_execution_algos();
+        test_agent_simulator();
+        test_option_chain();
+        test_bar_aggregation();
+        test_symbol_subscriptions();
+        test_coalesced_book_updates();
+        test_parallel_backtest();
+        test_shard_planning();
         
         std::cout << "=== ALL STRATEGY TESTS PASSED ===\n";
         return 0;
@@ -0,0 +1,185 @@
+#include "timer_wheel.hpp"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace trading;
+
+void test_fire_order_and_cancel() {
+    std::cout << "Testing timer ordering and cancellation...\n";
+    
+    TimerWheel<int> wheel(1000);
+    std::vector<int> fired;
+    auto record = [&](TimerId, int payload) { fired.push_back(payload); };
+    
+    wheel.schedule(5000, 2);
+    TimerId cancelled = wheel.schedule(3000, 99);
+    wheel.schedule(1500, 1);            // Rounds up to 2000: never early
+    wheel.schedule(70000000000ULL, 4);  // Beyond the wheel: overflow list
+    wheel.schedule(300000000, 3);       // Level 2
+    assert(wheel.size() == 5);
+    
+    assert(wheel.cancel(cancelled));
+    assert(!wheel.cancel(cancelled));
+    assert(!wheel.cancel(INVALID_TIMER_ID));
+    assert(wheel.next_deadline() == 2000);
+    
+    wheel.advance(1999, record);
+    assert(fired.empty());
+    wheel.advance(2000, record);
+    assert((fired == std::vector<int>{1}));
+    wheel.advance(400000000, record);
+    assert((fired == std::vector<int>{1, 2, 3}));
+    assert(wheel.next_deadline() <= 70000000000ULL);  // Lower bound while the overflow list waits
+    wheel.advance(69999999999ULL, record);
+    assert(fired.size() == 3 && wheel.size() == 1);
+    wheel.advance(70000000000ULL, record);
+    assert((fired == std::vector<int>{1, 2, 3, 4}) && wheel.size() == 0);
+    assert(wheel.next_deadline() == std::numeric_limits<Timestamp>::max());
+    
+    // Deadlines already in the past fire on the next advance
+    wheel.schedule(10, 5);
+    wheel.advance(70000000000ULL, record);
+    assert(fired.back() == 5);
+    
+    std::cout << "  ✓ Deadline order across levels and overflow\n";
+    std::cout << "✅ Timer ordering: PASSED\n\n";
+}
+
+void test_callbacks_modify_wheel() {
+    std::cout << "Testing rescheduling from callbacks...\n";
+    
+    TimerWheel<int> wheel(1);
+    int periodic = 0;
+    TimerId victim = INVALID_TIMER_ID;
+    
+    // A periodic timer, plus one that cancels a peer due in the same unit
+    auto on_expire = [&](TimerId, int payload) {
+        if (payload == 0) {
+            ++periodic;
+            wheel.schedule((periodic + 1) * 100, 0);
+        } else if (payload == 1) {
+            assert(wheel.cancel(victim));
+        } else {
+            assert(false);  // The victim must never fire
+        }
+    };
+    wheel.schedule(100, 0);
+    wheel.schedule(50, 1);
+    victim = wheel.schedule(50, 2);
+    
+    wheel.advance(1050, on_expire);
+    assert(periodic == 10);
+    assert(wheel.size() == 1);
+    
+    std::cout << "  ✓ Periodic re-arm and same-bucket cancel\n";
+    std::cout << "✅ Callback reentrancy: PASSED\n\n";
+}
+
+// Randomized comparison against an ordered multimap
+void test_matches_reference() {
+    std::cout << "Testing against ordered-map reference...\n";
+    
+    TimerWheel<uint64_t> wheel(1);
+    std::multimap<uint64_t, uint64_t> reference;  // deadline -> payload
+    std::map<uint64_t, TimerId> ids;               // payload -> id
+    std::mt19937_64 rng(11);
+    
+    uint64_t now = 0;
+    uint64_t next_payload = 0;
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            // Mix near, mid-range and far (overflow) deadlines
+            uint64_t span = 1ULL << (4 + rng() % 34);
+            uint64_t deadline = now + rng() % span;
+            ids[next_payload] = wheel.schedule(deadline, next_payload);
+            reference.emplace(deadline, next_payload++);
+        }
+        for (int i = 0; i < 20 && !ids.empty(); ++i) {
+            auto it = ids.lower_bound(rng() % next_payload);
+            if (it == ids.end()) continue;
+            assert(wheel.cancel(it->second));
+            for (auto r = reference.begin(); r != reference.end(); ++r) {
+                if (r->second == it->first) { reference.erase(r); break; }
+            }
+            ids.erase(it);
+        }
+        
+        now += rng() % (1ULL << (rng() % 30));
+        uint64_t last_deadline = 0;
+        size_t expected = std::distance(reference.begin(), reference.upper_bound(now));
+        size_t fired = wheel.advance(now, [&](TimerId id, uint64_t payload) {
+            auto r = reference.begin();
+            assert(r != reference.end() && r->first <= now);
+            // Equal deadlines may fire in any order; deadlines never go backwards
+            auto match = r;
+            while (match->second != payload) {
+                ++match;
+                assert(match != reference.end() && match->first == r->first);
+            }
+            assert(match->first >= last_deadline);
+            last_deadline = match->first;
+            assert(ids[payload] == id);
+            ids.erase(payload);
+            reference.erase(match);
+        });
+        assert(fired == expected);
+        assert(wheel.size() == reference.size());
+    }
+    
+    std::cout << "  ✓ " << next_payload << " timers matched\n";
+    std::cout << "✅ Reference agreement: PASSED\n\n";
+}
+
+void test_million_timers() {
+    std::cout << "Testing with one million pending timers...\n";
+    
+    TimerWheel<uint64_t> wheel(1000);
+    std::mt19937_64 rng(3);
+    const uint64_t horizon = 3600ULL * 1000000000ULL;  // One hour of simulated time
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<TimerId> ids;
+    ids.reserve(1000000);
+    for (uint64_t i = 0; i < 1000000; ++i) {
+        ids.push_back(wheel.schedule(rng() % horizon, i));
+    }
+    auto scheduled = std::chrono::high_resolution_clock::now();
+    
+    for (size_t i = 0; i < ids.size(); i += 2) {
+        wheel.cancel(ids[i]);
+    }
+    
+    size_t fired = 0;
+    for (uint64_t t = 0; t <= horizon; t += 1000000) {  // 1 ms steps
+        fired += wheel.advance(t, [](TimerId, uint64_t) {});
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    assert(fired == 500000 && wheel.size() == 0);
+    
+    auto us = [](auto d) { return std::chrono::duration_cast<std::chrono::microseconds>(d).count(); };
+    std::cout << "  Schedule: " << us(scheduled - start) / 1000.0 << " ns/timer\n";
+    std::cout << "  Cancel + expire: " << us(end - scheduled) << " µs for 3.6M advances\n";
+    std::cout << "✅ Million timers: PASSED\n\n";
+}
+
+int main() {
+    std::cout << "=== Timer Wheel Tests ===\n\n";
+    
+    try {
+        test_fire_order_and_cancel();
+        test_callbacks_modify_wheel();
+        test_matches_reference();
+        test_million_timers();
+        
+        std::cout << "=== ALL TIMER WHEEL TESTS PASSED ===\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "❌ TEST FAILED: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,66 +1,469 @@
 #include "tick_engine.hpp"
+#include <algorithm>
 #include <chrono>
+#include <bit>
 
 namespace trading {
 
 TickEngine::TickEngine() {}
 
 void TickEngine::process_tick(const Tick& tick) {
-    auto start = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::steady_clock::now();  // Monotonic: latencies are never negative
     
+    if (tick.timestamp != current_time_ && dirty_books_.any()) {
+        flush_book_updates();  // End of the previous timestamp's batch
+    }
     current_time_ = tick.timestamp;
     
-    // Get or create order book
-    auto it = order_books_.find(tick.symbol);
-    if (it == order_books_.end()) {
-        auto ob = std::make_unique<OrderBook>(tick.symbol);
-        ob->set_trade_callback([this](const Trade& t) { on_trade(t); });
-        order_books_[tick.symbol] = std::move(ob);
-        it = order_books_.find(tick.symbol);
+    current_book_ = get_or_create_book(tick.symbol);
+    
+    if (timers_.size() > 0) {
+        fire_timers(current_time_);
     }
     
-    // Notify strategies
-    for (auto& strategy : strategies_) {
-        strategy->on_tick(tick, this);
+    SymbolId symbol = current_book_->symbol_id();
+    auto [first, last] = subscribers(symbol);
+    if (symbol >= activity_.size()) {
+        activity_.resize(symbol + 1);
+    }
+    ++activity_[symbol].ticks;
+    
+    if (symbol < chain_by_id_.size() && chain_by_id_[symbol]) {
+        OptionChain& chain = *chain_by_id_[symbol];
+        chain.update(tick.price, tick.timestamp);
+        for (Strategy* const* it = first; it != last; ++it) {
+            (*it)->on_chain_update(chain, this);
+        }
+    }
+    
+    if (bars_.resolutions() > 0) {
+        bars_.add(symbol, tick, [this](const Bar& bar) { deliver_bar(bar); });
+    }
+    
+    // Notify subscribed strategies
+    for (Strategy* const* it = first; it != last; ++it) {
+        (*it)->on_tick(tick, this);
+    }
+    
+    if (sampler_) {
+        sampler_->on_event(current_time_);
     }
     
-    auto end = std::chrono::high_resolution_clock::now();
+    auto end = std::chrono::steady_clock::now();
     auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
     
     ++stats_.ticks_processed;
     stats_.total_latency_ns += latency;
+    
+    if (live_stats_) {
+        size_t bucket = std::bit_width(static_cast<uint64_t>(latency));
+        ++latency_histogram_[std::min(bucket, latency_histogram_.size() - 1)];
+        if (--ticks_until_publish_ == 0) {
+            publish_live_stats();
+        }
+    }
+}
+
+OrderHandle TickEngine::submit_order(const Order& order_template) {
+    if (parallel_) return parallel_submit(order_template, current_symbol_);
+    return route_order(order_template, current_book_);
 }
 
-void TickEngine::submit_order(const Order& order_template) {
-    Order* order = order_pool_.allocate();
+OrderHandle TickEngine::submit_order(const Order& order_template, SymbolId symbol) {
+    if (parallel_) return parallel_submit(order_template, symbol);
+    OrderBook* book = get_order_book(symbol);
+    if (!book && symbol < SymbolRegistry::instance().size()) {
+        book = get_or_create_book(SymbolRegistry::instance().get_symbol(symbol));
+    }
+    return route_order(order_template, book);
+}
+
+OrderHandle TickEngine::submit_gtt_order(const Order& order_template, Timestamp expire_at) {
+    OrderHandle handle = submit_order(order_template);
+    const Order* order = find_order(handle);
+    if (order->status == OrderStatus::PENDING || order->status == OrderStatus::PARTIAL) {
+        timers_.schedule(expire_at, EngineTimer{nullptr, handle});
+    }
+    return handle;
+}
+
+TimerId TickEngine::schedule_timer(Timestamp deadline, Strategy* strategy, uint64_t tag) {
+    return timers_.schedule(deadline, EngineTimer{strategy, tag});
+}
+
+void TickEngine::fire_timers(Timestamp now) {
+    timers_.advance(now, [this](TimerId, const EngineTimer& timer) {
+        if (timer.strategy) {
+            active_ = timer.strategy;
+            timer.strategy->on_timer(timer.data, this);
+        } else {
+            cancel_order(timer.data);  // No-op if already filled, cancelled or released
+        }
+    });
+}
+
+OrderHandle TickEngine::route_order(const Order& order_template, OrderBook* book) {
+    OrderHandle handle = new_order(order_template);
+    Order* order = order_pool_.at(handle_slot(handle));
+    
+    if (!book) {
+        order->status = OrderStatus::CANCELLED;  // No book to route to
+        return handle;
+    }
+    enter_order(order, book);
+    return handle;
+}
+
+OrderHandle TickEngine::new_order(const Order& order_template) {
+    size_t slot = order_pool_.allocate_slot();
+    OrderHandle handle = make_order_handle(static_cast<uint32_t>(slot),
+                                           order_pool_.generation(slot));
+    
+    Order* order = order_pool_.at(slot);
     *order = order_template;
-    order->id = next_order_id_++;
+    order->id = handle;
     order->timestamp = current_time_;
+    return handle;
+}
+
+void TickEngine::enter_order(Order* order, OrderBook* book) {
+    size_t slot = handle_slot(order->id);
+    if (order_symbols_.size() < order_pool_.capacity()) {
+        order_symbols_.resize(order_pool_.capacity());
+    }
+    order_symbols_[slot] = book->symbol_id();
+    
+    SymbolId symbol = book->symbol_id();
+    if (symbol >= activity_.size()) {
+        activity_.resize(symbol + 1);
+    }
+    ++activity_[symbol].orders;
+    if (symbol < spread_by_id_.size() && spread_by_id_[symbol]) {
+        spread_by_id_[symbol]->add_order(order);
+    } else if (symbol < spreads_by_leg_.size() && !spreads_by_leg_[symbol].empty()) {
+        const auto& spreads = spreads_by_leg_[symbol];
+        ImpliedSpread::add_outright(order, *book, spreads.data(), spreads.data() + spreads.size());
+    } else {
+        book->add_order(order);
+    }
+    ++stats_.orders_submitted;
+    
+    fingerprint_.record(book->symbol_id(), RunFingerprint::ORDER_ACK,
+                        static_cast<uint64_t>(order->price), static_cast<uint64_t>(order->quantity),
+                        order->user_id | static_cast<uint64_t>(order->side) << 32 |
+                            static_cast<uint64_t>(order->type) << 40,
+                        static_cast<uint64_t>(order->filled) << 8 | static_cast<uint64_t>(order->status));
+    stats_.fingerprint = fingerprint_.value();
+}
+
+OrderHandle TickEngine::next_order_handle() const {
+    size_t slot = order_pool_.next_slot();
+    uint32_t generation = slot < order_pool_.capacity() ? order_pool_.generation(slot) : 1;  // Fresh block
+    return make_order_handle(static_cast<uint32_t>(slot), generation);
+}
+
+const Order* TickEngine::find_order(OrderHandle handle) const {
+    uint32_t slot = handle_slot(handle);
+    if (slot >= order_pool_.capacity() ||
+        order_pool_.generation(slot) != handle_generation(handle)) {
+        return nullptr;
+    }
+    return order_pool_.at(slot);
+}
+
+std::optional<OrderStatus> TickEngine::order_status(OrderHandle handle) const {
+    const Order* order = find_order(handle);
+    if (!order) return std::nullopt;
+    return order->status;
+}
+
+bool TickEngine::cancel_order(OrderHandle handle) {
+    if (parallel_) return parallel_cancel(handle);
+    Order* order = const_cast<Order*>(find_order(handle));
+    if (!order || order->status == OrderStatus::CANCELLED) return false;
     
-    // Use first available order book (in production, pass symbol with order)
-    if (!order_books_.empty()) {
-        order_books_.begin()->second->add_order(order);
-        ++stats_.orders_submitted;
+    OrderBook* book = book_of(handle_slot(handle));
+    if (!book->cancel_order(order)) return false;
+    
+    fingerprint_.record(book->symbol_id(), RunFingerprint::CANCEL,
+                        static_cast<uint64_t>(order->price), static_cast<uint64_t>(order->remaining()),
+                        order->user_id, current_time_);
+    stats_.fingerprint = fingerprint_.value();
+    return true;
+}
+
+void TickEngine::release_order(OrderHandle handle) {
+    if (!find_order(handle)) return;
+    cancel_order(handle);  // Never recycle a slot a book still points at
+    order_pool_.release(handle_slot(handle));
+}
+
+ImpliedSpread& TickEngine::link_spread(const std::string& spread, const std::string& front,
+                                       const std::string& back) {
+    OrderBook* spread_book = get_or_create_book(spread);
+    OrderBook* legs[2] = {get_or_create_book(front), get_or_create_book(back)};
+    auto linked = std::make_unique<ImpliedSpread>(*legs[0], *legs[1], *spread_book);
+    linked->set_trade_callback([this](const Trade& t, const OrderBook& book) {
+        on_trade(t, book.symbol_id());
+    });
+    
+    for (OrderBook* leg : legs) {
+        SymbolId id = leg->symbol_id();
+        if (id >= spreads_by_leg_.size()) {
+            spreads_by_leg_.resize(id + 1);
+        }
+        spreads_by_leg_[id].push_back(linked.get());
+    }
+    SymbolId symbol = spread_book->symbol_id();
+    if (symbol >= spread_by_id_.size()) {
+        spread_by_id_.resize(symbol + 1, nullptr);
+    }
+    spread_by_id_[symbol] = linked.get();
+    spreads_.push_back(std::move(linked));
+    return *spreads_.back();
+}
+
+OptionChain& TickEngine::add_option_chain(const std::string& underlying, double rate) {
+    SymbolId symbol = get_or_create_book(underlying)->symbol_id();
+    if (symbol >= chain_by_id_.size()) {
+        chain_by_id_.resize(symbol + 1, nullptr);
+    }
+    if (!chain_by_id_[symbol]) {
+        chains_.push_back(std::make_unique<OptionChain>(symbol, rate));
+        chain_by_id_[symbol] = chains_.back().get();
+    }
+    return *chain_by_id_[symbol];
+}
+
+size_t TickEngine::subscribe_bars(Strategy* strategy, const BarSpec& spec) {
+    size_t resolution = bars_.add_resolution(spec);
+    if (resolution >= bar_subscribers_.size()) {
+        bar_subscribers_.resize(resolution + 1);
+    }
+    auto& subscribers = bar_subscribers_[resolution];
+    if (std::find(subscribers.begin(), subscribers.end(), strategy) == subscribers.end()) {
+        subscribers.push_back(strategy);
     }
+    return resolution;
+}
+
+void TickEngine::flush_bars() {
+    bars_.flush([this](const Bar& bar) { deliver_bar(bar); });
+}
+
+void TickEngine::deliver_bar(const Bar& bar) {
+    for (Strategy* strategy : bar_subscribers_[bar.resolution]) {
+        strategy->on_bar(bar, this);
+    }
+}
+
+void TickEngine::set_self_trade_prevention(SelfTradePrevention mode) {
+    stp_ = mode;
+    for (auto& [symbol, book] : order_books_) {
+        book->set_self_trade_prevention(mode);
+    }
+}
+
+void TickEngine::enable_book_features(size_t depth_levels, Timestamp depletion_half_life) {
+    feature_levels_ = depth_levels ? depth_levels : 1;
+    feature_half_life_ = depletion_half_life;
+    for (auto& [symbol, book] : order_books_) {
+        book->enable_features(feature_levels_, feature_half_life_);
+    }
+}
+
+OrderBook* TickEngine::get_or_create_book(const std::string& symbol) {
+    auto it = order_books_.find(symbol);
+    if (it != order_books_.end()) {
+        return it->second.get();
+    }
+    
+    SymbolId symbol_id = SymbolRegistry::instance().register_symbol(symbol);
+    auto ob = std::make_unique<OrderBook>(symbol, symbol_id);
+    ob->set_trade_callback([this, symbol_id](const Trade& t) { on_trade(t, symbol_id); });
+    ob->set_top_of_book_slot(top_of_book_.slot(symbol_id));
+    ob->set_self_trade_prevention(stp_);
+    if (feature_levels_ > 0) {
+        ob->enable_features(feature_levels_, feature_half_life_);
+    }
+    if (book_updates_) {
+        dirty_books_.reserve(symbol_id);
+        ob->set_dirty_set(&dirty_books_);
+    }
+    if (sampler_) {
+        sampler_->add_book(symbol_id, ob.get());
+    }
+    
+    if (symbol_id >= books_by_id_.size()) {
+        books_by_id_.resize(symbol_id + 1, nullptr);
+    }
+    books_by_id_[symbol_id] = ob.get();
+    return order_books_.emplace(symbol, std::move(ob)).first->second.get();
 }
 
 void TickEngine::run_backtest(const std::vector<Tick>& ticks) {
+    if (live_stats_) {
+        live_stats_->state.store(LiveThreadStats::RUNNING, std::memory_order_relaxed);
+    }
+    
     for (const auto& tick : ticks) {
         process_tick(tick);
     }
+    flush_book_updates();
+    
+    if (live_stats_) {
+        publish_live_stats();
+        live_stats_->state.store(LiveThreadStats::FINISHED, std::memory_order_relaxed);
+    }
+}
+
+void TickEngine::enable_live_stats(LiveStatsRegion& region) {
+    live_stats_ = region.claim_thread_slot();
+    if (live_stats_) {
+        publish_live_stats();
+    }
+}
+
+void TickEngine::publish_live_stats() {
+    constexpr auto relaxed = std::memory_order_relaxed;
+    ticks_until_publish_ = LIVE_STATS_INTERVAL;
+    
+    live_stats_->ticks_processed.store(stats_.ticks_processed, relaxed);
+    live_stats_->orders_submitted.store(stats_.orders_submitted, relaxed);
+    live_stats_->trades_executed.store(stats_.trades_executed, relaxed);
+    live_stats_->total_latency_ns.store(stats_.total_latency_ns, relaxed);
+    live_stats_->pool_allocated.store(order_pool_.allocated_count(), relaxed);
+    live_stats_->pool_bytes.store(order_pool_.memory_usage(), relaxed);
+    live_stats_->queue_depth.store(sampler_ ? sampler_->queue_depth() : 0, relaxed);
+    live_stats_->simulated_time.store(current_time_, relaxed);
+    for (size_t b = 0; b < latency_histogram_.size(); ++b) {
+        live_stats_->latency_histogram[b].store(latency_histogram_[b], relaxed);
+    }
+    live_stats_->heartbeat_ns.store(LiveStatsRegion::now_ns(), relaxed);
+}
+
+void TickEngine::enable_sampling(const SamplerConfig& config) {
+    sampler_ = std::make_unique<BookSampler>(config);
+    for (const auto& [symbol, book] : order_books_) {
+        sampler_->add_book(SymbolRegistry::instance().register_symbol(symbol), book.get());
+    }
 }
 
 void TickEngine::add_strategy(std::unique_ptr<Strategy> strategy) {
     strategies_.push_back(std::move(strategy));
+    sees_all_.push_back(1);
+    dispatch_dirty_ = true;
+}
+
+void TickEngine::add_strategy(std::unique_ptr<Strategy> strategy,
+                              const std::vector<std::string>& symbols) {
+    Strategy* added = strategy.get();
+    strategies_.push_back(std::move(strategy));
+    sees_all_.push_back(0);
+    for (const auto& symbol : symbols) {
+        subscribe(added, symbol);
+    }
+    dispatch_dirty_ = true;
+}
+
+void TickEngine::subscribe(Strategy* strategy, const std::string& symbol) {
+    auto it = std::find_if(strategies_.begin(), strategies_.end(),
+                           [strategy](const auto& s) { return s.get() == strategy; });
+    if (it == strategies_.end()) return;
+    uint32_t index = static_cast<uint32_t>(it - strategies_.begin());
+    if (sees_all_[index]) return;
+    subscriptions_.emplace_back(SymbolRegistry::instance().register_symbol(symbol), index);
+    dispatch_dirty_ = true;
+}
+
+std::pair<Strategy* const*, Strategy* const*> TickEngine::subscribers(SymbolId symbol) {
+    if (dispatch_dirty_) {
+        rebuild_dispatch();
+    }
+    if (symbol + 1u < dispatch_begin_.size()) {
+        return {dispatch_.data() + dispatch_begin_[symbol], dispatch_.data() + dispatch_begin_[symbol + 1]};
+    }
+    return {wildcard_.data(), wildcard_.data() + wildcard_.size()};
+}
+
+void TickEngine::enable_book_updates() {
+    book_updates_ = true;
+    for (auto& [symbol, book] : order_books_) {
+        dirty_books_.reserve(book->symbol_id());
+        book->set_dirty_set(&dirty_books_);
+    }
+}
+
+void TickEngine::flush_book_updates() {
+    if (flushing_books_ || !dirty_books_.any()) return;
+    flushing_books_ = true;
+    dirty_books_.drain([this](SymbolId symbol) {
+        ++stats_.book_updates;
+        auto [first, last] = subscribers(symbol);
+        for (Strategy* const* it = first; it != last; ++it) {
+            (*it)->on_book_update(symbol, this);
+        }
+    });
+    flushing_books_ = false;
+}
+
+void TickEngine::rebuild_dispatch() {
+    std::sort(subscriptions_.begin(), subscriptions_.end());
+    subscriptions_.erase(std::unique(subscriptions_.begin(), subscriptions_.end()), subscriptions_.end());
+    
+    std::vector<uint32_t> wildcard;
+    wildcard_.clear();
+    for (uint32_t i = 0; i < strategies_.size(); ++i) {
+        if (!sees_all_[i]) continue;
+        wildcard.push_back(i);
+        wildcard_.push_back(strategies_[i].get());
+    }
+    
+    // Only symbols with their own subscribers need a run
+    size_t symbols = subscriptions_.empty() ? 0 : subscriptions_.back().first + 1u;
+    dispatch_begin_.assign(symbols + 1, 0);
+    dispatch_.clear();
+    auto sub = subscriptions_.begin();
+    for (size_t s = 0; s < symbols; ++s) {
+        dispatch_begin_[s] = static_cast<uint32_t>(dispatch_.size());
+        // Merge the two index-sorted lists to keep registration order
+        auto w = wildcard.begin();
+        while (w != wildcard.end() || (sub != subscriptions_.end() && sub->first == s)) {
+            bool take_sub = sub != subscriptions_.end() && sub->first == s &&
+                            (w == wildcard.end() || sub->second < *w);
+            uint32_t index = take_sub ? (sub++)->second : *w++;
+            dispatch_.push_back(strategies_[index].get());
+        }
+    }
+    dispatch_begin_[symbols] = static_cast<uint32_t>(dispatch_.size());
+    dispatch_dirty_ = false;
 }
 
 OrderBook* TickEngine::get_order_book(const std::string& symbol) {
     auto it = order_books_.find(symbol);
-    return it != order_books_.end() ? it->second.get() : nullptr;
+    if (it != order_books_.end()) return it->second.get();
+    for (auto& shard : shards_) {  // Books of the last parallel run
+        if (OrderBook* book = shard->get_order_book(symbol)) return book;
+    }
+    return nullptr;
 }
 
-void TickEngine::on_trade(const Trade& trade) {
+void TickEngine::on_trade(const Trade& trade, SymbolId symbol) {
     ++stats_.trades_executed;
+    
+    // Hash participants by user id: engine order ids are pool handles and
+    // differ between serial and sharded runs
+    const Order* buy = find_order(trade.buy_order_id);
+    const Order* sell = find_order(trade.sell_order_id);
+    uint64_t users = (buy ? buy->user_id : 0) | static_cast<uint64_t>(sell ? sell->user_id : 0) << 32;
+    fingerprint_.record(symbol, RunFingerprint::TRADE, static_cast<uint64_t>(trade.price),
+                        static_cast<uint64_t>(trade.quantity), users, trade.timestamp);
+    stats_.fingerprint = fingerprint_.value();
+    
+    if (parallel_) {
+        parallel_trade(trade, symbol);  // Reported to strategies after the latency
+        return;
+    }
     for (auto& strategy : strategies_) {
         strategy->on_trade(trade);
     }
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "tick_engine.hpp"
-#include <deque>
-#include <numeric>
+#include "cpu_dispatch.hpp"
+#include <string>
+#include <vector>
 
 namespace trading {
 
@@ -11,21 +12,20 @@ class MomentumStrategy : public Strategy {
 public:
     MomentumStrategy(size_t window_size = 20, Quantity order_size = 100) 
         : window_size_(window_size), order_size_(order_size), 
-          position_(0), total_pnl_(0), trades_executed_(0) {}
+          prices_(window_size), position_(0), total_pnl_(0), trades_executed_(0) {}
     
     void on_tick(const Tick& tick, TickEngine* engine) override {
-        // Update price window
-        prices_.push_back(tick.price);
-        if (prices_.size() > window_size_) {
-            prices_.pop_front();
-        }
+        // Update price window (ring buffer; order is irrelevant for the sum)
+        prices_[next_slot_] = tick.price;
+        next_slot_ = (next_slot_ + 1) % window_size_;
+        if (filled_ < window_size_) ++filled_;
         
         // Need full window before trading
-        if (prices_.size() < window_size_) return;
+        if (filled_ < window_size_) return;
         
-        // Calculate moving average (in fixed-point)
-        Price sum = std::accumulate(prices_.begin(), prices_.end(), Price(0));
-        Price ma = sum / static_cast<Price>(prices_.size());
+        // Calculate moving average (in fixed-point) with the dispatched SIMD kernel
+        Price sum = kernels().sum_i64(prices_.data(), window_size_);
+        Price ma = sum / static_cast<Price>(window_size_);
         Price current_price = tick.price;
         
         // Generate signals with 2% threshold to avoid noise
@@ -89,7 +89,9 @@ public:
 private:
     size_t window_size_;
     Quantity order_size_;
-    std::deque<Price> prices_;
+    std::vector<Price> prices_;
+    size_t next_slot_ = 0;
+    size_t filled_ = 0;
     int64_t position_;
     int64_t target_position_ = 0;
     Price avg_entry_price_ = 0;
@@ -101,34 +103,37 @@ private:
 // Market making strategy: Place orders on both sides
 class MarketMakerStrategy : public Strategy {
 public:
+    // quote_interval_ns > 0 requotes on a simulated-time timer instead of
+    // every 10 ticks
     MarketMakerStrategy(Price spread = 100, Quantity quote_size = 50, 
-                       int64_t max_position = 500) 
+                       int64_t max_position = 500, Timestamp quote_interval_ns = 0) 
         : spread_(spread), quote_size_(quote_size), 
-          max_position_(max_position), position_(0), 
-          tick_count_(0), trades_count_(0), total_pnl_(0) {}
+          max_position_(max_position), quote_interval_ns_(quote_interval_ns),
+          position_(0), tick_count_(0), trades_count_(0), total_pnl_(0) {}
     
     void on_tick(const Tick& tick, TickEngine* engine) override {
-        if (++tick_count_ % 10 != 0) return; // Quote every 10 ticks
-        
-        Price mid = tick.price;
-        
-        // Risk management: don't quote if position too large
-        bool can_buy = position_ < max_position_;
-        bool can_sell = position_ > -max_position_;
-        
-        // Place bid (buy side) if we can accumulate more
-        if (can_buy) {
-            Order bid(0, mid - spread_/2, quote_size_, tick.timestamp,
-                     Side::BUY, OrderType::LIMIT, 2);
-            engine->submit_order(bid);
+        last_mid_ = tick.price;
+        if (tick.symbol != last_name_) {  // Registry lookup only on a symbol change
+            last_name_ = tick.symbol;
+            last_symbol_ = SymbolRegistry::instance().register_symbol(tick.symbol);
         }
-        
-        // Place ask (sell side) if we can sell more
-        if (can_sell) {
-            Order ask(0, mid + spread_/2, quote_size_, tick.timestamp,
-                     Side::SELL, OrderType::LIMIT, 2);
-            engine->submit_order(ask);
+        if (quote_interval_ns_ > 0) {
+            if (!timer_armed_) {
+                engine->schedule_timer(tick.timestamp + quote_interval_ns_, this);
+                timer_armed_ = true;
+            }
+            return;
         }
+        
+        if (++tick_count_ % 10 != 0) return; // Quote every 10 ticks
+        quote(tick.price, last_symbol_, tick.timestamp, engine);
+    }
+    
+    // Timers fire before on_tick of the tick that triggers them, so quote
+    // the symbol last_mid_ came from, not whichever book is current
+    void on_timer(uint64_t /*tag*/, TickEngine* engine) override {
+        quote(last_mid_, last_symbol_, engine->now(), engine);
+        engine->schedule_timer(engine->now() + quote_interval_ns_, this);
     }
     
     void on_trade(const Trade& trade) override {
@@ -147,15 +152,44 @@ public:
     int64_t position() const { return position_; }
     size_t trades() const { return trades_count_; }
     int64_t pnl() const { return total_pnl_; }
+    size_t quotes() const { return quotes_count_; }
     
 private:
+    void quote(Price mid, SymbolId symbol, Timestamp now, TickEngine* engine) {
+        ++quotes_count_;
+        
+        // Risk management: don't quote if position too large
+        bool can_buy = position_ < max_position_;
+        bool can_sell = position_ > -max_position_;
+        
+        // Place bid (buy side) if we can accumulate more
+        if (can_buy) {
+            Order bid(0, mid - spread_/2, quote_size_, now,
+                     Side::BUY, OrderType::LIMIT, 2);
+            engine->submit_order(bid, symbol);
+        }
+        
+        // Place ask (sell side) if we can sell more
+        if (can_sell) {
+            Order ask(0, mid + spread_/2, quote_size_, now,
+                     Side::SELL, OrderType::LIMIT, 2);
+            engine->submit_order(ask, symbol);
+        }
+    }
+    
     Price spread_;
     Quantity quote_size_;
     int64_t max_position_;
+    Timestamp quote_interval_ns_;
     int64_t position_;
     uint64_t tick_count_;
     uint64_t trades_count_;
     int64_t total_pnl_;
+    uint64_t quotes_count_ = 0;
+    Price last_mid_ = 0;
+    std::string last_name_;
+    SymbolId last_symbol_ = 0;
+    bool timer_armed_ = false;
 };
 
 } // namespace trading
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "tick_engine.hpp"
+#include "rolling_regression.hpp"
+#include <cmath>
+#include <string>
+
+namespace trading {
+
+// Pairs / stat-arb strategy: regress leg Y on leg X over a sliding window,
+// trade the residual spread when its z-score leaves [-entry_z, entry_z] and
+// unwind once it is back inside exit_z. Entries also require the spread to
+// be mean reverting with a half-life (in samples) under max_half_life.
+class PairsStrategy : public Strategy {
+public:
+    PairsStrategy(const std::string& leg_y, const std::string& leg_x,
+                  size_t window = 100, double entry_z = 2.0, double exit_z = 0.5,
+                  Quantity order_size = 100, double max_half_life = 0.0)
+        : leg_y_(leg_y), leg_x_(leg_x),
+          id_y_(SymbolRegistry::instance().register_symbol(leg_y)),
+          id_x_(SymbolRegistry::instance().register_symbol(leg_x)),
+          entry_z_(entry_z), exit_z_(exit_z), order_size_(order_size),
+          max_half_life_(max_half_life > 0.0 ? max_half_life : static_cast<double>(window)),
+          hedge_(window), reversion_(window) {}
+
+    void on_tick(const Tick& tick, TickEngine* engine) override {
+        if (tick.symbol == leg_y_) {
+            last_y_ = tick.price;
+        } else if (tick.symbol == leg_x_) {
+            last_x_ = tick.price;
+        } else {
+            return;
+        }
+        if (last_y_ == 0 || last_x_ == 0) return;  // Need both legs
+
+        double x = static_cast<double>(last_x_);
+        double y = static_cast<double>(last_y_);
+
+        // Signal against the fit before this sample joins it
+        if (hedge_.full()) {
+            zscore_ = hedge_.zscore(x, y);
+            trade(tick.timestamp, engine);
+        }
+
+        hedge_.add(x, y);
+        double spread = hedge_.residual(x, y);
+        if (has_spread_) {
+            reversion_.add(prev_spread_, spread - prev_spread_);
+        }
+        prev_spread_ = spread;
+        has_spread_ = true;
+    }
+
+    void on_trade(const Trade& /*trade*/) override {
+        ++trades_executed_;
+    }
+
+    const char* name() const override { return "PairsStrategy"; }
+
+    // Getters for analysis
+    int state() const { return state_; }  // +1 long spread, -1 short, 0 flat
+    double hedge_ratio() const { return hedge_.slope(); }
+    double zscore() const { return zscore_; }
+    double half_life() const {
+        return reversion_.count() >= 3 ? mean_reversion_half_life(reversion_.slope()) : INFINITY;
+    }
+    size_t entries() const { return entries_; }
+    size_t exits() const { return exits_; }
+    size_t trades() const { return trades_executed_; }
+
+private:
+    void trade(Timestamp now, TickEngine* engine) {
+        if (state_ == 0) {
+            if (std::abs(zscore_) < entry_z_ || half_life() > max_half_life_) return;
+            // Spread rich (z > 0): sell Y, buy X; cheap: the reverse
+            int direction = zscore_ > 0 ? -1 : 1;
+            submit_legs(direction, now, engine);
+            hedge_x_ = hedged_quantity();
+            state_ = direction;
+            ++entries_;
+        } else if (std::abs(zscore_) < exit_z_) {
+            submit_legs(-state_, now, engine);
+            state_ = 0;
+            ++exits_;
+        }
+    }
+
+    // direction +1 buys the spread (Y against beta * X), -1 sells it;
+    // unwinds reuse the X quantity and beta sign fixed at entry
+    void submit_legs(int direction, Timestamp now, TickEngine* engine) {
+        if (state_ == 0) negative_beta_ = hedge_.slope() < 0;
+        Quantity qty_x = state_ == 0 ? hedged_quantity() : hedge_x_;
+        Side side_y = direction > 0 ? Side::BUY : Side::SELL;
+        Side side_x = (direction > 0) != negative_beta_ ? Side::SELL : Side::BUY;
+
+        engine->submit_order(Order(0, last_y_, order_size_, now, side_y, OrderType::LIMIT, 3), id_y_);
+        if (qty_x > 0) {
+            engine->submit_order(Order(0, last_x_, qty_x, now, side_x, OrderType::LIMIT, 3), id_x_);
+        }
+    }
+
+    Quantity hedged_quantity() const {
+        return static_cast<Quantity>(std::llround(std::abs(hedge_.slope()) * order_size_));
+    }
+
+    std::string leg_y_;
+    std::string leg_x_;
+    SymbolId id_y_;
+    SymbolId id_x_;
+    double entry_z_;
+    double exit_z_;
+    Quantity order_size_;
+    double max_half_life_;
+    RollingRegression hedge_;      // Y on X: hedge ratio and spread z-score
+    RollingRegression reversion_;  // Spread change on lagged spread: half-life
+    Price last_y_ = 0;
+    Price last_x_ = 0;
+    double prev_spread_ = 0.0;
+    bool has_spread_ = false;
+    double zscore_ = 0.0;
+    int state_ = 0;
+    Quantity hedge_x_ = 0;
+    bool negative_beta_ = false;
+    size_t entries_ = 0;
+    size_t exits_ = 0;
+    size_t trades_executed_ = 0;
+};
+
+} // namespace trading